@@ -0,0 +1,96 @@
+/**
+ * @file arena.c
+ * Projekt: Implementace prekladace imperativniho jazyka IFJ21.
+ * @author Tadeas Vintrlik <xvintr04@stud.fit.vutbr.cz>
+ * @brief Implementation of the region (arena) allocator.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "arena.h"
+#include "common.h"
+
+#define ARENA_BLOCK_SIZE 4096
+
+/**
+ * @brief Move the arena to a block with at least @p size free bytes. Reuses a spare block if
+ * possible.
+ *
+ * @param[in,out] arena The arena.
+ * @param[in] size Size of the object that did not fit into the current block.
+ */
+static void arena_next_block(arena_s *arena, size_t size)
+{
+    arena_block_s *block = arena->spare;
+
+    if (block && block->size >= size) {
+        arena->spare = block->previous;
+    } else {
+        size = MAX(ARENA_BLOCK_SIZE, size);
+        block = malloc(sizeof *block + size);
+        ALLOC_CHECK(block);
+        block->size = size;
+    }
+
+    block->previous = arena->block;
+    arena->block = block;
+    arena->used = 0;
+}
+
+void arena_init(arena_s *arena)
+{
+    arena->block = NULL;
+    arena->used = 0;
+    arena->spare = NULL;
+}
+
+void *arena_alloc(arena_s *arena, size_t size)
+{
+    void *result;
+
+    /* Round up so that the next object stays aligned */
+    size = (size + sizeof(arena_align_u) - 1) / sizeof(arena_align_u) * sizeof(arena_align_u);
+
+    if (!arena->block || arena->used + size > arena->block->size) {
+        arena_next_block(arena, size);
+    }
+
+    result = (char *)arena->block->content + arena->used;
+    arena->used += size;
+    return result;
+}
+
+arena_mark_s arena_mark(const arena_s *arena)
+{
+    arena_mark_s mark = { arena->block, arena->used };
+    return mark;
+}
+
+void arena_release(arena_s *arena, arena_mark_s mark)
+{
+    arena_block_s *block;
+
+    /* Blocks started after the mark are no longer needed */
+    while (arena->block != mark.block) {
+        block = arena->block;
+        arena->block = block->previous;
+        block->previous = arena->spare;
+        arena->spare = block;
+    }
+    arena->used = mark.used;
+}
+
+void arena_destroy(arena_s *arena)
+{
+    arena_block_s *previous;
+    arena_mark_s empty = { NULL, 0 };
+
+    arena_release(arena, empty);
+    while (arena->spare) {
+        previous = arena->spare->previous;
+        FREE(arena->spare);
+        arena->spare = previous;
+    }
+    arena_init(arena);
+}
@@ -0,0 +1,93 @@
+/**
+ * @file arena.h
+ * Projekt: Implementace prekladace imperativniho jazyka IFJ21.
+ * @author Tadeas Vintrlik <xvintr04@stud.fit.vutbr.cz>
+ * @brief Header for the region (arena) allocator.
+ */
+
+#ifndef _ARENA_H_
+#define _ARENA_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Union of the types with the strictest alignment. Every allocation is aligned to it.
+ */
+typedef union arena_align {
+    long double floating;
+    int64_t integer;
+    void *pointer;
+    void (*function)(void);
+} arena_align_u;
+
+/**
+ * @brief Block of memory the objects of an arena are cut from.
+ */
+typedef struct arena_block {
+    struct arena_block *previous;
+    size_t size; /* Usable size of the content */
+    arena_align_u content[];
+} arena_block_s;
+
+/**
+ * @brief Region of memory objects with the same lifetime are allocated from. The objects are never
+ * freed one by one, the whole region (or its part allocated after a mark) is released at once.
+ */
+typedef struct arena {
+    arena_block_s *block; /* Block the next object is cut from */
+    size_t used; /* Bytes used in the current block */
+    arena_block_s *spare; /* Released blocks kept for reuse */
+} arena_s;
+
+/**
+ * @brief Position in an arena. Everything allocated after the mark can be released together.
+ */
+typedef struct arena_mark {
+    arena_block_s *block;
+    size_t used;
+} arena_mark_s;
+
+/**
+ * @brief Initialize an empty arena. Does not allocate anything.
+ *
+ * @param[out] arena The arena to initialize.
+ */
+void arena_init(arena_s *arena);
+
+/**
+ * @brief Allocate an object in the arena. The memory is not initialized. Exits on failure.
+ *
+ * @param[in,out] arena The arena.
+ * @param[in] size Size of the object.
+ *
+ * @return The object. Valid until it is released with arena_release or arena_destroy.
+ */
+void *arena_alloc(arena_s *arena, size_t size);
+
+/**
+ * @brief Get the current position in the arena.
+ *
+ * @param[in] arena The arena.
+ *
+ * @return The mark to pass to arena_release.
+ */
+arena_mark_s arena_mark(const arena_s *arena);
+
+/**
+ * @brief Release all the objects allocated after the @p mark. Blocks are kept for reuse, so the
+ * cost does not depend on the number of released objects.
+ *
+ * @param[in,out] arena The arena.
+ * @param[in] mark Mark returned by arena_mark. Marks must be released in the reverse order.
+ */
+void arena_release(arena_s *arena, arena_mark_s mark);
+
+/**
+ * @brief Free the arena and all the objects in it.
+ *
+ * @param[in,out] arena The arena to destroy. It is left empty and can be used again.
+ */
+void arena_destroy(arena_s *arena);
+
+#endif /* _ARENA_H_ */
@@ -212,6 +212,112 @@ static void avl_rebalance(avl_node_s **node)
     }
 }
 
+/**
+ * @brief Number of nodes in the first block of a pool.
+ */
+#define AVL_POOL_FIRST_BLOCK 64
+
+/**
+ * @brief Block of nodes of a pool.
+ */
+typedef struct avl_block {
+    struct avl_block *previous;
+    avl_node_s nodes[];
+} avl_block_s;
+
+/**
+ * @brief Key searched for with its length and prefix computed once for the whole search.
+ */
+typedef struct avl_key {
+    uint64_t prefix;
+    const char *key;
+    unsigned length;
+} avl_key_s;
+
+/**
+ * @brief Where the nodes of a tree are allocated.
+ */
+typedef struct avl_alloc {
+    arena_s *arena;
+    avl_pool_s *pool;
+} avl_alloc_s;
+
+/**
+ * @brief Fill the length and the prefix of a key. The characters of the prefix are packed with the
+ * first one in the highest byte, so prefixes compare as numbers in the same order as by strcmp.
+ *
+ * @param[out] prefix The prefix to fill.
+ * @param[out] length The length to fill.
+ * @param[in] key The key.
+ */
+static void avl_key_prefix(uint64_t *prefix, unsigned *length, const char *key)
+{
+    unsigned i;
+
+    *prefix = 0;
+    for (i = 0; i < AVL_PREFIX_LENGTH && key[i]; i++) {
+        *prefix |= (uint64_t)(unsigned char)key[i] << 8 * (AVL_PREFIX_LENGTH - 1 - i);
+    }
+    *length = i < AVL_PREFIX_LENGTH ? i : i + strlen(key + i);
+}
+
+/**
+ * @brief Prepare a key for searching.
+ *
+ * @param[out] search The prepared key.
+ * @param[in] key The key.
+ */
+static void avl_key_init(avl_key_s *search, const char *key)
+{
+    search->key = key;
+    avl_key_prefix(&search->prefix, &search->length, key);
+}
+
+/**
+ * @brief Compare a key with the key of a node. Names of identifiers are interned, so equal keys
+ * are usually the same pointer. Otherwise the prefixes decide unless both keys are longer than the
+ * prefix and start the same. Zero padding orders a shorter key before its extensions like strcmp.
+ *
+ * @param search The key searched for.
+ * @param node Node to compare with.
+ *
+ * @return Negative, zero or positive like strcmp.
+ */
+static inline int avl_compare(const avl_key_s *search, const avl_node_s *node)
+{
+    if (search->key == node->key) {
+        return 0;
+    }
+    if (search->prefix != node->prefix) {
+        return search->prefix < node->prefix ? -1 : 1;
+    }
+    if (MIN(search->length, node->length) < AVL_PREFIX_LENGTH) {
+        return 0;
+    }
+    return strcmp(search->key + AVL_PREFIX_LENGTH, node->key + AVL_PREFIX_LENGTH);
+}
+
+/**
+ * @brief Start a new block of the pool with room for at least @p count nodes.
+ *
+ * @param[in,out] pool The pool.
+ * @param[in] count Number of nodes needed.
+ */
+static void avl_pool_new_block(avl_pool_s *pool, unsigned count)
+{
+    avl_block_s *block;
+
+    pool->block_size = pool->block_size ? 2 * pool->block_size : AVL_POOL_FIRST_BLOCK;
+    pool->block_size = MAX(pool->block_size, count);
+
+    block = malloc(sizeof *block + pool->block_size * sizeof(avl_node_s));
+    ALLOC_CHECK(block);
+    block->previous = pool->blocks;
+    pool->blocks = block;
+    pool->next = block->nodes;
+    pool->end = block->nodes + pool->block_size;
+}
+
 void avl_init(avl_node_s **node)
 {
     /* Check pointers */
@@ -224,162 +330,342 @@ void avl_init(avl_node_s **node)
     *node = NULL;
 }
 
-void avl_insert(avl_node_s **node, char *key, void *value)
+void avl_pool_init(avl_pool_s *pool)
 {
-    avl_node_s *new = NULL;
-    int cmp;
+    pool->free = NULL;
+    pool->next = NULL;
+    pool->end = NULL;
+    pool->blocks = NULL;
+    pool->block_size = 0;
+}
 
-    if (!*node) {
-        /* Node with given key not found - Allocate new node */
+void avl_pool_destroy(avl_pool_s *pool)
+{
+    avl_block_s *previous;
+
+    while (pool->blocks) {
+        previous = pool->blocks->previous;
+        FREE(pool->blocks);
+        pool->blocks = previous;
+    }
+    avl_pool_init(pool);
+}
+
+/**
+ * @brief Allocate a new leaf node.
+ *
+ * @param[in] alloc Where to allocate the node.
+ * @param[in] key The key of the node.
+ * @param[in] value The value of the node.
+ *
+ * @return The new node.
+ */
+static avl_node_s *avl_node_new(const avl_alloc_s *alloc, const char *key, void *value)
+{
+    avl_pool_s *pool = alloc->pool;
+    avl_node_s *new;
+
+    if (alloc->arena) {
+        new = arena_alloc(alloc->arena, sizeof *new);
+    } else if (!pool) {
         new = malloc(sizeof *new);
         ALLOC_CHECK(new);
-        new->key = key;
-        new->value = value;
-        new->left = NULL;
-        new->right = NULL;
-        new->height = 0;
-        *node = new;
-    }
-
-    cmp = strcmp(key, (*node)->key);
-    if (!cmp) {
-        /* Update existing entry */
-        (*node)->value = value;
-    } else if (cmp < 0) {
-        /* Continue in the left child */
-        avl_insert(&(*node)->left, key, value);
-        (*node)->height++;
+    } else if (pool->free) {
+        new = pool->free;
+        pool->free = new->left;
     } else {
-        /* Continue in the right child */
-        avl_insert(&(*node)->right, key, value);
-        (*node)->height++;
+        if (pool->next == pool->end) {
+            avl_pool_new_block(pool, 1);
+        }
+        new = pool->next++;
     }
 
-    avl_rebalance(node);
+    new->key = key;
+    new->value = value;
+    new->left = NULL;
+    new->right = NULL;
+    new->height = 1;
+    avl_key_prefix(&new->prefix, &new->length, key);
+    return new;
 }
 
-bool avl_search(avl_node_s *node, const char *key, void **value)
+/**
+ * @brief Free a node. Nodes in an arena are left to the arena.
+ *
+ * @param[in] alloc Where the node was allocated.
+ * @param[in] node The node to free.
+ */
+static void avl_node_free(const avl_alloc_s *alloc, avl_node_s *node)
 {
-    int cmp;
+    if (alloc->arena) {
+        return;
+    }
+    if (alloc->pool) {
+        node->left = alloc->pool->free;
+        alloc->pool->free = node;
+        return;
+    }
+    FREE(node);
+}
 
-    if (!node) {
-        /* Empty tree */
-        return false;
+/**
+ * @brief Rebalance the nodes on a path from the deepest one up after an insertion or a deletion.
+ * Stops as soon as the height of a subtree is the same as before, the nodes above are not affected.
+ *
+ * @param[in] path Links to the nodes from the root down.
+ * @param[in] depth Number of links on the path.
+ */
+static void avl_rebalance_path(avl_node_s **path[], unsigned depth)
+{
+    int height;
+
+    while (depth--) {
+        height = (*path[depth])->height;
+        avl_rebalance(path[depth]);
+        if ((*path[depth])->height == height) {
+            return;
+        }
     }
+}
 
-    cmp = strcmp(key, node->key);
-    if (!cmp) {
-        /* Matching key found */
-        if (value) {
-            *value = node->value;
+/**
+ * @brief Insertion into the AVL Tree sturcture.
+ *
+ * @param[in,out] node The root node of the tree into which to insert.
+ * @param[in] key The key that will be used for searching.
+ * @param[in] value A generic pointer to the value to insert.
+ * @param[in] alloc Where to allocate the new node.
+ */
+static void avl_insert_node(
+    avl_node_s **node, const char *key, void *value, const avl_alloc_s *alloc)
+{
+    avl_node_s **path[AVL_MAX_HEIGHT];
+    unsigned depth = 0;
+    avl_key_s search;
+    int cmp;
+
+    avl_key_init(&search, key);
+    while (*node) {
+        cmp = avl_compare(&search, *node);
+        if (!cmp) {
+            /* Update existing entry */
+            (*node)->value = value;
+            return;
         }
-        return true;
-    } else if (cmp < 0) {
-        /* Search in left sibling */
-        return avl_search(node->left, key, value);
-    } else {
-        /* Search in right sibling */
-        return avl_search(node->right, key, value);
+        assert(depth < AVL_MAX_HEIGHT);
+        path[depth++] = node;
+        node = cmp < 0 ? &(*node)->left : &(*node)->right;
     }
+
+    /* Node with given key not found - Allocate new node */
+    *node = avl_node_new(alloc, key, value);
+    avl_rebalance_path(path, depth);
+}
+
+void avl_insert(avl_node_s **node, const char *key, void *value)
+{
+    avl_alloc_s alloc = { NULL, NULL };
+    avl_insert_node(node, key, value, &alloc);
+}
+
+void avl_insert_arena(avl_node_s **node, const char *key, void *value, arena_s *arena)
+{
+    avl_alloc_s alloc = { arena, NULL };
+    avl_insert_node(node, key, value, &alloc);
+}
+
+void avl_insert_pool(avl_node_s **node, const char *key, void *value, avl_pool_s *pool)
+{
+    avl_alloc_s alloc = { NULL, pool };
+    avl_insert_node(node, key, value, &alloc);
 }
 
 /**
- * @brief Replace the @p target by the rightmost node in @p node. Used for deleting a node.
+ * @brief Build a balanced subtree from a range of sorted keys. The nodes are allocated in preorder,
+ * so a node is followed by its left child in memory.
+ *
+ * @param[in] keys Sorted keys of the subtree.
+ * @param[in] values Values of the keys. If NULL all the values are NULL.
+ * @param[in] count Number of keys.
+ * @param[in] alloc Where to allocate the nodes.
  *
- * @param target The node to replace by the rightmost.
- * @param node AVL Tree where to find the rightmost node in.
- * @param destructor Free callback.
+ * @return Root of the subtree. NULL for an empty range.
  */
-static void avl_replace_by_rightmost(avl_node_s *target, avl_node_s **node, destructor destructor)
+static avl_node_s *avl_build_range(
+    const char *const *keys, void *const *values, unsigned count, const avl_alloc_s *alloc)
 {
-    avl_node_s *left = NULL;
-
-    if (!(*node)->right) {
-        /* Found the rightmost node - replace it */
-        FREE_VALUE(target, destructor);
-        target->key = (*node)->key;
-        target->value = (*node)->value;
-        target->height--;
-
-        /* Link the left subtree of the rightmost node to the parent */
-        left = (*node)->left;
-        FREE(*node);
-        *node = left;
-        return;
+    unsigned middle = count / 2;
+    avl_node_s *node;
+
+    if (!count) {
+        return NULL;
     }
-    avl_replace_by_rightmost(target, &(*node)->right, destructor);
+
+    node = avl_node_new(alloc, keys[middle], values ? values[middle] : NULL);
+    node->left = avl_build_range(keys, values, middle, alloc);
+    node->right = avl_build_range(keys + middle + 1, values ? values + middle + 1 : NULL,
+        count - middle - 1, alloc);
+    avl_node_update_height(node);
+    return node;
 }
 
-bool avl_delete(avl_node_s **node, const char *key, destructor destructor)
+void avl_build(avl_node_s **node, const char *const *keys, void *const *values, unsigned count,
+    avl_pool_s *pool)
 {
-    avl_node_s *tmp = NULL;
-    bool ret;
-    int cmp;
+    avl_alloc_s alloc = { NULL, pool };
 
-    /* Check for pointers */
-    if (!node || !*node) {
-        return false;
+    assert(node && !*node);
+
+    /* Make room for all the nodes in one block unless there are free nodes to reuse */
+    if (pool && !pool->free && pool->end - pool->next < (ptrdiff_t)count) {
+        avl_pool_new_block(pool, count);
     }
+    *node = avl_build_range(keys, values, count, &alloc);
+}
 
-    cmp = strcmp(key, (*node)->key);
-    if (cmp < 0) {
-        /* Search in left subtree */
-        if ((ret = avl_delete(&(*node)->left, key, destructor))) {
-            (*node)->height--;
-            avl_rebalance(node);
-        }
-        return ret;
-    } else if (cmp > 0) {
-        /* Search in right subtree */
-        if ((ret = avl_delete(&(*node)->right, key, destructor))) {
-            (*node)->height--;
-            avl_rebalance(node);
-        }
-        return ret;
-    } else {
-        /* Found the node to be removed */
+bool avl_search(avl_node_s *node, const char *key, void **value)
+{
+    avl_key_s search;
+    int cmp;
 
-        if (!(*node)->left && !(*node)->right) {
-            /* Terminal node */
-            FREE_VALUE((*node), destructor);
-            FREE(*node);
-            *node = NULL;
+    avl_key_init(&search, key);
+    while (node) {
+        cmp = avl_compare(&search, node);
+        if (!cmp) {
+            /* Matching key found */
+            if (value) {
+                *value = node->value;
+            }
+            return true;
         }
+        /* Continue in the child on the side of the key */
+        node = cmp < 0 ? node->left : node->right;
+    }
+    return false;
+}
 
-        else if ((*node)->left && !(*node)->right) {
-            /* Has only left child */
-            tmp = (*node)->left;
-            FREE_VALUE((*node), destructor);
-            FREE(*node);
-            *node = tmp;
-        }
+/**
+ * @brief Deletion of the node inside the AVL Tree sturcture. A node with both children takes the
+ * key and the value of the rightmost node of its left subtree, which is unlinked instead.
+ *
+ * @param[in,out] node The root node of the tree where to delete.
+ * @param[in] key The key that will be used for searching.
+ * @param[in] destructor Function callback to free the data. If NULL the FREE macro is called.
+ * @param[in] alloc Where the nodes were allocated.
+ *
+ * @return True if value was deleted. False if not found.
+ */
+static bool avl_delete_node(
+    avl_node_s **node, const char *key, destructor destructor, const avl_alloc_s *alloc)
+{
+    avl_node_s **path[AVL_MAX_HEIGHT];
+    unsigned depth = 0;
+    avl_node_s *target, *removed;
+    avl_key_s search;
+    int cmp;
 
-        else if ((*node)->right && !(*node)->left) {
-            /* Has only right child */
-            tmp = (*node)->right;
-            FREE_VALUE((*node), destructor);
-            FREE(*node);
-            *node = tmp;
-        }
+    /* Check for pointers */
+    if (!node) {
+        return false;
+    }
 
-        else {
-            /* Has both children */
-            avl_replace_by_rightmost(*node, &(*node)->left, destructor);
-        }
+    avl_key_init(&search, key);
+    while (*node && (cmp = avl_compare(&search, *node))) {
+        assert(depth < AVL_MAX_HEIGHT);
+        path[depth++] = node;
+        node = cmp < 0 ? &(*node)->left : &(*node)->right;
+    }
+    if (!*node) {
+        return false;
+    }
+
+    target = *node;
+    FREE_VALUE(target, destructor);
 
+    if (!target->left || !target->right) {
+        /* At most one child - link it to the parent */
+        *node = target->left ? target->left : target->right;
+        avl_node_free(alloc, target);
+        avl_rebalance_path(path, depth);
         return true;
     }
+
+    /* Has both children - find the rightmost node of the left subtree */
+    path[depth++] = node;
+    node = &target->left;
+    while ((*node)->right) {
+        assert(depth < AVL_MAX_HEIGHT);
+        path[depth++] = node;
+        node = &(*node)->right;
+    }
+
+    removed = *node;
+    target->key = removed->key;
+    target->value = removed->value;
+    target->length = removed->length;
+    target->prefix = removed->prefix;
+
+    /* Link the left subtree of the rightmost node to the parent */
+    *node = removed->left;
+    avl_node_free(alloc, removed);
+    avl_rebalance_path(path, depth);
+    return true;
 }
 
-void avl_destroy(avl_node_s **node, destructor destructor)
+bool avl_delete(avl_node_s **node, const char *key, destructor destructor)
+{
+    avl_alloc_s alloc = { NULL, NULL };
+    return avl_delete_node(node, key, destructor, &alloc);
+}
+
+bool avl_delete_pool(avl_node_s **node, const char *key, destructor destructor, avl_pool_s *pool)
+{
+    avl_alloc_s alloc = { NULL, pool };
+    return avl_delete_node(node, key, destructor, &alloc);
+}
+
+/**
+ * @brief Free the values of all the nodes of a tree and optionally the nodes. Left children are
+ * rotated up until the root has none, then the root is removed and its right subtree follows.
+ * Needs neither recursion nor a stack.
+ *
+ * @param[in,out] node The root of the tree.
+ * @param[in] destructor Function callback to free the data. If NULL the FREE macro is called.
+ * @param[in] free_nodes If the nodes were allocated by malloc and should be freed.
+ */
+static void avl_free_tree(avl_node_s **node, destructor destructor, bool free_nodes)
 {
+    avl_node_s *root, *next;
 
     /* Check for pointers */
-    if (!node || !*node) {
+    if (!node) {
         return;
     }
 
-    while (*node) {
-        avl_delete(node, (*node)->key, destructor);
+    root = *node;
+    while (root) {
+        if (root->left) {
+            next = root->left;
+            root->left = next->right;
+            next->right = root;
+        } else {
+            next = root->right;
+            FREE_VALUE(root, destructor);
+            if (free_nodes) {
+                FREE(root);
+            }
+        }
+        root = next;
     }
+    *node = NULL;
+}
+
+void avl_destroy(avl_node_s **node, destructor destructor)
+{
+    avl_free_tree(node, destructor, true);
+}
+
+void avl_release(avl_node_s **node, destructor destructor)
+{
+    avl_free_tree(node, destructor, false);
 }
@@ -9,24 +9,66 @@
 
 #include <assert.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include "arena.h"
 #include "common.h"
 
 /**
- * @brief AVL Tree node structure.
+ * @brief Number of leading characters of a key stored in its node.
+ */
+#define AVL_PREFIX_LENGTH 8
+
+/**
+ * @brief Upper bound of the height of an AVL Tree that fits in memory.
+ */
+#define AVL_MAX_HEIGHT 96
+
+/**
+ * @brief AVL Tree node structure. The start of the key is kept in the node itself, so most
+ * comparisons are decided without reading the key.
  */
 typedef struct avl_node {
-    char *key;
-    void *value;
-    int height;
+    uint64_t prefix; /* First characters of the key padded with zeros, the first one highest */
     struct avl_node *left;
     struct avl_node *right;
+    const char *key;
+    void *value;
+    int height;
+    unsigned length; /* Length of the key */
 } avl_node_s;
 
+/**
+ * @brief Pool of AVL Tree nodes. Nodes are cut from blocks of growing size, so nodes allocated one
+ * after another lie next to each other in memory.
+ */
+typedef struct avl_pool {
+    avl_node_s *free; /* Deleted nodes, linked through the left child */
+    avl_node_s *next; /* Next never used node of the newest block */
+    avl_node_s *end; /* End of the newest block */
+    struct avl_block *blocks; /* Allocated blocks, newest first */
+    unsigned block_size; /* Number of nodes in the newest block */
+} avl_pool_s;
+
+/**
+ * @brief Initialize an empty pool. Does not allocate anything.
+ *
+ * @param[out] pool The pool to initialize.
+ */
+void avl_pool_init(avl_pool_s *pool);
+
+/**
+ * @brief Free the pool and all the nodes allocated from it. The values in the nodes are not freed,
+ * use avl_release on the trees first.
+ *
+ * @param[in,out] pool The pool to destroy.
+ */
+void avl_pool_destroy(avl_pool_s *pool);
+
 /**
  * @brief Initialization of the root node of the AVL Tree sturcture.
  *
@@ -41,7 +83,46 @@ void avl_init(avl_node_s **node);
  * @param[in] key The key that will be used for searching.
  * @param[in] value A generic pointer to the value to insert.
  */
-void avl_insert(avl_node_s **node, char *key, void *value);
+void avl_insert(avl_node_s **node, const char *key, void *value);
+
+/**
+ * @brief Insertion into the AVL Tree sturcture with the new node allocated in an arena.
+ *
+ * @note A tree with nodes in an arena must not be passed to avl_delete or avl_destroy, use
+ * avl_release instead.
+ *
+ * @param[in,out] node The root node of the tree into which to insert.
+ * @param[in] key The key that will be used for searching.
+ * @param[in] value A generic pointer to the value to insert.
+ * @param[in] arena The arena to allocate the new node in.
+ */
+void avl_insert_arena(avl_node_s **node, const char *key, void *value, arena_s *arena);
+
+/**
+ * @brief Insertion into the AVL Tree sturcture with the new node allocated in a pool.
+ *
+ * @note A tree with nodes in a pool must be deleted from by avl_delete_pool and destroyed by
+ * avl_release followed by avl_pool_destroy.
+ *
+ * @param[in,out] node The root node of the tree into which to insert.
+ * @param[in] key The key that will be used for searching.
+ * @param[in] value A generic pointer to the value to insert.
+ * @param[in] pool The pool to allocate the new node in.
+ */
+void avl_insert_pool(avl_node_s **node, const char *key, void *value, avl_pool_s *pool);
+
+/**
+ * @brief Build a tree from sorted keys in linear time. The tree is as balanced as possible and its
+ * nodes are allocated in one piece of the pool.
+ *
+ * @param[in,out] node The root of the tree to build. Must be an empty tree.
+ * @param[in] keys Keys in strictly ascending order as compared by strcmp.
+ * @param[in] values Values of the keys. If NULL all the values are NULL.
+ * @param[in] count Number of keys.
+ * @param[in] pool The pool to allocate the nodes in. If NULL the nodes are allocated by malloc.
+ */
+void avl_build(avl_node_s **node, const char *const *keys, void *const *values, unsigned count,
+    avl_pool_s *pool);
 
 /**
  * @brief Searching inside the AVL Tree sturcture.
@@ -68,6 +149,19 @@ bool avl_search(avl_node_s *node, const char *key, void **value);
  */
 bool avl_delete(avl_node_s **node, const char *key, destructor);
 
+/**
+ * @brief Deletion of the node inside the AVL Tree sturcture with nodes allocated in a pool. The
+ * node is returned to the pool.
+ *
+ * @param[in,out] node The root node of the tree where to delete.
+ * @param[in] key The key that will be used for searching.
+ * @param[in] destructor Function callback to free the data. If NULL the FREE macro is called.
+ * @param[in] pool The pool the nodes were allocated from.
+ *
+ * @return True if value was deleted. False if not found.
+ */
+bool avl_delete_pool(avl_node_s **node, const char *key, destructor, avl_pool_s *pool);
+
 /**
  * @brief Destructor for the AVL Tree structure.
  *
@@ -78,4 +172,13 @@ bool avl_delete(avl_node_s **node, const char *key, destructor);
  */
 void avl_destroy(avl_node_s **node, destructor);
 
+/**
+ * @brief Destructor for the AVL Tree structure with nodes allocated in an arena or a pool. Frees
+ * the values only, the nodes are released together with the arena or the pool.
+ *
+ * @param[in,out] node The root of the tree to destroy.
+ * @param[in] destructor Function callback to free the data. If NULL the FREE macro is called.
+ */
+void avl_release(avl_node_s **node, destructor);
+
 #endif /* _AVL_H */
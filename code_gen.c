@@ -6,112 +6,90 @@
  * @brief Implementation of code generator.
  */
 
+#include <inttypes.h>
+#include <string.h>
+
 #include "code_gen.h"
 #include "common.h"
 #include "sll.h"
 
-static unsigned counter = 0;
-static sll_s call_list;
+/**
+ * @brief Size of a buffer for the longest hexadecimal float literal, "-0x1.fffffffffffffp-1022".
+ */
+#define FLOAT_LITERAL_SIZE 32
 
 typedef struct call {
-    T_token *function;
+    symbol_s *function;
     tstack_s *params_in;
 } call_s;
 
-static void escape_string(dynamic_string_s **ds)
-{
-    dynamic_string_s *new_ds = malloc(sizeof *new_ds);
-    ALLOC_CHECK(new_ds);
-    ds_init(new_ds);
-    dynamic_string_s *old_ds = *ds;
-    char c;
-    for (unsigned i = 0; i < old_ds->size; i++) {
-        switch (old_ds->content[i]) {
-        case ' ':
-            ds_add_char(new_ds, '\\');
-            ds_add_char(new_ds, '0');
-            ds_add_char(new_ds, '3');
-            ds_add_char(new_ds, '2');
-            break;
-        case '\\':
-            c = old_ds->content[++i];
-            if (c) {
-                switch (c) {
-                case 'n':
-                    ds_add_char(new_ds, '\\');
-                    ds_add_char(new_ds, '0');
-                    ds_add_char(new_ds, '1');
-                    ds_add_char(new_ds, '0');
-                    break;
-                case 't':
-                    ds_add_char(new_ds, '\\');
-                    ds_add_char(new_ds, '0');
-                    ds_add_char(new_ds, '0');
-                    ds_add_char(new_ds, '9');
-                    break;
-                case '\"':
-                    ds_add_char(new_ds, '\\');
-                    ds_add_char(new_ds, '0');
-                    ds_add_char(new_ds, '3');
-                    ds_add_char(new_ds, '4');
-                    break;
-                case '\\':
-                    ds_add_char(new_ds, '\\');
-                    ds_add_char(new_ds, '0');
-                    ds_add_char(new_ds, '9');
-                    ds_add_char(new_ds, '2');
-                    break;
-                default:
-                    ds_add_char(new_ds, '\\');
-                    ds_add_char(new_ds, old_ds->content[i]);
-                    break;
-                }
-            }
-            break;
-        default:
-            ds_add_char(new_ds, old_ds->content[i]);
-            break;
-        }
-    }
-    ds_destroy(old_ds);
-    FREE(old_ds);
-    *ds = new_ds;
-}
-
-static void escape_float(dynamic_string_s **ds)
+/**
+ * @brief Format a value exactly as a hexadecimal float literal, the same way as printf "%a".
+ *
+ * @param[in] value The value.
+ * @param[out] buffer Buffer for the literal of at least FLOAT_LITERAL_SIZE characters.
+ *
+ * @return The @p buffer.
+ */
+static char *format_float(double value, char *buffer)
 {
-    dynamic_string_s *new = malloc(sizeof(dynamic_string_s));
-    ALLOC_CHECK(new);
-    ds_init(new);
-
-    float raw_value = atof((*ds)->content);
-
-    int buffer_size = 32;
-    char *str = malloc(buffer_size);
-    ALLOC_CHECK(str);
-
-    snprintf(str, buffer_size, "%a", raw_value);
+    static const char digits[] = "0123456789abcdef";
+    char exponent_digits[4];
+    char *p = buffer;
+    uint64_t bits;
+    int exponent, i = 0;
+
+    memcpy(&bits, &value, sizeof bits);
+    uint64_t mantissa = bits & ((UINT64_C(1) << 52) - 1);
+    exponent = (bits >> 52) & 0x7ff;
+
+    if (bits >> 63) {
+        *p++ = '-';
+    }
+    if (exponent == 0x7ff) {
+        strcpy(p, mantissa ? "nan" : "inf");
+        return buffer;
+    }
 
-    char *current_char = str;
-    while (*current_char != '\0') {
-        ds_add_char(new, *current_char);
-        current_char++;
+    *p++ = '0';
+    *p++ = 'x';
+    if (exponent) {
+        *p++ = '1';
+        exponent -= 1023;
+    } else {
+        /* Zero and subnormal numbers */
+        *p++ = '0';
+        exponent = mantissa ? -1022 : 0;
     }
 
-    FREE(str);
+    /* Hexadecimal digits of the fraction without the trailing zeros */
+    if (mantissa) {
+        *p++ = '.';
+        for (int shift = 48; mantissa & ((UINT64_C(1) << (shift + 4)) - 1); shift -= 4) {
+            *p++ = digits[(mantissa >> shift) & 0xf];
+        }
+    }
 
-    ds_destroy(*ds);
-    free(*ds);
+    *p++ = 'p';
+    *p++ = exponent < 0 ? '-' : '+';
+    exponent = exponent < 0 ? -exponent : exponent;
+    do {
+        exponent_digits[i++] = '0' + exponent % 10;
+        exponent /= 10;
+    } while (exponent);
+    while (i) {
+        *p++ = exponent_digits[--i];
+    }
+    *p = '\0';
 
-    *ds = new;
+    return buffer;
 }
 
-static void generate_built_ins(void);
+static void generate_built_ins(context_s *ctx);
 
-static call_s *call_constructor(T_token *function, tstack_s *params_in)
+static call_s *call_constructor(context_s *ctx, symbol_s *function, tstack_s *params_in)
 {
-    call_s *result = malloc(sizeof *result);
-    ALLOC_CHECK(result);
+    call_s *result = arena_alloc(&ctx->arena, sizeof *result);
     result->function = function;
     result->params_in = params_in;
     return result;
@@ -123,27 +101,34 @@ static void call_destructor(call_s *call)
     tstack_destroy(call->params_in);
 }
 
-void gen_call_insert(T_token *function, tstack_s *params_in)
+void gen_call_insert(context_s *ctx, symbol_s *function, tstack_s *params_in)
 {
-    sll_insert_last(&call_list, call_constructor(function, params_in));
+    sll_insert_last(&ctx->call_list, call_constructor(ctx, function, params_in));
 }
 
-void gen_prog_start(void)
+void gen_prog_start(context_s *ctx)
 {
-    puts(".IFJcode21");
-    puts("DEFVAR GF@%tmp1");
-    puts("DEFVAR GF@%tmp2");
-    puts("JUMP $%main");
-    generate_built_ins();
-    sll_init(&call_list);
+    ctx->counter = 0;
+    ctx->condition = false;
+    ctx->cond = COND_TRUE;
+    fputs(".IFJcode21\n", ctx->out);
+    fputs("DEFVAR GF@%tmp1\n", ctx->out);
+    fputs("DEFVAR GF@%tmp2\n", ctx->out);
+    for (unsigned i = 0; i < EXP_VALUES_TEMPS; i++) {
+        fprintf(ctx->out, "DEFVAR GF@%%cse%u\n", i);
+    }
+    fputs("JUMP $%main\n", ctx->out);
+    generate_built_ins(ctx);
+    sll_init_arena(&ctx->call_list, &ctx->arena);
 }
 
 /**
  * @brief  Move input parameters to their actual variable names.
  *
+ * @param[in,out] ctx Context of the compilation.
  * @param in_params Stack of all the parameters of the function.
  */
-static void gen_pop_arg(tstack_s *in_params)
+static void gen_pop_arg(context_s *ctx, tstack_s *in_params)
 {
     T_token *token;
     unsigned i;
@@ -152,106 +137,155 @@ static void gen_pop_arg(tstack_s *in_params)
     sll_activate(in_params);
     while (sll_is_active(in_params)) {
         token = sll_get_active(in_params);
-        printf("DEFVAR LF@%s\n", token->value->content);
-        printf("MOVE LF@%s LF@%%p%d\n", token->value->content, i);
+        fprintf(ctx->out, "DEFVAR LF@%s\n", token_value(token));
+        fprintf(ctx->out, "MOVE LF@%s LF@%%p%d\n", token_value(token), i);
         i++;
         sll_next(in_params);
     }
 }
 
-void gen_func_start(const char *func_name, tstack_s *in_params, unsigned no_returns)
+void gen_func_start(context_s *ctx, const char *func_name, tstack_s *in_params, unsigned no_returns)
 {
     unsigned i = 0;
 
     /* Create label for calls to jump to and PUSH TF to LF */
-    printf("\nLABEL $-%s\n", func_name);
-    puts("PUSHFRAME");
+    fprintf(ctx->out, "\nLABEL $-%s\n", func_name);
+    fputs("PUSHFRAME\n", ctx->out);
 
     /* Create variables for return values */
     for (i = 0; i < no_returns; i++) {
-        printf("DEFVAR LF@%%retval%d\n", i);
-        printf("MOVE LF@%%retval%d nil@nil\n", i);
+        fprintf(ctx->out, "DEFVAR LF@%%retval%d\n", i);
+        fprintf(ctx->out, "MOVE LF@%%retval%d nil@nil\n", i);
     }
-    gen_pop_arg(in_params);
+    gen_pop_arg(ctx, in_params);
+    expr_values_clear(&ctx->values);
 }
 
-void gen_func_end()
+void gen_func_end(context_s *ctx)
 {
     /* Push current LF as TF for caller to pop the return values and return to addres */
-    puts("POPFRAME");
-    puts("RETURN");
+    fputs("POPFRAME\n", ctx->out);
+    fputs("RETURN\n", ctx->out);
+}
+
+/**
+ * @brief Generate a jump taken if the condition on the data stack does not hold.
+ *
+ * @param[in,out] ctx Context of the compilation.
+ * @param[in] label Name of the label to jump to.
+ * @param[in] label_number Number of the label.
+ */
+static void gen_jump_unless(context_s *ctx, const char *label, unsigned label_number)
+{
+    switch (ctx->cond) {
+    case COND_EQUAL:
+        fprintf(ctx->out, "JUMPIFNEQS $-%s-%u\n", label, label_number);
+        break;
+    case COND_NOT_EQUAL:
+        fprintf(ctx->out, "JUMPIFEQS $-%s-%u\n", label, label_number);
+        break;
+    case COND_FALSE:
+        fputs("POPS GF@%tmp1\n", ctx->out);
+        fprintf(ctx->out, "JUMPIFEQ $-%s-%u GF@%%tmp1 bool@true\n", label, label_number);
+        break;
+    default:
+        fputs("POPS GF@%tmp1\n", ctx->out);
+        fprintf(ctx->out, "JUMPIFNEQ $-%s-%u GF@%%tmp1 bool@true\n", label, label_number);
+        break;
+    }
+    ctx->cond = COND_TRUE;
+}
+
+void gen_cond_start(context_s *ctx) { ctx->condition = true; }
+
+void gen_cond_not_nil(context_s *ctx)
+{
+    fputs("PUSHS nil@nil\n", ctx->out);
+    ctx->cond = COND_NOT_EQUAL;
 }
 
-unsigned gen_jump_else(void)
+unsigned gen_jump_else(context_s *ctx)
 {
     unsigned ret;
-    puts("POPS GF@%tmp1");
-    printf("JUMPIFNEQ $-else-%d GF@%%tmp1 bool@true\n", counter);
-    ret = counter;
-    counter++;
+    gen_jump_unless(ctx, "else", ctx->counter);
+    ret = ctx->counter;
+    ctx->counter++;
     return ret;
 }
 
-void gen_else_label(unsigned label_number)
+void gen_else_label(context_s *ctx, unsigned label_number)
 {
-    printf("JUMP $-end-%d\n", label_number);
-    printf("LABEL $-else-%d\n", label_number);
+    fprintf(ctx->out, "JUMP $-end-%d\n", label_number);
+    fprintf(ctx->out, "LABEL $-else-%d\n", label_number);
+    expr_values_clear(&ctx->values);
 }
 
-void gen_if_end(unsigned label_number) { printf("LABEL $-end-%d\n", label_number); }
+void gen_if_end(context_s *ctx, unsigned label_number)
+{
+    fprintf(ctx->out, "LABEL $-end-%d\n", label_number);
+    expr_values_clear(&ctx->values);
+}
 
-unsigned gen_while_label(void)
+unsigned gen_while_label(context_s *ctx)
 {
     unsigned ret;
-    printf("LABEL $-while-%d\n", counter);
-    ret = counter;
-    counter++;
+    fprintf(ctx->out, "LABEL $-while-%d\n", ctx->counter);
+    expr_values_clear(&ctx->values);
+    ret = ctx->counter;
+    ctx->counter++;
     return ret;
 }
 
-void gen_while_jump_loop(unsigned label_number) { printf("JUMP $-while-%d\n", label_number); }
+void gen_while_jump_loop(context_s *ctx, unsigned label_number)
+{
+    fprintf(ctx->out, "JUMP $-while-%d\n", label_number);
+}
 
-void gen_while_jump_end(unsigned label_number)
+void gen_while_jump_end(context_s *ctx, unsigned label_number)
 {
-    puts("POPS GF@%tmp1");
-    printf("JUMPIFNEQ $-end-%d GF@%%tmp1 bool@true\n", label_number);
+    gen_jump_unless(ctx, "end", label_number);
 }
 
-void gen_while_end_label(unsigned label_number) { printf("LABEL $-end-%d\n", label_number); }
+void gen_while_end_label(context_s *ctx, unsigned label_number)
+{
+    fprintf(ctx->out, "LABEL $-end-%d\n", label_number);
+    expr_values_clear(&ctx->values);
+}
 
-static void gen_push_arg(T_token *fun_symbol, tstack_s *in_params)
+static void gen_push_arg(context_s *ctx, symbol_s *fun_symbol, tstack_s *in_params)
 {
     T_token *token;
+    char float_literal[FLOAT_LITERAL_SIZE];
     unsigned i = 0;
 
-    sll_activate(fun_symbol->fun_info->in_params);
+    sll_activate(fun_symbol->fun_info.in_params);
 
     /* Move all in paramters values to correct variables */
     while (!tstack_empty(in_params)) {
-        T_token *fun_in = sll_get_active(fun_symbol->fun_info->in_params);
+        T_token *fun_in = sll_get_active(fun_symbol->fun_info.in_params);
         token = tstack_top(in_params);
         tstack_pop(in_params, false);
-        printf("DEFVAR TF@%%p%d\n", i);
+        fprintf(ctx->out, "DEFVAR TF@%%p%d\n", i);
         switch (token->type) {
         case TOKEN_ID:
-            printf("MOVE TF@%%p%d LF@%s\n", i, token->value->content);
+            fprintf(ctx->out, "MOVE TF@%%p%d LF@%s\n", i, token_value(token));
             break;
         case TOKEN_INT:
-            printf("MOVE TF@%%p%d int@%s\n", i, token->value->content);
+            fprintf(ctx->out, "MOVE TF@%%p%d int@%" PRId64 "\n", i, TOKEN_LITERAL(token).integer);
             if (fun_in->symbol_type == SYM_TYPE_NUMBER) {
-                printf("INT2FLOAT TF@%%p%d TF@%%p%d\n", i, i);
+                fprintf(ctx->out, "INT2FLOAT TF@%%p%d TF@%%p%d\n", i, i);
             }
             break;
         case TOKEN_NUMBER:
-            escape_float(&token->value);
-            printf("MOVE TF@%%p%d float@%s\n", i, token->value->content);
+            fprintf(ctx->out, "MOVE TF@%%p%d float@%s\n", i,
+                format_float(TOKEN_LITERAL(token).number, float_literal));
             break;
         case TOKEN_STRING:
-            printf("MOVE TF@%%p%d string@%s\n", i, token->value->content);
+            fprintf(ctx->out, "MOVE TF@%%p%d string@%s\n", i, token_value(token));
             break;
         case TOKEN_KEYWORD:
-            if (!strcmp(token->value->content, "nil")) {
-                printf("MOVE TF@%%p%d nil@nil\n", i);
+            if (token->keyword == NIL) {
+                fprintf(ctx->out, "MOVE TF@%%p%d nil@nil\n", i);
             } else {
                 /* Should not happen */
                 ERR_MSG("Unexpected type of input parameter: keyword on line: ", token->line);
@@ -266,61 +300,75 @@ static void gen_push_arg(T_token *fun_symbol, tstack_s *in_params)
         }
 
         i++;
-        sll_next(fun_symbol->fun_info->in_params);
-        FREE(token);
+        sll_next(fun_symbol->fun_info.in_params);
+        token_destroy(token);
     }
 }
 
-void gen_func_call(T_token *fun_symbol, tstack_s *in_params)
+void gen_func_call(context_s *ctx, symbol_s *fun_symbol, tstack_s *in_params)
 {
-    if (!strcmp("write", fun_symbol->value->content)) {
-        gen_write(in_params);
+    if (!strcmp(fun_symbol->name, "write")) {
+        gen_write(ctx, in_params);
     } else {
-        puts("CREATEFRAME");
-        gen_push_arg(fun_symbol, in_params);
-        printf("CALL $-%s\n", fun_symbol->value->content);
+        fputs("CREATEFRAME\n", ctx->out);
+        gen_push_arg(ctx, fun_symbol, in_params);
+        fprintf(ctx->out, "CALL $-%s\n", fun_symbol->name);
+        /* The called function uses the temporaries too */
+        expr_values_call(&ctx->values);
     }
 }
 
-void gen_function_call_list(void)
+void gen_function_call_list(context_s *ctx)
 {
     call_s *current_call;
 
-    puts("LABEL $%main");
-    puts("CREATEFRAME");
-    puts("PUSHFRAME");
-    sll_activate(&call_list);
-    while (sll_is_active(&call_list)) {
-        current_call = (call_s *)sll_get_active(&call_list);
-        gen_func_call(current_call->function, current_call->params_in);
+    fputs("LABEL $%main\n", ctx->out);
+    fputs("CREATEFRAME\n", ctx->out);
+    fputs("PUSHFRAME\n", ctx->out);
+    expr_values_clear(&ctx->values);
+    sll_activate(&ctx->call_list);
+    while (sll_is_active(&ctx->call_list)) {
+        current_call = (call_s *)sll_get_active(&ctx->call_list);
+        gen_func_call(ctx, current_call->function, current_call->params_in);
         call_destructor(current_call);
-        sll_next(&call_list);
+        sll_next(&ctx->call_list);
     }
 
-    sll_destroy(&call_list, true);
-    puts("EXIT int@0");
+    /* The calls are released together with the arena */
+    sll_destroy(&ctx->call_list, false);
+    fputs("EXIT int@0\n", ctx->out);
 }
 
-void gen_expr_operand(T_token *token)
+/**
+ * @brief Generate code for a single operand in expression.
+ *
+ * @param[in,out] ctx Context of the compilation.
+ * @param[in] token The operand to generate.
+ */
+static void gen_expr_operand(context_s *ctx, const T_token *token)
 {
+    char float_literal[FLOAT_LITERAL_SIZE];
+
     switch (token->type) {
     case TOKEN_ID:
-        printf("PUSHS LF@%s\n", token->value->content);
+        fprintf(ctx->out, "PUSHS LF@%s\n", token_value(token));
         break;
     case TOKEN_INT:
-        printf("PUSHS int@%s\n", token->value->content);
+        fprintf(ctx->out, "PUSHS int@%" PRId64 "\n", TOKEN_LITERAL(token).integer);
         break;
     case TOKEN_NUMBER:
-        escape_float(&token->value);
-        printf("PUSHS float@%s\n", token->value->content);
+        fprintf(
+            ctx->out, "PUSHS float@%s\n", format_float(TOKEN_LITERAL(token).number, float_literal));
         break;
     case TOKEN_STRING:
-        escape_string(&token->value);
-        printf("PUSHS string@%s\n", token->value->content);
+        fprintf(ctx->out, "PUSHS string@%s\n", token_value(token));
+        break;
+    case TOKEN_BOOL:
+        fprintf(ctx->out, "PUSHS bool@%s\n", token_value(token));
         break;
     case TOKEN_KEYWORD:
-        if (!strcmp(token->value->content, "nil")) {
-            puts("PUSHS nil@nil");
+        if (token->keyword == NIL) {
+            fputs("PUSHS nil@nil\n", ctx->out);
         } else {
             /* Should not happen */
             ERR_MSG("Unexpected type of operand value: keyword on line: ", token->line);
@@ -335,75 +383,108 @@ void gen_expr_operand(T_token *token)
     }
 }
 
-void gen_expr_operator(T_token *token)
+/**
+ * @brief Check if the operands of a comparison are always ordered, so that `a <= b` is the same as
+ * `not (a > b)`. A number may be not a number, which is not ordered.
+ *
+ * @param[in] node The comparison.
+ *
+ * @return True for two integers or two strings.
+ */
+static bool is_ordered(const expr_node_s *node)
 {
+    return !node->left->to_number && !node->right->to_number
+        && node->left->type == node->right->type
+        && (node->left->type == SYM_TYPE_INT || node->left->type == SYM_TYPE_STRING);
+}
+
+/**
+ * @brief Generate code for a single operator application in expression.
+ *
+ * @param[in,out] ctx Context of the compilation.
+ * @param[in] node The operator to generate.
+ */
+static void gen_expr_operator(context_s *ctx, const expr_node_s *node)
+{
+    const T_token *token = &node->token;
+
     switch (token->type) {
     case TOKEN_EQUAL:
-        puts("EQS");
+        fputs("EQS\n", ctx->out);
         break;
     case TOKEN_LESS_THAN:
-        puts("LTS");
+        fputs("LTS\n", ctx->out);
         break;
     case TOKEN_LESS_EQUAL_THAN:
-        puts("POPS GF@%tmp2");
-        puts("POPS GF@%tmp1");
-        puts("PUSHS GF@%tmp1");
-        puts("PUSHS GF@%tmp2");
-        puts("PUSHS GF@%tmp1");
-        puts("PUSHS GF@%tmp2");
-        puts("LTS");
-        puts("POPS GF@%tmp1");
-        puts("EQS");
-        puts("PUSHS GF@%tmp1");
-        puts("ORS");
+        if (is_ordered(node)) {
+            fputs("GTS\n", ctx->out);
+            fputs("NOTS\n", ctx->out);
+            break;
+        }
+        fputs("POPS GF@%tmp2\n", ctx->out);
+        fputs("POPS GF@%tmp1\n", ctx->out);
+        fputs("PUSHS GF@%tmp1\n", ctx->out);
+        fputs("PUSHS GF@%tmp2\n", ctx->out);
+        fputs("PUSHS GF@%tmp1\n", ctx->out);
+        fputs("PUSHS GF@%tmp2\n", ctx->out);
+        fputs("LTS\n", ctx->out);
+        fputs("POPS GF@%tmp1\n", ctx->out);
+        fputs("EQS\n", ctx->out);
+        fputs("PUSHS GF@%tmp1\n", ctx->out);
+        fputs("ORS\n", ctx->out);
         break;
     case TOKEN_GREATER_THAN:
-        puts("GTS");
+        fputs("GTS\n", ctx->out);
         break;
     case TOKEN_GREATER_EQUAL_THAN:
-        puts("POPS GF@%tmp2");
-        puts("POPS GF@%tmp1");
-        puts("PUSHS GF@%tmp1");
-        puts("PUSHS GF@%tmp2");
-        puts("PUSHS GF@%tmp1");
-        puts("PUSHS GF@%tmp2");
-        puts("GTS");
-        puts("POPS GF@%tmp1");
-        puts("EQS");
-        puts("PUSHS GF@%tmp1");
-        puts("ORS");
+        if (is_ordered(node)) {
+            fputs("LTS\n", ctx->out);
+            fputs("NOTS\n", ctx->out);
+            break;
+        }
+        fputs("POPS GF@%tmp2\n", ctx->out);
+        fputs("POPS GF@%tmp1\n", ctx->out);
+        fputs("PUSHS GF@%tmp1\n", ctx->out);
+        fputs("PUSHS GF@%tmp2\n", ctx->out);
+        fputs("PUSHS GF@%tmp1\n", ctx->out);
+        fputs("PUSHS GF@%tmp2\n", ctx->out);
+        fputs("GTS\n", ctx->out);
+        fputs("POPS GF@%tmp1\n", ctx->out);
+        fputs("EQS\n", ctx->out);
+        fputs("PUSHS GF@%tmp1\n", ctx->out);
+        fputs("ORS\n", ctx->out);
         break;
     case TOKEN_DIVISION:
-        puts("CALL $-check-div-error");
-        puts("DIVS");
+        fputs("CALL $-check-div-error\n", ctx->out);
+        fputs("DIVS\n", ctx->out);
         break;
     case TOKEN_FLOOR_DIVISION:
-        puts("CALL $-check-div-error");
-        puts("IDIVS");
+        fputs("CALL $-check-div-error\n", ctx->out);
+        fputs("IDIVS\n", ctx->out);
         break;
     case TOKEN_MUL:
-        puts("MULS");
+        fputs("MULS\n", ctx->out);
         break;
     case TOKEN_SUB:
-        puts("SUBS");
+        fputs("SUBS\n", ctx->out);
         break;
     case TOKEN_NOT_EQUAL_TO:
-        puts("EQS");
-        puts("NOTS");
+        fputs("EQS\n", ctx->out);
+        fputs("NOTS\n", ctx->out);
         break;
     case TOKEN_STRING_CONCAT:
-        puts("POPS GF@%tmp2");
-        puts("POPS GF@%tmp1");
-        puts("CONCAT GF@%tmp1 GF@%tmp1 GF@%tmp2");
-        puts("PUSHS GF@%tmp1");
+        fputs("POPS GF@%tmp2\n", ctx->out);
+        fputs("POPS GF@%tmp1\n", ctx->out);
+        fputs("CONCAT GF@%tmp1 GF@%tmp1 GF@%tmp2\n", ctx->out);
+        fputs("PUSHS GF@%tmp1\n", ctx->out);
         break;
     case TOKEN_ADD:
-        puts("ADDS");
+        fputs("ADDS\n", ctx->out);
         break;
     case TOKEN_STRING_LENGTH:
-        puts("POPS GF@%tmp1");
-        puts("STRLEN GF@%tmp1 GF@%tmp1");
-        puts("PUSHS GF@%tmp1");
+        fputs("POPS GF@%tmp1\n", ctx->out);
+        fputs("STRLEN GF@%tmp1 GF@%tmp1\n", ctx->out);
+        fputs("PUSHS GF@%tmp1\n", ctx->out);
         break;
     default:
         /* Should not happen */
@@ -413,223 +494,445 @@ void gen_expr_operator(T_token *token)
     }
 }
 
-void gen_expr_cond(void) { puts("POPS GF@%tmp1"); }
+/**
+ * @brief Generate code for the operator of a condition. A negation is left for the conditional
+ * jump and the equality is compared by the jump itself.
+ *
+ * @param[in,out] ctx Context of the compilation.
+ * @param[in] node The operator at the root of the condition.
+ *
+ * @return What is left on the data stack for the jump.
+ */
+static cond_e gen_cond_operator(context_s *ctx, const expr_node_s *node)
+{
+    switch (node->token.type) {
+    case TOKEN_EQUAL:
+        return COND_EQUAL;
+    case TOKEN_NOT_EQUAL_TO:
+        return COND_NOT_EQUAL;
+    case TOKEN_LESS_EQUAL_THAN:
+        if (is_ordered(node)) {
+            fputs("GTS\n", ctx->out);
+            return COND_FALSE;
+        }
+        break;
+    case TOKEN_GREATER_EQUAL_THAN:
+        if (is_ordered(node)) {
+            fputs("LTS\n", ctx->out);
+            return COND_FALSE;
+        }
+        break;
+    default:
+        break;
+    }
+    gen_expr_operator(ctx, node);
+    return COND_TRUE;
+}
+
+/**
+ * @brief Convert the integer operands on top of the data stack to numbers.
+ *
+ * @param[in,out] ctx Context of the compilation.
+ * @param[in] convert_first Convert the first operand.
+ * @param[in] convert_second Convert the second operand, the one on the top.
+ */
+static void gen_convert_to_number(context_s *ctx, bool convert_first, bool convert_second)
+{
+    fputs("POPS GF@%tmp2\n", ctx->out);
+    fputs("POPS GF@%tmp1\n", ctx->out);
+    if (convert_first) {
+        fputs("INT2FLOAT GF@%tmp1 GF@%tmp1\n", ctx->out);
+    }
+    if (convert_second) {
+        fputs("INT2FLOAT GF@%tmp2 GF@%tmp2\n", ctx->out);
+    }
+    fputs("PUSHS GF@%tmp1\n", ctx->out);
+    fputs("PUSHS GF@%tmp2\n", ctx->out);
+}
+
+/**
+ * @brief Order the nodes of a tree so that each of them follows its operands. The operands of the
+ * reused nodes are left out.
+ *
+ * @param[in] root The root of the tree.
+ * @param[out] pending Space for the nodes still to be ordered, as many as the nodes of the tree.
+ * @param[out] order The ordered nodes at the end of the array of the size of the tree.
+ * @param[in] size Number of nodes of the tree.
+ *
+ * @return Index of the first ordered node.
+ */
+static unsigned order_nodes(
+    expr_node_s *root, expr_node_s **pending, expr_node_s **order, unsigned size)
+{
+    expr_node_s *node;
+    unsigned count = 0, position = size;
+
+    /* Deep expressions must not recurse, the post-order is built first from its reverse */
+    pending[count++] = root;
+    while (count) {
+        node = pending[--count];
+        order[--position] = node;
+        if (node->reuse) {
+            continue;
+        }
+        if (node->left) {
+            pending[count++] = node->left;
+        }
+        if (node->right) {
+            pending[count++] = node->right;
+        }
+    }
+    return position;
+}
+
+/**
+ * @brief Decide which values of an expression are pushed from a variable or a temporary instead
+ * of computed. The nodes are visited from the left in the order they are generated.
+ *
+ * @param[in,out] values Values of the current basic block.
+ * @param[in] root The root of the expression.
+ * @param[out] pending Space for the nodes still to be visited, as many as the nodes of the tree.
+ */
+static void find_reused(expr_values_s *values, expr_node_s *root, expr_node_s **pending)
+{
+    expr_node_s *node;
+    expr_value_s *value;
+    unsigned count = 0;
+    bool worth;
+
+    pending[count++] = root;
+    while (count) {
+        node = pending[--count];
+        if (!node->left) {
+            continue;
+        }
+        value = node->value;
+        /* Storing an operator on two leaves costs as much as computing it again */
+        worth = node->left->left || (node->right && node->right->left);
+
+        if (expr_values_variable(values, value)) {
+            node->reuse = true;
+            continue;
+        }
+        if (expr_values_temp(values, value) >= 0) {
+            expr_values_reserve(values, value);
+            node->reuse = true;
+            continue;
+        }
+        if (value->stamp == values->stamp) {
+            /* Repeated in this expression, so the first node keeps it when it is generated */
+            if (expr_values_reserve(values, value) >= 0) {
+                node->reuse = true;
+                continue;
+            }
+        } else if (value->stamp && worth) {
+            /* Computed by an earlier expression again, later ones may reuse it */
+            expr_values_reserve(values, value);
+        }
+        value->stamp = values->stamp;
+
+        if (node->right) {
+            pending[count++] = node->right;
+        }
+        pending[count++] = node->left;
+    }
+}
+
+void gen_expr(context_s *ctx, const expr_tree_s *tree)
+{
+    expr_node_s **pending, **order, *node;
+    const char *variable;
+    unsigned position;
+    bool condition;
+    int temp;
+
+    condition = ctx->condition;
+    ctx->condition = false;
+    ctx->cond = COND_TRUE;
+    if (!tree->root) {
+        return;
+    }
 
-void gen_write(tstack_s *in_params)
+    pending = arena_alloc(&ctx->arena, tree->size * sizeof *pending);
+    order = arena_alloc(&ctx->arena, tree->size * sizeof *order);
+    expr_values_begin(&ctx->values, tree->size);
+    position = order_nodes(tree->root, pending, order, tree->size);
+    for (unsigned i = position; i < tree->size; i++) {
+        order[i]->value = expr_values_find(&ctx->values, order[i]);
+    }
+    ctx->values.result = tree->root->value;
+
+    find_reused(&ctx->values, tree->root, pending);
+    position = order_nodes(tree->root, pending, order, tree->size);
+    for (unsigned i = position; i < tree->size; i++) {
+        node = order[i];
+        if (node->reuse) {
+            variable = expr_values_variable(&ctx->values, node->value);
+            temp = expr_values_temp(&ctx->values, node->value);
+            if (variable) {
+                fprintf(ctx->out, "PUSHS LF@%s\n", variable);
+            } else {
+                fprintf(ctx->out, "PUSHS GF@%%cse%d\n", temp);
+            }
+            continue;
+        }
+        if (!node->left) {
+            gen_expr_operand(ctx, &node->token);
+            continue;
+        }
+        if (node->right && (node->left->to_number || node->right->to_number)) {
+            gen_convert_to_number(ctx, node->left->to_number, node->right->to_number);
+        }
+
+        /* Only the values reserved by this expression have a temporary and are not reused */
+        temp = expr_values_temp(&ctx->values, node->value);
+        if (node == tree->root && condition && temp < 0) {
+            ctx->cond = gen_cond_operator(ctx, node);
+            continue;
+        }
+        gen_expr_operator(ctx, node);
+        if (temp >= 0) {
+            fprintf(ctx->out, "POPS GF@%%cse%d\n", temp);
+            fprintf(ctx->out, "PUSHS GF@%%cse%d\n", temp);
+        }
+    }
+}
+
+void gen_expr_cond(context_s *ctx) { fputs("POPS GF@%tmp1\n", ctx->out); }
+
+void gen_write(context_s *ctx, tstack_s *in_params)
 {
     T_token *token;
+    char float_literal[FLOAT_LITERAL_SIZE];
 
     while (!tstack_empty(in_params)) {
         token = tstack_top(in_params);
         tstack_pop(in_params, false);
-        escape_string(&token->value);
-        puts("CREATEFRAME");
-        puts("DEFVAR TF@%p0");
+        fputs("CREATEFRAME\n", ctx->out);
+        fputs("DEFVAR TF@%p0\n", ctx->out);
         if (token->type == TOKEN_ID) {
-            printf("MOVE TF@%%p0 LF@%s\n", token->value->content);
-        } else if (token->symbol_type == SYM_TYPE_NUMBER) {
-            escape_float(&token->value);
-            printf("MOVE TF@%%p0 float@%s\n", token->value->content);
+            fprintf(ctx->out, "MOVE TF@%%p0 LF@%s\n", token_value(token));
+        } else if (token->type == TOKEN_INT) {
+            fprintf(ctx->out, "MOVE TF@%%p0 int@%" PRId64 "\n", TOKEN_LITERAL(token).integer);
+        } else if (token->type == TOKEN_NUMBER) {
+            fprintf(ctx->out, "MOVE TF@%%p0 float@%s\n",
+                format_float(TOKEN_LITERAL(token).number, float_literal));
         } else {
-            printf("MOVE TF@%%p0 string@%s\n", token->value->content);
+            fprintf(ctx->out, "MOVE TF@%%p0 string@%s\n", token_value(token));
         }
-        puts("CALL $-write");
+        fputs("CALL $-write\n", ctx->out);
     }
 }
 
-void gen_var_decl(T_token *id)
+void gen_var_decl(context_s *ctx, T_token *id)
+{
+    fprintf(ctx->out, "DEFVAR LF@%s\n", token_value(id));
+    fprintf(ctx->out, "MOVE LF@%s nil@nil\n", token_value(id));
+    expr_values_assign(&ctx->values, token_value(id), NULL);
+}
+
+void gen_assign(context_s *ctx, const T_token *id, bool bind)
+{
+    fprintf(ctx->out, "POPS LF@%s\n", token_value(id));
+    expr_values_assign(&ctx->values, token_value(id), bind ? ctx->values.result : NULL);
+}
+
+void gen_assign_result(context_s *ctx, const T_token *id, unsigned index, bool convert)
 {
-    printf("DEFVAR LF@%s\n", id->value->content);
-    printf("MOVE LF@%s nil@nil\n", id->value->content);
+    if (convert) {
+        fprintf(ctx->out, "INT2FLOAT TF@%%retval%u TF@%%retval%u\n", index, index);
+    }
+    fprintf(ctx->out, "MOVE LF@%s TF@%%retval%u\n", token_value(id), index);
+    expr_values_assign(&ctx->values, token_value(id), NULL);
 }
 
-static void gen_reads(void)
+static void gen_reads(context_s *ctx)
 {
     tstack_s in_params;
     tstack_init(&in_params);
 
-    gen_func_start("reads", &in_params, 1);
-    puts("READ LF@%retval0 string");
-    puts("POPFRAME");
-    puts("RETURN");
+    gen_func_start(ctx, "reads", &in_params, 1);
+    fputs("READ LF@%retval0 string\n", ctx->out);
+    fputs("POPFRAME\n", ctx->out);
+    fputs("RETURN\n", ctx->out);
 
     tstack_destroy(&in_params);
 }
 
-static void gen_readi(void)
+static void gen_readi(context_s *ctx)
 {
     tstack_s in_params;
     tstack_init(&in_params);
 
-    gen_func_start("readi", &in_params, 1);
-    puts("READ LF@%retval0 int");
-    puts("POPFRAME");
-    puts("RETURN");
+    gen_func_start(ctx, "readi", &in_params, 1);
+    fputs("READ LF@%retval0 int\n", ctx->out);
+    fputs("POPFRAME\n", ctx->out);
+    fputs("RETURN\n", ctx->out);
 
     tstack_destroy(&in_params);
 }
-static void gen_readn(void)
+static void gen_readn(context_s *ctx)
 {
     tstack_s in_params;
     tstack_init(&in_params);
 
-    gen_func_start("readn", &in_params, 1);
-    puts("READ LF@%retval0 float");
-    puts("POPFRAME");
-    puts("RETURN");
+    gen_func_start(ctx, "readn", &in_params, 1);
+    fputs("READ LF@%retval0 float\n", ctx->out);
+    fputs("POPFRAME\n", ctx->out);
+    fputs("RETURN\n", ctx->out);
 
     tstack_destroy(&in_params);
 }
-static void gen_tointeger(void)
+static void gen_tointeger(context_s *ctx)
 {
     tstack_s in_params;
     tstack_init(&in_params);
 
-    gen_func_start("tointeger", &in_params, 1);
+    gen_func_start(ctx, "tointeger", &in_params, 1);
 
-    puts("TYPE GF@%tmp1 LF@%p0");
-    puts("JUMPIFNEQ $-tointeger-ok GF@%tmp1 string@nil");
-    puts("MOVE LF@%retval0 nil@nil");
-    puts("POPFRAME");
-    puts("RETURN");
-    puts("LABEL $-tointeger-ok");
-    puts("FLOAT2INT LF@%retval0 LF@%p0");
-    puts("POPFRAME");
-    puts("RETURN");
+    fputs("TYPE GF@%tmp1 LF@%p0\n", ctx->out);
+    fputs("JUMPIFNEQ $-tointeger-ok GF@%tmp1 string@nil\n", ctx->out);
+    fputs("MOVE LF@%retval0 nil@nil\n", ctx->out);
+    fputs("POPFRAME\n", ctx->out);
+    fputs("RETURN\n", ctx->out);
+    fputs("LABEL $-tointeger-ok\n", ctx->out);
+    fputs("FLOAT2INT LF@%retval0 LF@%p0\n", ctx->out);
+    fputs("POPFRAME\n", ctx->out);
+    fputs("RETURN\n", ctx->out);
 
     tstack_destroy(&in_params);
 }
-static void gen_substr(void)
+static void gen_substr(context_s *ctx)
 {
     tstack_s in_params;
     tstack_init(&in_params);
 
-    gen_func_start("substr", &in_params, 1);
-    puts("MOVE LF@%retval0 string@");
-    puts("DEFVAR LF@%iter");
-    puts("DEFVAR LF@%c");
-    puts("DEFVAR LF@%end_index");
-    puts("MOVE LF@%end_index LF@%p2");
-    puts("MOVE LF@%iter LF@%p1");
-    puts("SUB LF@%iter LF@%iter int@1");
-    puts("DEFVAR LF@%cond");
-    puts("DEFVAR LF@%strlen");
-    puts("STRLEN LF@%strlen LF@%p0");
-    puts("GT LF@%cond LF@%p1 LF@%p2");
-    puts("JUMPIFEQ $-substr_end LF@%cond bool@true");
-    puts("GT LF@%cond LF@%p1 int@0");
-    puts("JUMPIFEQ $-substr_end LF@%cond bool@false");
-    puts("GT LF@%cond LF@%p2 int@0");
-    puts("JUMPIFEQ $-substr_end LF@%cond bool@false");
-    puts("GT LF@%cond LF@%p2 LF@%strlen");
-    puts("JUMPIFEQ $-substr_end LF@%cond bool@true");
-    puts("LABEL $-strloop");
-    puts("LT LF@%cond LF@%iter LF@%end_index");
-    puts("JUMPIFEQ $-substr_end LF@%cond bool@false");
-    puts("GETCHAR LF@%c LF@%p0 LF@%iter");
-    puts("CONCAT LF@%retval0 LF@%retval0 LF@%c");
-    puts("ADD LF@%iter LF@%iter int@1");
-    puts("JUMP $-strloop");
-    puts("LABEL $-substr_end");
-    puts("POPFRAME");
-    puts("RETURN");
+    gen_func_start(ctx, "substr", &in_params, 1);
+    fputs("MOVE LF@%retval0 string@\n", ctx->out);
+    fputs("DEFVAR LF@%iter\n", ctx->out);
+    fputs("DEFVAR LF@%c\n", ctx->out);
+    fputs("DEFVAR LF@%end_index\n", ctx->out);
+    fputs("MOVE LF@%end_index LF@%p2\n", ctx->out);
+    fputs("MOVE LF@%iter LF@%p1\n", ctx->out);
+    fputs("SUB LF@%iter LF@%iter int@1\n", ctx->out);
+    fputs("DEFVAR LF@%cond\n", ctx->out);
+    fputs("DEFVAR LF@%strlen\n", ctx->out);
+    fputs("STRLEN LF@%strlen LF@%p0\n", ctx->out);
+    fputs("GT LF@%cond LF@%p1 LF@%p2\n", ctx->out);
+    fputs("JUMPIFEQ $-substr_end LF@%cond bool@true\n", ctx->out);
+    fputs("GT LF@%cond LF@%p1 int@0\n", ctx->out);
+    fputs("JUMPIFEQ $-substr_end LF@%cond bool@false\n", ctx->out);
+    fputs("GT LF@%cond LF@%p2 int@0\n", ctx->out);
+    fputs("JUMPIFEQ $-substr_end LF@%cond bool@false\n", ctx->out);
+    fputs("GT LF@%cond LF@%p2 LF@%strlen\n", ctx->out);
+    fputs("JUMPIFEQ $-substr_end LF@%cond bool@true\n", ctx->out);
+    fputs("LABEL $-strloop\n", ctx->out);
+    fputs("LT LF@%cond LF@%iter LF@%end_index\n", ctx->out);
+    fputs("JUMPIFEQ $-substr_end LF@%cond bool@false\n", ctx->out);
+    fputs("GETCHAR LF@%c LF@%p0 LF@%iter\n", ctx->out);
+    fputs("CONCAT LF@%retval0 LF@%retval0 LF@%c\n", ctx->out);
+    fputs("ADD LF@%iter LF@%iter int@1\n", ctx->out);
+    fputs("JUMP $-strloop\n", ctx->out);
+    fputs("LABEL $-substr_end\n", ctx->out);
+    fputs("POPFRAME\n", ctx->out);
+    fputs("RETURN\n", ctx->out);
 
     tstack_destroy(&in_params);
 }
 
-static void gen_ord(void)
+static void gen_ord(context_s *ctx)
 {
     tstack_s in_params;
     tstack_init(&in_params);
 
-    gen_func_start("ord", &in_params, 1);
-    puts("DEFVAR LF@%index");
-    puts("MOVE LF@%index LF@%p1");
-    puts("DEFVAR LF@%cond");
-    puts("DEFVAR LF@%strlen");
-    puts("STRLEN LF@%strlen LF@%p0");
-    puts("GT LF@%cond LF@%index int@0");
-    puts("JUMPIFEQ $-ord-err LF@%cond bool@false");
-    puts("GT LF@%cond LF@%index LF@%strlen");
-    puts("JUMPIFEQ $-ord-err LF@%cond bool@true");
-    puts("JUMP $-ord-ok");
-    puts("LABEL $-ord-err");
-    puts("EXIT int@8");
-    puts("LABEL $-ord-ok");
-    puts("MOVE LF@%index LF@%p1");
-    puts("SUB LF@%index LF@%index int@1");
-    puts("STRI2INT LF@%retval0 LF@%p0 LF@%index");
-    puts("POPFRAME");
-    puts("RETURN");
+    gen_func_start(ctx, "ord", &in_params, 1);
+    fputs("DEFVAR LF@%index\n", ctx->out);
+    fputs("MOVE LF@%index LF@%p1\n", ctx->out);
+    fputs("DEFVAR LF@%cond\n", ctx->out);
+    fputs("DEFVAR LF@%strlen\n", ctx->out);
+    fputs("STRLEN LF@%strlen LF@%p0\n", ctx->out);
+    fputs("GT LF@%cond LF@%index int@0\n", ctx->out);
+    fputs("JUMPIFEQ $-ord-err LF@%cond bool@false\n", ctx->out);
+    fputs("GT LF@%cond LF@%index LF@%strlen\n", ctx->out);
+    fputs("JUMPIFEQ $-ord-err LF@%cond bool@true\n", ctx->out);
+    fputs("JUMP $-ord-ok\n", ctx->out);
+    fputs("LABEL $-ord-err\n", ctx->out);
+    fputs("EXIT int@8\n", ctx->out);
+    fputs("LABEL $-ord-ok\n", ctx->out);
+    fputs("MOVE LF@%index LF@%p1\n", ctx->out);
+    fputs("SUB LF@%index LF@%index int@1\n", ctx->out);
+    fputs("STRI2INT LF@%retval0 LF@%p0 LF@%index\n", ctx->out);
+    fputs("POPFRAME\n", ctx->out);
+    fputs("RETURN\n", ctx->out);
 
     tstack_destroy(&in_params);
 }
 
-static void gen_chr(void)
+static void gen_chr(context_s *ctx)
 {
     tstack_s in_params;
 
-    gen_func_start("chr", &in_params, 1);
-    puts("DEFVAR LF@%cond");
-    puts("EQ LF@%cond nil@nil LF@%p0");
-    puts("JUMPIFEQ $-chr-ok LF@%cond bool@false");
-    puts("EXIT int@8");
-    puts("LABEL $-chr-ok");
-    puts("LT LF@%cond LF@%p0 int@0");
-    puts("JUMPIFEQ $-chr-end LF@%cond bool@true");
-    puts("GT LF@%cond LF@%p0 int@255");
-    puts("JUMPIFEQ $-chr-end LF@%cond bool@true");
-    puts("INT2CHAR LF@%retval0 LF@%p0");
-    puts("LABEL $-chr-end");
-    puts("POPFRAME");
-    puts("RETURN");
+    gen_func_start(ctx, "chr", &in_params, 1);
+    fputs("DEFVAR LF@%cond\n", ctx->out);
+    fputs("EQ LF@%cond nil@nil LF@%p0\n", ctx->out);
+    fputs("JUMPIFEQ $-chr-ok LF@%cond bool@false\n", ctx->out);
+    fputs("EXIT int@8\n", ctx->out);
+    fputs("LABEL $-chr-ok\n", ctx->out);
+    fputs("LT LF@%cond LF@%p0 int@0\n", ctx->out);
+    fputs("JUMPIFEQ $-chr-end LF@%cond bool@true\n", ctx->out);
+    fputs("GT LF@%cond LF@%p0 int@255\n", ctx->out);
+    fputs("JUMPIFEQ $-chr-end LF@%cond bool@true\n", ctx->out);
+    fputs("INT2CHAR LF@%retval0 LF@%p0\n", ctx->out);
+    fputs("LABEL $-chr-end\n", ctx->out);
+    fputs("POPFRAME\n", ctx->out);
+    fputs("RETURN\n", ctx->out);
 
     tstack_destroy(&in_params);
 }
 
-static void gen_builtin_write(void)
+static void gen_builtin_write(context_s *ctx)
 {
     tstack_s in_params;
 
-    gen_func_start("write", &in_params, 1);
-    puts("EQ GF@%tmp1 LF@%p0 nil@nil");
-    puts("JUMPIFNEQ $-non-nil GF@%tmp1 bool@true");
-    puts("WRITE string@nil");
-    puts("JUMP $-write-end");
-    puts("LABEL $-non-nil");
-    puts("WRITE LF@%p0");
-    puts("LABEL $-write-end");
-    puts("POPFRAME");
-    puts("RETURN");
-}
-
-static void gen_check_div_error(void)
-{
-    puts("LABEL $-check-div-error");
-    puts("POPS GF@%tmp1");
-    puts("TYPE GF@%tmp2 GF@%tmp1");
-    puts("JUMPIFEQ $-div-integer GF@%tmp2 string@int");
-    puts("JUMPIFEQ $-div-err GF@%tmp1 float@0x0p+0");
-    puts("JUMP $-div-ok");
-    puts("LABEL $-div-integer");
-    puts("JUMPIFEQ $-div-err GF@%tmp1 int@0");
-    puts("LABEL $-div-ok");
-    puts("PUSHS GF@%tmp1");
-    puts("RETURN");
-    puts("LABEL $-div-err");
-    puts("WRITE string@Zero\\032Division\\032Error!\\010");
-    puts("EXIT int@9");
-}
-
-static void generate_built_ins(void)
-{
-    gen_reads();
-    gen_readi();
-    gen_readn();
-    gen_tointeger();
-    gen_substr();
-    gen_ord();
-    gen_chr();
-    gen_builtin_write();
-    gen_check_div_error();
+    gen_func_start(ctx, "write", &in_params, 1);
+    fputs("EQ GF@%tmp1 LF@%p0 nil@nil\n", ctx->out);
+    fputs("JUMPIFNEQ $-non-nil GF@%tmp1 bool@true\n", ctx->out);
+    fputs("WRITE string@nil\n", ctx->out);
+    fputs("JUMP $-write-end\n", ctx->out);
+    fputs("LABEL $-non-nil\n", ctx->out);
+    fputs("WRITE LF@%p0\n", ctx->out);
+    fputs("LABEL $-write-end\n", ctx->out);
+    fputs("POPFRAME\n", ctx->out);
+    fputs("RETURN\n", ctx->out);
+}
+
+static void gen_check_div_error(context_s *ctx)
+{
+    fputs("LABEL $-check-div-error\n", ctx->out);
+    fputs("POPS GF@%tmp1\n", ctx->out);
+    fputs("TYPE GF@%tmp2 GF@%tmp1\n", ctx->out);
+    fputs("JUMPIFEQ $-div-integer GF@%tmp2 string@int\n", ctx->out);
+    fputs("JUMPIFEQ $-div-err GF@%tmp1 float@0x0p+0\n", ctx->out);
+    fputs("JUMP $-div-ok\n", ctx->out);
+    fputs("LABEL $-div-integer\n", ctx->out);
+    fputs("JUMPIFEQ $-div-err GF@%tmp1 int@0\n", ctx->out);
+    fputs("LABEL $-div-ok\n", ctx->out);
+    fputs("PUSHS GF@%tmp1\n", ctx->out);
+    fputs("RETURN\n", ctx->out);
+    fputs("LABEL $-div-err\n", ctx->out);
+    fputs("WRITE string@Zero\\032Division\\032Error!\\010\n", ctx->out);
+    fputs("EXIT int@9\n", ctx->out);
+}
+
+static void generate_built_ins(context_s *ctx)
+{
+    gen_reads(ctx);
+    gen_readi(ctx);
+    gen_readn(ctx);
+    gen_tointeger(ctx);
+    gen_substr(ctx);
+    gen_ord(ctx);
+    gen_chr(ctx);
+    gen_builtin_write(ctx);
+    gen_check_div_error(ctx);
 }
@@ -9,134 +9,191 @@
 #include <stdio.h>
 #include <string.h>
 
+#include "context.h"
+#include "exp_tree.h"
 #include "token_stack.h"
 
 /**
  * @brief Generates code for the beginning of the program.
+ *
+ * @param[in,out] ctx Context of the compilation.
  */
-void gen_prog_start(void);
+void gen_prog_start(context_s *ctx);
 
 /**
  * @brief Generates start of the function. Creates return values. Local variables for parameters.
  *
+ * @param[in,out] ctx Context of the compilation.
  * @param[in] func_name Name of the function used for label.
  * @param[in] in_param Stack of all the parameters of the function.
  * @param[in] no_returns Number of return parameters of the function.
  */
-void gen_func_start(const char *func_name, tstack_s *in_param, unsigned no_returns);
+void gen_func_start(context_s *ctx, const char *func_name, tstack_s *in_param, unsigned no_returns);
 
 /**
  * @brief Generates end of the function. Returns.
+ *
+ * @param[in,out] ctx Context of the compilation.
+ */
+void gen_func_end(context_s *ctx);
+
+/**
+ * @brief Mark the next expression as the condition of an if or a while statement. Its comparison
+ * may be left for the conditional jump.
+ *
+ * @param[in,out] ctx Context of the compilation.
+ */
+void gen_cond_start(context_s *ctx);
+
+/**
+ * @brief Make the value of a condition that is not a boolean hold if it is not nil.
+ *
+ * @param[in,out] ctx Context of the compilation.
  */
-void gen_func_end();
+void gen_cond_not_nil(context_s *ctx);
 
 /**
- * @brief Generates a conditional jump to else label if the content of GF@%tmp1 is a boolean@false.
+ * @brief Generates a conditional jump to else label if the condition on the data stack does not
+ * hold.
+ *
+ * @param[in,out] ctx Context of the compilation.
  *
  * @return The label_number to be used for other generate calls.
  */
-unsigned gen_jump_else(void);
+unsigned gen_jump_else(context_s *ctx);
 
 /**
  * @brief Generate label for the else branch of an if-else statement. Also generates unconditional
  * jump to end of the if-else for the end of the if branch.
  *
+ * @param[in,out] ctx Context of the compilation.
  * @param[in] label_number The label_number returned by gen_jump_else call in the same if-else
  * statement.
  */
-void gen_else_label(unsigned label_number);
+void gen_else_label(context_s *ctx, unsigned label_number);
 
 /**
  * @brief Generates the label for the end of the if-else-statement for the if branch to jump after
  * finishing.
  *
+ * @param[in,out] ctx Context of the compilation.
  * @param label_number The label_number returned by gen_jump_else call in the same if-else
  * statement.
  */
-void gen_if_end(unsigned label_number);
+void gen_if_end(context_s *ctx, unsigned label_number);
 
 /**
  * @brief Generates the label for beginning for a while loop to jump after each iteration.
  * Condition follows this label.
  *
+ * @param[in,out] ctx Context of the compilation.
+ *
  * @return The label_number to be used for other generate calls.
  */
-unsigned gen_while_label(void);
+unsigned gen_while_label(context_s *ctx);
 
 /**
- * @brief Generates a conditional jump to the end of the while statement.
+ * @brief Generates a conditional jump to the end of the while statement if the condition on the
+ * data stack does not hold.
  *
+ * @param[in,out] ctx Context of the compilation.
  * @param[in] label_number The label_number returned by gen_while_label call in the same while
  * statement.
  */
-void gen_while_jump_end(unsigned label_number);
+void gen_while_jump_end(context_s *ctx, unsigned label_number);
 
 /**
  * @brief Generates label to jump after the end of the while statement.
  *
+ * @param[in,out] ctx Context of the compilation.
  * @param[in] label_number The label_number returned by gen_while_label call in the same while
  * statement.
  */
-void gen_while_end_label(unsigned label_number);
+void gen_while_end_label(context_s *ctx, unsigned label_number);
 
 /**
  * @brief Jumps to the beggining lable of while
  *
+ * @param[in,out] ctx Context of the compilation.
  * @param[in] label_number The label_number returned by gen_while_label call in the same while
  * statement.
  */
-void gen_while_jump_loop(unsigned label_number);
-
-/**
- * @brief Generate code for a single operand in expression.
- *
- * @param[in] token The operand to generate.
- */
-void gen_expr_operand(T_token *token);
+void gen_while_jump_loop(context_s *ctx, unsigned label_number);
 
 /**
- * @brief Generate code for a single operator application in expression.
+ * @brief Generate code for a whole expression. The value of the expression is left on the data
+ * stack. Values already computed in the same basic block are pushed from the variable or the
+ * temporary that keeps them.
  *
- * @param[in] token The operator to generate.
+ * @param[in,out] ctx Context of the compilation. The arena is used for the order of the nodes.
+ * @param[in] tree The tree of the expression, checked by the semantic analysis already.
  */
-void gen_expr_operator(T_token *token);
+void gen_expr(context_s *ctx, const expr_tree_s *tree);
 
 /**
  * @brief Generates code to prepare expression result in GF@%tmp1.
+ *
+ * @param[in,out] ctx Context of the compilation.
  */
-void gen_expr_cond(void);
+void gen_expr_cond(context_s *ctx);
 
 /**
  * @brief Generates variadic write macro.
  *
+ * @param[in,out] ctx Context of the compilation.
  * @param[in] in_params Stack of paramters to print.
  */
-void gen_write(tstack_s *in_params);
+void gen_write(context_s *ctx, tstack_s *in_params);
 
 /**
  * @brief Add a function call to generate.
  *
- * @param function Pointer to the function token in global frame.
+ * @param[in,out] ctx Context of the compilation.
+ * @param function Pointer to the record of the function in global frame.
  * @param params_in The input parameters of the function. Will be freed.
  */
-void gen_call_insert(T_token *function, tstack_s *params_in);
+void gen_call_insert(context_s *ctx, symbol_s *function, tstack_s *params_in);
 
 /**
  * @brief Generates code for function call.
  *
- * @param fun_symbol Function symbol token.
+ * @param[in,out] ctx Context of the compilation.
+ * @param fun_symbol Record of the function in global frame.
  * @param in_params Parameters of the function.
  */
-void gen_func_call(T_token *fun_symbol, tstack_s *in_params);
+void gen_func_call(context_s *ctx, symbol_s *fun_symbol, tstack_s *in_params);
 
 /**
  * @brief Generate all collected functions calls throughout the program.
+ *
+ * @param[in,out] ctx Context of the compilation.
  */
-void gen_function_call_list(void);
+void gen_function_call_list(context_s *ctx);
 
 /**
  * @brief Generates code for local variable definitions.
  *
+ * @param[in,out] ctx Context of the compilation.
+ * @param[in] id Token containing the variable's name.
+ */
+void gen_var_decl(context_s *ctx, T_token *id);
+
+/**
+ * @brief Generates code to assign the value on the top of the data stack to a variable.
+ *
+ * @param[in,out] ctx Context of the compilation.
+ * @param[in] id Token containing the variable's name.
+ * @param[in] bind The value is the last generated expression, later expressions may reuse it from
+ * the variable.
+ */
+void gen_assign(context_s *ctx, const T_token *id, bool bind);
+
+/**
+ * @brief Generates code to assign a return value of the last called function to a variable.
+ *
+ * @param[in,out] ctx Context of the compilation.
  * @param[in] id Token containing the variable's name.
+ * @param[in] index Index of the return value.
+ * @param[in] convert Convert the integer return value to a number.
  */
-void gen_var_decl(T_token *id);
+void gen_assign_result(context_s *ctx, const T_token *id, unsigned index, bool convert);
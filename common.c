@@ -19,37 +19,53 @@ char *my_strdup(const char *str)
         return NULL;
     }
     strcpy(new, str);
-    new[len + 1] = '\0';
     return new;
 }
 
+unsigned hash_name(const char *name, unsigned length)
+{
+    unsigned hash = 2166136261u;
+
+    for (unsigned i = 0; i < length; i++) {
+        hash = (hash ^ (unsigned char)name[i]) * 16777619u;
+    }
+    return hash;
+}
+
 void ds_init(dynamic_string_s *dynamic_string)
 {
-    dynamic_string->limit = 32;
-    dynamic_string->content = calloc(dynamic_string->limit, sizeof(char));
-    ALLOC_CHECK(dynamic_string->content);
+    dynamic_string->limit = DS_INLINE_SIZE;
+    dynamic_string->content = dynamic_string->buffer;
+    dynamic_string->content[0] = '\0';
     dynamic_string->size = 0;
 }
 
 rc_e ds_add_char(dynamic_string_s *dynamic_string, const char c)
 {
-    /* Realloc line if not enough */
-    if (dynamic_string->limit == dynamic_string->size) {
-        dynamic_string->limit = 2 * dynamic_string->limit;
-        dynamic_string->content = realloc(dynamic_string->content, dynamic_string->limit);
-        ALLOC_CHECK(dynamic_string->content);
-    }
-
-    /* Duplicate string and place the duplicate in the structure */
+    return ds_append(dynamic_string, &c, 1);
+}
 
-    dynamic_string->content[dynamic_string->size++] = c;
+rc_e ds_append(dynamic_string_s *dynamic_string, const char *str, unsigned length)
+{
+    /* Grow if the characters and the null byte do not fit */
+    if (dynamic_string->size + length >= dynamic_string->limit) {
+        unsigned limit = MAX(2 * dynamic_string->limit, dynamic_string->size + length + 1);
 
-    // Add null byte at the end
-    if (c != '\0') {
-        ds_add_char(dynamic_string, '\0');
-        dynamic_string->size--;
+        if (dynamic_string->content == dynamic_string->buffer) {
+            dynamic_string->content = malloc(limit);
+            ALLOC_CHECK(dynamic_string->content);
+            memcpy(dynamic_string->content, dynamic_string->buffer, dynamic_string->size);
+        } else {
+            dynamic_string->content = realloc(dynamic_string->content, limit);
+            ALLOC_CHECK(dynamic_string->content);
+        }
+        dynamic_string->limit = limit;
     }
 
+    memcpy(dynamic_string->content + dynamic_string->size, str, length);
+    dynamic_string->size += length;
+    dynamic_string->content[dynamic_string->size] = '\0';
+
     return RC_OK;
 }
 
@@ -58,7 +74,10 @@ void ds_destroy(dynamic_string_s *dynamic_string)
     if (!dynamic_string) {
         return;
     }
-    FREE(dynamic_string->content);
+    if (dynamic_string->content != dynamic_string->buffer) {
+        free(dynamic_string->content);
+    }
+    dynamic_string->content = NULL;
     dynamic_string->limit = 0;
     dynamic_string->size = 0;
 }
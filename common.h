@@ -8,14 +8,21 @@
 #ifndef _COMMON_H_
 #define _COMMON_H_
 
+/**
+ * @brief Capacity of the buffer inside dynamic_string_s used for short strings.
+ */
+#define DS_INLINE_SIZE 24
+
 /**
  * @brief Structure for storing a string of
- * (possibly) infinite length
+ * (possibly) infinite length. Short strings are stored in the structure itself, so it must not be
+ * copied by value.
  */
 typedef struct dynamic_string {
-    char *content;
+    char *content; /* Either the inline buffer or a heap allocation */
     unsigned size;
     unsigned limit;
+    char buffer[DS_INLINE_SIZE];
 } dynamic_string_s;
 
 /**
@@ -83,6 +90,11 @@ typedef void (*destructor)(void *);
  */
 #define MAX(a, b) (a > b ? a : b)
 
+/**
+ * @brief A macro for getting minimum of two numbers.
+ */
+#define MIN(a, b) (a < b ? a : b)
+
 /**
  * @brief A macro for getting absolute value of a number.
  */
@@ -102,6 +114,16 @@ typedef void (*destructor)(void *);
  */
 char *my_strdup(const char *str);
 
+/**
+ * @brief FNV-1a hash of a name.
+ *
+ * @param[in] name The name, need not be null terminated.
+ * @param[in] length Length of the name.
+ *
+ * @return The hash.
+ */
+unsigned hash_name(const char *name, unsigned length);
+
 /**
  * @brief Initialize the dynamic_string structure.
  *
@@ -119,6 +141,17 @@ void ds_init(dynamic_string_s *dynamic_string);
  */
 rc_e ds_add_char(dynamic_string_s *dynamic_string, const char c);
 
+/**
+ * @brief Add characters to the end of dynamic string. The capacity grows geometrically.
+ *
+ * @param[in,out] dynamic_string Dynamic string structure where the characters will be stored.
+ * @param[in] str Characters to add, need not be null terminated.
+ * @param[in] length Number of characters to add.
+ *
+ * @return RC_OK on success.
+ */
+rc_e ds_append(dynamic_string_s *dynamic_string, const char *str, unsigned length);
+
 /**
  * @brief Destructor for the dynamic_string structure.
  *
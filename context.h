@@ -0,0 +1,96 @@
+/**
+ * @file context.h
+ * Projekt: Implementace prekladace imperativniho jazyka IFJ21.
+ * @author Tadeas Vintrlik <xvintr04@stud.fit.vutbr.cz>
+ * @brief State of a single compilation shared by all parts of the compiler.
+ */
+
+#ifndef _CONTEXT_H_
+#define _CONTEXT_H_
+
+#include <setjmp.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "arena.h"
+#include "common.h"
+#include "exp_values.h"
+#include "intern.h"
+#include "sll.h"
+#include "symtable.h"
+#include "token_stack.h"
+
+/**
+ * @brief Maximum number of tokens read ahead or returned to the scanner at once.
+ */
+#define LOOKAHEAD_SIZE 8
+
+/**
+ * @brief Structure holding the entire source file the scanner reads from.
+ */
+typedef struct source_buffer {
+    char *content;
+    size_t size;
+    bool mapped; /* Whether content was mmap-ed or read into a heap buffer */
+} source_buffer_s;
+
+/**
+ * @brief Tokens of the entire source lexed up front, stored as parallel arrays indexed by the
+ * position of the token in the source.
+ */
+typedef struct token_stream {
+    uint8_t *types;
+    uint8_t *keywords;
+    token_handle_u *handles;
+    int32_t *lines;
+    unsigned count;
+    unsigned capacity;
+    unsigned next; /* Index of the next token to read */
+    bool active; /* Whether the scanner reads tokens from the stream instead of the source */
+    bool lex_error; /* Whether lexing stopped on a lexical error after the last token */
+} token_stream_s;
+
+/**
+ * @brief What the condition of an if or a while statement left on the data stack.
+ */
+typedef enum cond {
+    COND_TRUE, /* A boolean, the condition holds if it is true */
+    COND_FALSE, /* A boolean, the condition holds if it is false */
+    COND_EQUAL, /* Two operands, the condition holds if they are equal */
+    COND_NOT_EQUAL, /* Two operands, the condition holds if they differ */
+} cond_e;
+
+/**
+ * @brief Everything one compilation works with. Compilations using different contexts are
+ * independent of each other and can run in parallel.
+ */
+typedef struct context {
+    /* Scanner */
+    source_buffer_s source;
+    const char *cursor; /* Next character to read */
+    const char *source_end;
+    int line; /* Line the scanner is on */
+    T_token *lookahead[LOOKAHEAD_SIZE]; /* Ring buffer of peeked and returned tokens */
+    unsigned lookahead_first; /* Index of the next token in the ring buffer */
+    unsigned lookahead_count;
+    jmp_buf *lex_error; /* Where to jump on a lexical error. If NULL the process exits */
+    token_stream_s stream;
+    intern_s names; /* Names of all identifiers */
+    arena_s literals; /* Values of all literals */
+    token_pool_s tokens;
+
+    /* Parser */
+    rc_e rc; /* Return code to use if parsing fails */
+    symtable_s symtable;
+    arena_s arena; /* Region of the objects that live at most until the end of start_parsing */
+
+    /* Code generator */
+    FILE *out; /* Where to write the generated code */
+    unsigned counter; /* Counter for unique labels */
+    expr_values_s values; /* Values available in the current basic block */
+    bool condition; /* The next expression is a condition */
+    uint8_t cond; /* cond_e of the last condition */
+    sll_s call_list; /* Calls in the main body, generated at the end */
+} context_s;
+
+#endif /* _CONTEXT_H_ */
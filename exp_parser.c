@@ -9,13 +9,16 @@
 #include "exp_parser.h"
 #include "token_stack.h"
 
-#define TABLE_ELEM 10
+/**
+ * @brief Number of items of the stack of an expression kept on the C stack. Deeper expressions
+ * continue in the arena of the compilation.
+ */
+#define EXP_STACK_SIZE 64
 
 /**
- * @brief Enumeration of different values found inside the precendece table.
+ * @brief Terminals of the precedence table, used directly as its indices.
  */
 typedef enum op {
-    /* Table heading */
     LEN,
     MULT_DIV,
     ADD_SUB,
@@ -25,30 +28,55 @@ typedef enum op {
     RPAR,
     ID,
     DOLLAR,
-    /* Actions inside the table */
+    OP_COUNT
+} op_e;
+
+/**
+ * @brief Actions inside the precedence table.
+ */
+typedef enum action {
     PUSH, /* < */
     RULE, /* > */
     SPEC, /* = */
     ERR, /* x */
-    NONE /* Empty table slot */
-} op_e;
+} action_e;
 
 /**
- * @brief Precedence table.
+ * @brief Precedence table. Rows are the top-most terminal of the stack, columns the input, both in
+ * the order of op_e.
  */
-op_e table[TABLE_ELEM][TABLE_ELEM] = {
-    { NONE, LEN, MULT_DIV, ADD_SUB, CONCAT, REL, LPAR, RPAR, ID, DOLLAR },
-    { LEN, RULE, RULE, RULE, RULE, RULE, PUSH, RULE, PUSH, RULE },
-    { MULT_DIV, PUSH, RULE, RULE, RULE, RULE, PUSH, RULE, PUSH, RULE },
-    { ADD_SUB, PUSH, PUSH, RULE, RULE, RULE, PUSH, RULE, PUSH, RULE },
-    { CONCAT, PUSH, PUSH, PUSH, PUSH, RULE, PUSH, RULE, PUSH, RULE },
-    { REL, PUSH, PUSH, PUSH, PUSH, ERR, PUSH, RULE, PUSH, RULE },
-    { LPAR, PUSH, PUSH, PUSH, PUSH, PUSH, PUSH, SPEC, PUSH, ERR },
-    { RPAR, ERR, RULE, RULE, RULE, RULE, ERR, RULE, ERR, RULE },
-    { ID, ERR, RULE, RULE, RULE, RULE, PUSH, RULE, ERR, RULE },
-    { DOLLAR, PUSH, PUSH, PUSH, PUSH, PUSH, PUSH, ERR, PUSH, ERR },
+static const uint8_t table[OP_COUNT][OP_COUNT] = {
+    { RULE, RULE, RULE, RULE, RULE, PUSH, RULE, PUSH, RULE },
+    { PUSH, RULE, RULE, RULE, RULE, PUSH, RULE, PUSH, RULE },
+    { PUSH, PUSH, RULE, RULE, RULE, PUSH, RULE, PUSH, RULE },
+    { PUSH, PUSH, PUSH, PUSH, RULE, PUSH, RULE, PUSH, RULE },
+    { PUSH, PUSH, PUSH, PUSH, ERR, PUSH, RULE, PUSH, RULE },
+    { PUSH, PUSH, PUSH, PUSH, PUSH, PUSH, SPEC, PUSH, ERR },
+    { ERR, RULE, RULE, RULE, RULE, ERR, RULE, ERR, RULE },
+    { ERR, RULE, RULE, RULE, RULE, PUSH, RULE, ERR, RULE },
+    { PUSH, PUSH, PUSH, PUSH, PUSH, PUSH, ERR, PUSH, ERR },
 };
 
+/**
+ * @brief Item of the stack of the precedence analysis. Terminals are the tokens from the input,
+ * non-terminals the trees of the subexpressions reduced so far.
+ */
+typedef struct exp_item {
+    T_token *token; /* Terminal, NULL for a non-terminal */
+    expr_node_s *node; /* Tree of a non-terminal */
+    bool handle; /* A handle starts at this item */
+} exp_item_s;
+
+/**
+ * @brief Stack of the precedence analysis. Starts in an array of the caller, grows in the arena.
+ */
+typedef struct exp_stack {
+    exp_item_s *items;
+    unsigned count;
+    unsigned capacity;
+    arena_s *arena; /* Where the items continue when the initial array is full */
+} exp_stack_s;
+
 /**
  * @brief Returns op_e value of  token op_e searchable in the precedence table.
  *
@@ -116,82 +144,137 @@ static op_e token2op(const T_token *token)
 }
 
 /**
- * @brief Create a non-terminal token.
- *
- * @param[in] type The type of the non-terminal.
- * @param[in] line The line where the terminal from which this was created was found.
+ * @brief Push an item on the stack.
  *
- * @return Newly allocated non-terminal token.
+ * @param[in,out] stack The stack.
+ * @param[in] item The item to push.
  */
-static T_token *create_non_terminal(symbol_type_e type, unsigned line)
+static void exp_push(exp_stack_s *stack, exp_item_s item)
 {
-    T_token *expr = malloc(sizeof *expr);
-    ALLOC_CHECK(expr);
+    if (stack->count == stack->capacity) {
+        exp_item_s *items = arena_alloc(stack->arena, 2 * stack->capacity * sizeof *items);
+        memcpy(items, stack->items, stack->count * sizeof *items);
+        stack->items = items;
+        stack->capacity *= 2;
+    }
+    stack->items[stack->count++] = item;
+}
 
-    token_init(expr);
+/**
+ * @brief Create a node of the expression tree and push it on the stack as a non-terminal.
+ *
+ * @param[in,out] stack The stack. Its arena is used for the node.
+ * @param[in,out] tree The tree the node belongs to.
+ * @param[in] token The operand or the operator to copy into the node.
+ * @param[in] type The type of the value of the node.
+ * @param[in] left Left operand. NULL for an operand.
+ * @param[in] right Right operand. NULL for an operand or an unary operator.
+ *
+ * @return The new node.
+ */
+static expr_node_s *exp_push_node(exp_stack_s *stack, expr_tree_s *tree, const T_token *token,
+    symbol_type_e type, expr_node_s *left, expr_node_s *right)
+{
+    exp_item_s item = { NULL, arena_alloc(stack->arena, sizeof(expr_node_s)), false };
+
+    item.node->token = *token;
+    item.node->left = left;
+    item.node->right = right;
+    item.node->value = NULL;
+    item.node->type = type;
+    item.node->to_number = false;
+    item.node->reuse = false;
+    tree->size++;
+    exp_push(stack, item);
+    return item.node;
+}
 
-    expr->type = TOKEN_NON_TERMINAL;
-    expr->symbol_type = type;
-    expr->line = line;
-    return expr;
+/**
+ * @brief Get the line of a subexpression, the line of its right-most operand.
+ *
+ * @param[in] node Root of the subexpression.
+ *
+ * @return The line.
+ */
+static int expr_line(const expr_node_s *node)
+{
+    while (node->left) {
+        node = node->right ? node->right : node->left;
+    }
+    return node->token.line;
 }
 
 /**
- * @brief Get the right value from the precendece table.
+ * @brief Find the top-most terminal. A non-terminal is only ever reduced right above a terminal
+ * or the bottom of the stack, so at most one item is skipped.
  *
- * @param[in] in Terminal from input. Used as a key for columns.
- * @param[in] stack Terminal found on top of stack. Used as a key for rows.
+ * @param[in] stack The stack.
  *
- * @return Action found in the table. NONE if @p in or @p stack was not found as a key.
+ * @return Index of the terminal. -1 if there is none.
  */
-op_e table_get_action(op_e in, tstack_s *stack)
+static int exp_terminal_top(const exp_stack_s *stack)
 {
-    op_e ret = NONE, op_top;
-    int row = -1, col = -1;
+    int i = stack->count - 1;
 
-    /* First find they key in columns */
-    for (unsigned i = 0; i < TABLE_ELEM; i++) {
-        if (table[0][i] == in) {
-            col = i;
-        }
+    if (i >= 0 && !stack->items[i].token) {
+        i--;
     }
+    assert(i < 0 || stack->items[i].token);
+    return i;
+}
 
-    /* Then find the key in rows */
-    op_top = token2op(tstack_terminal_top(stack));
-    for (unsigned i = 0; i < TABLE_ELEM; i++) {
-        if (table[i][0] == op_top) {
-            row = i;
-        }
-    }
+/**
+ * @brief Push a terminal with handle. The handle starts right above the top-most terminal.
+ *
+ * @param[in,out] stack The stack.
+ * @param[in] token The terminal.
+ */
+static void exp_terminal_push(exp_stack_s *stack, T_token *token)
+{
+    unsigned position = exp_terminal_top(stack) + 1;
+    exp_item_s item = { token, NULL, position == stack->count };
 
-    if (row != -1 && col != -1) {
-        ret = table[row][col];
+    if (position < stack->count) {
+        stack->items[position].handle = true;
     }
+    exp_push(stack, item);
+}
 
-    return ret;
+/**
+ * @brief Get the action from the precedence table.
+ *
+ * @param[in] in Terminal from input. Used as a key for columns.
+ * @param[in] stack Stack whose top-most terminal is used as a key for rows.
+ *
+ * @return Action found in the table.
+ */
+static action_e table_get_action(op_e in, const exp_stack_s *stack)
+{
+    int top = exp_terminal_top(stack);
+
+    return table[top < 0 ? DOLLAR : token2op(stack->items[top].token)][in];
 }
 
 /**
  * @brief Convert terminal to expression.
  *
- * @param[out] tstack Stack into which to insert the new expression.
- * @param[in] help Temporary stack to reduce using rules.
+ * @param[out] stack Stack into which to insert the new expression.
+ * @param[in,out] tree The tree of the expression.
+ * @param[in] rule Items of the rule, removed from the stack already.
+ * @param[in] count Number of items of the rule.
  */
-static bool term2expr(tstack_s *tstack, tstack_s *help)
+static bool term2expr(exp_stack_s *stack, expr_tree_s *tree, const exp_item_s *rule, unsigned count)
 {
-    T_token *non_terminal, *terminal = tstack_top(help);
-    tstack_pop(help, false);
+    T_token *terminal = rule[0].token;
+    symbol_type_e type = terminal->symbol_type;
 
-    if (!tstack_empty(help)) {
-        tstack_destroy(help);
+    if (count != 1) {
         return false;
     }
-    gen_expr_operand(terminal);
-    non_terminal = create_non_terminal(terminal->symbol_type, terminal->line);
-    if (!strcmp(terminal->value->content, "nil")) {
-        non_terminal->symbol_type = SYM_TYPE_NIL;
+    if (terminal->type == TOKEN_KEYWORD && terminal->keyword == NIL) {
+        type = SYM_TYPE_NIL;
     }
-    tstack_push(tstack, non_terminal);
+    exp_push_node(stack, tree, terminal, type, NULL, NULL);
     token_destroy(terminal);
     return true;
 }
@@ -199,36 +282,27 @@ static bool term2expr(tstack_s *tstack, tstack_s *help)
 /**
  * @brief Reduce non-terminal expression into atomic expression.
  *
- * @param[out] tstack Stack into which to insert the new expression.
- * @param[in] help Temporary stack to reduce using rules.
- * @param[out] rc Return code to set.
+ * @param[in,out] ctx Context of the compilation.
+ * @param[out] stack Stack into which to insert the new expression.
+ * @param[in,out] tree The tree of the expression.
+ * @param[in] rule Items of the rule, removed from the stack already.
+ * @param[in] count Number of items of the rule.
  */
-static bool nonterm2expr(tstack_s *tstack, tstack_s *help, rc_e *rc)
+static bool nonterm2expr(
+    context_s *ctx, exp_stack_s *stack, expr_tree_s *tree, const exp_item_s *rule, unsigned count)
 {
-    T_token *first, *second, *third;
-    (void)first;
-
-    /* Pop all three expected tokens */
-    first = tstack_top(help);
-    tstack_pop(help, false);
-    second = tstack_top(help);
-    tstack_pop(help, false);
-    third = tstack_top(help);
-    tstack_pop(help, false);
-
-    /* First was already checked in caller */
-    if (!second || !third) {
-        return false;
-    }
-    if (third->type != TOKEN_NON_TERMINAL) {
-        return false;
-    }
-    if (!tstack_empty(help)) {
+    T_token *op_token = rule[1].token;
+    expr_node_s *left = rule[0].node, *right = rule[2].node, *node;
+    bool left_to_number, right_to_number;
+    symbol_type_e type;
+
+    /* First was already checked in caller */
+    if (count != 3 || !op_token || rule[2].token) {
         return false;
     }
 
-    switch (second->type) {
-    /* Just need to check if valid operator */
+    switch (op_token->type) {
+    /* Just need to check if valid operator */
     case TOKEN_MUL:
     case TOKEN_DIVISION:
     case TOKEN_FLOOR_DIVISION:
@@ -241,117 +315,105 @@ static bool nonterm2expr(tstack_s *tstack, tstack_s *help, rc_e *rc)
     case TOKEN_GREATER_EQUAL_THAN:
     case TOKEN_EQUAL:
     case TOKEN_NOT_EQUAL_TO:
-        if (!sem_check_expr_type(first, second, third, rc)) {
+        type = right->type;
+        if (!sem_check_expr_type(
+                left->type, op_token, &type, &left_to_number, &right_to_number, &ctx->rc)) {
             return false;
         }
-        gen_expr_operator(second);
-        token_destroy(second);
         break;
 
     default:
-        token_destroy(second);
+        token_destroy(op_token);
         return false;
     }
 
-    token_destroy(first);
-    tstack_push(tstack, third); /* Push back one reduced expression */
-
+    /* Push back one reduced expression, literal operands are computed right away */
+    left->to_number = left_to_number;
+    right->to_number = right_to_number;
+    node = exp_push_node(stack, tree, op_token, type, left, right);
+    if (!expr_fold(node, &ctx->literals)) {
+        expr_simplify(node);
+    }
+    token_destroy(op_token);
     return true;
 }
 
 /**
- * @brief Choose an expression rule to apply and modify the stack.
+ * @brief Choose an expression rule to apply and modify the stack. The items from the top-most
+ * handle up form the rule, they are taken off the stack before it is applied.
  *
- * @param[in,out] tstack Stack of tokens of expression to reduce using rules.
- * @param[out] rc Return code to set in case of an error.
+ * @param[in,out] ctx Context of the compilation.
+ * @param[in,out] stack Stack of the expression to reduce using rules.
+ * @param[in,out] tree The tree of the expression.
  */
-static bool apply_rule(tstack_s *tstack, rc_e *rc)
+static bool apply_rule(context_s *ctx, exp_stack_s *stack, expr_tree_s *tree)
 {
-    tstack_s help;
-    T_token *tmp, *expr, *returnable;
-
-    tstack_init(&help);
+    exp_item_s *rule;
+    unsigned handle, count;
 
-    /* Get tokens until handle */
-    while (!tstack_empty(tstack)) {
-        tmp = tstack_top(tstack);
-
-        tstack_pop(tstack, false);
-        tstack_push(&help, tmp);
-        if (tmp->type == TOKEN_HANDLE) {
-            break;
-        }
-    }
-    tmp = tstack_top(&help);
+    /* Find the handle */
+    for (handle = stack->count; handle > 0 && !stack->items[handle - 1].handle; handle--)
+        ;
 
-    /* If there were no tokens or no handle - syntax error */
-    if (!tmp) {
+    /* If there were no tokens or no handle - syntax error */
+    if (!stack->count) {
         return false;
     }
-    if (tmp->type != TOKEN_HANDLE) {
-        /* Return it in case it was just one non-terminal */
-        tstack_push(tstack, tmp);
+    if (!handle) {
+        /* Keep only the bottom item in case it was just one non-terminal */
+        stack->count = 1;
         return false;
     }
-    tstack_pop(&help, false); /* Remove the explicit handle */
-    tmp = tstack_top(&help);
+    handle--;
+    rule = &stack->items[handle];
+    count = stack->count - handle;
+    stack->count = handle;
+
+    /* A non-terminal, choose the rule by the operator after it */
+    if (!rule[0].token) {
+        return nonterm2expr(ctx, stack, tree, rule, count);
+    }
 
     /* Choose the rule according to left-most token */
-    switch (tmp->type) {
+    switch (rule[0].token->type) {
     case TOKEN_STRING_LENGTH:
-        gen_expr_operator(tmp);
-        tstack_pop(&help, false);
-        tmp = tstack_top(&help);
-        if (tmp->type != TOKEN_NON_TERMINAL) {
+        if (count < 2 || rule[1].token) {
             return false;
         }
-        tstack_pop(&help, false);
-        if (!sem_check_string_length(tmp, rc)) {
+        if (!sem_check_string_length(rule[1].node->type, expr_line(rule[1].node), &ctx->rc)) {
             return false;
         }
-        tmp->symbol_type = SYM_TYPE_INT;
-        tstack_push(tstack, tmp);
+        expr_fold(exp_push_node(stack, tree, rule[0].token, SYM_TYPE_INT, rule[1].node, NULL),
+            &ctx->literals);
+        token_destroy(rule[0].token);
         break;
     case TOKEN_LEFT_BRACKET:
-        returnable = tmp;
-        tstack_pop(&help, false);
-        tmp = tstack_top(&help);
-        if (tmp->type != TOKEN_NON_TERMINAL) {
+        if (count < 2 || rule[1].token) {
             return false;
         }
-        expr = tmp; /* Store the inside expression to put as result */
-        tstack_pop(&help, false);
-        tmp = tstack_top(&help);
-        if (!tmp || tmp->type != TOKEN_RIGHT_BRACKET) {
-            tstack_push(tstack, returnable);
-            tstack_push(tstack, expr);
+        if (count < 3 || !rule[2].token || rule[2].token->type != TOKEN_RIGHT_BRACKET) {
+            /* Return the bracket and the inside expression */
+            rule[0].handle = false;
+            stack->count += 2;
             return false;
         }
-        tstack_pop(&help, false);
-        tstack_push(tstack, expr);
+        token_destroy(rule[0].token);
+        token_destroy(rule[2].token);
+        /* The brackets only group, the inside expression stays the same */
+        rule[1].handle = false;
+        exp_push(stack, rule[1]);
         break;
     case TOKEN_KEYWORD:
-        /* Nil is the only valid keyword in expression */
-        if (strcmp(tmp->value->content, "nil")) {
+        /* Nil is the only valid keyword in expression */
+        if (rule[0].token->keyword != NIL) {
             return false;
         }
-        if (!term2expr(tstack, &help)) {
-            return false;
-        }
-        break;
+        return term2expr(stack, tree, rule, count);
     case TOKEN_ID:
     case TOKEN_NUMBER:
     case TOKEN_INT:
     case TOKEN_STRING:
-        if (!term2expr(tstack, &help)) {
-            return false;
-        }
-        break;
-    case TOKEN_NON_TERMINAL:
-        if (!nonterm2expr(tstack, &help, rc)) {
-            return false;
-        }
-        break;
+        return term2expr(stack, tree, rule, count);
 
     default:
         return false;
@@ -359,40 +421,52 @@ static bool apply_rule(tstack_s *tstack, rc_e *rc)
     return true;
 }
 
-bool exp_parse(symtable_s *symtable, rc_e *rc, symbol_type_e *type)
+/**
+ * @brief Parse an expression using the precedence table. The stack starts in a fixed array, so
+ * usual expressions allocate nothing.
+ *
+ * @param[in,out] ctx Context of the compilation.
+ * @param[out] type The type of the parsed expression. If NULL it is not stored.
+ *
+ * @return True if the expression is valid.
+ */
+static bool parse_expression(context_s *ctx, symbol_type_e *type)
 {
+    exp_item_s initial[EXP_STACK_SIZE];
+    exp_stack_s stack = { initial, 0, EXP_STACK_SIZE, &ctx->arena };
+    expr_tree_s tree = { NULL, 0 };
     T_token *token, *out;
-    op_e op, action;
-    tstack_s tstack;
-    tstack_init(&tstack);
+    exp_item_s *result;
+    action_e action;
     bool end = false;
 
     while (!end) {
-        token = get_next_token();
-        op = token2op(token);
-        action = table_get_action(op, &tstack);
+        token = get_next_token(ctx);
+        action = table_get_action(token2op(token), &stack);
         if (action != ERR && token->type == TOKEN_ID) {
-            /* If an identifier and part of the expression */
-            if (!sem_check_id_decl(token, symtable, &out, rc)) {
+            /* If an identifier and part of the expression */
+            if (!sem_check_id_decl(token, &ctx->symtable, &out, &ctx->rc)) {
                 return false;
             }
-            /* Pass the type of the variable to local token for semantic checks */
+            /* Pass the type of the variable to local token for semantic checks */
             token->symbol_type = out->symbol_type;
         }
         switch (action) {
         case RULE:
-            if (!apply_rule(&tstack, rc)) {
+            if (!apply_rule(ctx, &stack, &tree)) {
                 ERR_MSG("Invalid expression.", token->line);
                 return false;
             }
-            unget_token(token);
+            unget_token(ctx, token);
             break;
         case PUSH:
-            tstack_terminal_push(&tstack, token);
+            exp_terminal_push(&stack, token);
             break;
-        case SPEC:
-            tstack_push(&tstack, token);
+        case SPEC: {
+            exp_item_s item = { token, NULL, false };
+            exp_push(&stack, item);
             break;
+        }
         default:
             /* This is not necessarily an error, that is determined by the state of the stack */
             end = true;
@@ -401,47 +475,59 @@ bool exp_parse(symtable_s *symtable, rc_e *rc, symbol_type_e *type)
         }
     }
 
-    /* Try to reduce it to one non-terminal if possible */
-    while (apply_rule(&tstack, rc))
+    /* Try to reduce it to one non-terminal if possible */
+    while (apply_rule(ctx, &stack, &tree))
         ;
 
+    if (stack.count && stack.items[stack.count - 1].token
+        && stack.items[stack.count - 1].token->type == TOKEN_ID) {
+        /* We assume the identifier was not a part of the expression as it might be a function call
+         */
+        unget_token(ctx, stack.items[--stack.count].token);
+    }
+
     /* There should by only one non-terminal on stack */
-    out = tstack_top(&tstack);
-    if (!out) {
+    if (!stack.count) {
         ERR_MSG("Expected a non-empty expression.\n", token->line);
         /* Very first token was invalid */
         return false;
     }
 
-    if (out->type == TOKEN_ID) {
-        /* We assume the identifier was not a part of the expression as it might be a function call
-         */
-        unget_token(out);
-        tstack_pop(&tstack, false);
-        out = tstack_top(&tstack);
-    }
-
-    if (out->type != TOKEN_NON_TERMINAL) {
+    result = &stack.items[stack.count - 1];
+    if (result->token) {
         ERR_MSG("Could not parse the expression: ", token->line);
-        if (token->value && strlen(token->value->content)) {
-            fprintf(stderr, "%s", token->value->content);
+        const char *lexeme;
+        unsigned length = token_lexeme(token, &lexeme);
+        if (length) {
+            fprintf(stderr, "%.*s", (int)length, lexeme);
         } else {
             err_token_printer(token->type);
         }
         fprintf(stderr, " unexpected.\n");
         return false;
     }
-    tstack_pop(&tstack, false);
-    if (!tstack_empty(&tstack)) {
-        ERR_MSG("Could not parse the entirety of the expression.\n", out->line);
+    if (stack.count != 1) {
+        ERR_MSG("Could not parse the entirety of the expression.\n", expr_line(result->node));
         return false;
     }
 
     if (type) {
-        *type = out->symbol_type;
+        *type = result->node->type;
     }
-    token_destroy(out);
-    tstack_destroy(&tstack);
-    unget_token(token); /* Return the last unparsed token to top-down parser */
+    unget_token(ctx, token); /* Return the last unparsed token to top-down parser */
+
+    /* The code is generated only once the whole expression is known to be valid */
+    tree.root = result->node;
+    gen_expr(ctx, &tree);
     return true;
 }
+
+bool exp_parse(context_s *ctx, symbol_type_e *type)
+{
+    arena_mark_s mark = arena_mark(&ctx->arena);
+    bool ret = parse_expression(ctx, type);
+
+    /* Items of deep expressions and the tree are no longer needed */
+    arena_release(&ctx->arena, mark);
+    return ret;
+}
@@ -0,0 +1,589 @@
+/**
+ * @file exp_tree.c
+ * Projekt: Implementace prekladace imperativniho jazyka IFJ21.
+ * @author Tadeas Vintrlik <xvintr04@stud.fit.vutbr.cz>
+ * @brief Implementation of the rewrites of expression trees.
+ */
+
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "exp_tree.h"
+
+/**
+ * @brief Size of the text of a folded numeric literal.
+ */
+#define FOLD_TEXT_SIZE 32
+
+static const token_literal_s false_literal = { "false", 5, "false", { 0 } };
+static const token_literal_s true_literal = { "true", 4, "true", { 1 } };
+
+/**
+ * @brief Check if a node is a literal operand.
+ *
+ * @param[in] node The node.
+ *
+ * @return True for integer, number, string and boolean literals and nil.
+ */
+static bool is_literal(const expr_node_s *node)
+{
+    if (node->left) {
+        return false;
+    }
+    switch (node->token.type) {
+    case TOKEN_INT:
+    case TOKEN_NUMBER:
+    case TOKEN_STRING:
+    case TOKEN_BOOL:
+        return true;
+    case TOKEN_KEYWORD:
+        return node->token.keyword == NIL;
+    default:
+        return false;
+    }
+}
+
+/**
+ * @brief Turn a node into a literal operand.
+ *
+ * @param[in,out] node The node. It keeps its line.
+ * @param[in] type Type of the literal token.
+ * @param[in] literal Value of the literal.
+ */
+static void set_literal(expr_node_s *node, token_type type, const token_literal_s *literal)
+{
+    node->token.type = type;
+    node->token.keyword = NO_KEYWORD;
+    node->token.handle.literal = literal;
+    node->left = NULL;
+    node->right = NULL;
+    switch (type) {
+    case TOKEN_INT:
+        node->type = SYM_TYPE_INT;
+        break;
+    case TOKEN_NUMBER:
+        node->type = SYM_TYPE_NUMBER;
+        break;
+    case TOKEN_STRING:
+        node->type = SYM_TYPE_STRING;
+        break;
+    default:
+        node->type = SYM_TYPE_BOOL;
+        break;
+    }
+    node->token.symbol_type = node->type;
+}
+
+/**
+ * @brief Create the value of a folded literal. The text is also used as its lexeme.
+ *
+ * @param[in,out] literals Arena for the value.
+ * @param[in] value Binary value of a numeric literal.
+ * @param[in] text Null terminated text of the value.
+ * @param[in] length Length of the text.
+ *
+ * @return The value.
+ */
+static const token_literal_s *new_literal(
+    arena_s *literals, literal_u value, const char *text, unsigned length)
+{
+    token_literal_s *literal = arena_alloc(literals, sizeof *literal);
+    char *copy = arena_alloc(literals, length + 1);
+
+    memcpy(copy, text, length + 1);
+    literal->lexeme = copy;
+    literal->length = length;
+    literal->text = copy;
+    literal->value = value;
+    return literal;
+}
+
+/**
+ * @brief Turn a node into an integer literal.
+ *
+ * @param[in,out] node The node.
+ * @param[in] integer The value.
+ * @param[in,out] literals Arena for the value.
+ */
+static void set_integer(expr_node_s *node, int64_t integer, arena_s *literals)
+{
+    char text[FOLD_TEXT_SIZE];
+    literal_u value;
+    int length = snprintf(text, sizeof text, "%" PRId64, integer);
+
+    value.integer = integer;
+    set_literal(node, TOKEN_INT, new_literal(literals, value, text, length));
+}
+
+/**
+ * @brief Turn a node into a number literal.
+ *
+ * @param[in,out] node The node.
+ * @param[in] number The value.
+ * @param[in,out] literals Arena for the value.
+ */
+static void set_number(expr_node_s *node, double number, arena_s *literals)
+{
+    char text[FOLD_TEXT_SIZE];
+    literal_u value;
+    int length = snprintf(text, sizeof text, "%.17g", number);
+
+    value.number = number;
+    set_literal(node, TOKEN_NUMBER, new_literal(literals, value, text, length));
+}
+
+/**
+ * @brief Turn a node into a boolean literal.
+ *
+ * @param[in,out] node The node.
+ * @param[in] value The value.
+ */
+static void set_bool(expr_node_s *node, bool value)
+{
+    set_literal(node, TOKEN_BOOL, value ? &true_literal : &false_literal);
+}
+
+/**
+ * @brief Read one character of a string in the IFJcode21 encoding.
+ *
+ * @param[in,out] text The string, moved after the character.
+ *
+ * @return The decoded character.
+ */
+static unsigned char decode_char(const char **text)
+{
+    const char *p = *text;
+
+    if (*p != '\\') {
+        (*text)++;
+        return *p;
+    }
+    *text += 4;
+    return (p[1] - '0') * 100 + (p[2] - '0') * 10 + (p[3] - '0');
+}
+
+/**
+ * @brief Get the number of characters of a string in the IFJcode21 encoding.
+ *
+ * @param[in] text The string.
+ *
+ * @return The length of the decoded string.
+ */
+static int64_t decoded_length(const char *text)
+{
+    int64_t length = 0;
+
+    while (*text) {
+        decode_char(&text);
+        length++;
+    }
+    return length;
+}
+
+/**
+ * @brief Compare two strings in the IFJcode21 encoding by their decoded characters.
+ *
+ * @param[in] first The first string.
+ * @param[in] second The second string.
+ *
+ * @return Negative, zero or positive as the first string is less, equal or greater.
+ */
+static int decoded_compare(const char *first, const char *second)
+{
+    unsigned char a, b;
+
+    while (*first && *second) {
+        a = decode_char(&first);
+        b = decode_char(&second);
+        if (a != b) {
+            return a < b ? -1 : 1;
+        }
+    }
+    return (*first != '\0') - (*second != '\0');
+}
+
+/**
+ * @brief Apply an integer operator if the result is exact and fits into 64 bits. The interpreter
+ * does not wrap around, so overflowing operations are left for the run time.
+ *
+ * @param[in] op The operator.
+ * @param[in] a The first operand.
+ * @param[in] b The second operand.
+ * @param[out] result The result.
+ *
+ * @return True if the operation was applied.
+ */
+static bool fold_integer(token_type op, int64_t a, int64_t b, int64_t *result)
+{
+    switch (op) {
+    case TOKEN_ADD:
+        if ((b > 0 && a > INT64_MAX - b) || (b < 0 && a < INT64_MIN - b)) {
+            return false;
+        }
+        *result = a + b;
+        return true;
+    case TOKEN_SUB:
+        if ((b < 0 && a > INT64_MAX + b) || (b > 0 && a < INT64_MIN + b)) {
+            return false;
+        }
+        *result = a - b;
+        return true;
+    case TOKEN_MUL:
+        if (a && b
+            && (a > 0 ? (b > 0 ? a > INT64_MAX / b : b < INT64_MIN / a)
+                      : (b > 0 ? a < INT64_MIN / b : b < INT64_MAX / a))) {
+            return false;
+        }
+        *result = a * b;
+        return true;
+    case TOKEN_FLOOR_DIVISION:
+        /* Division by zero is a run time error, rounding of negative quotients is left to IDIV */
+        if (a < 0 || b <= 0) {
+            return false;
+        }
+        *result = a / b;
+        return true;
+    default:
+        return false;
+    }
+}
+
+/**
+ * @brief Apply a number operator if the result is finite.
+ *
+ * @param[in] op The operator.
+ * @param[in] a The first operand.
+ * @param[in] b The second operand.
+ * @param[out] result The result.
+ *
+ * @return True if the operation was applied.
+ */
+static bool fold_number(token_type op, double a, double b, double *result)
+{
+    switch (op) {
+    case TOKEN_ADD:
+        *result = a + b;
+        break;
+    case TOKEN_SUB:
+        *result = a - b;
+        break;
+    case TOKEN_MUL:
+        *result = a * b;
+        break;
+    case TOKEN_DIVISION:
+        /* Division by zero is a run time error */
+        if (b == 0) {
+            return false;
+        }
+        *result = a / b;
+        break;
+    default:
+        return false;
+    }
+    return isfinite(*result);
+}
+
+/**
+ * @brief Compare two literals of the same type.
+ *
+ * @param[in] first The first literal.
+ * @param[in] second The second literal.
+ * @param[out] result Negative, zero or positive as the first literal is less, equal or greater.
+ *
+ * @return True if the literals could be compared.
+ */
+static bool compare_literals(const T_token *first, const T_token *second, int *result)
+{
+    if (first->type != second->type) {
+        return false;
+    }
+    switch (first->type) {
+    case TOKEN_INT:
+    case TOKEN_BOOL:
+        *result = (TOKEN_LITERAL(first).integer > TOKEN_LITERAL(second).integer)
+            - (TOKEN_LITERAL(first).integer < TOKEN_LITERAL(second).integer);
+        return true;
+    case TOKEN_NUMBER:
+        /* Not a number is not ordered, leave it to the interpreter */
+        if (isnan(TOKEN_LITERAL(first).number) || isnan(TOKEN_LITERAL(second).number)) {
+            return false;
+        }
+        *result = (TOKEN_LITERAL(first).number > TOKEN_LITERAL(second).number)
+            - (TOKEN_LITERAL(first).number < TOKEN_LITERAL(second).number);
+        return true;
+    case TOKEN_STRING:
+        *result = decoded_compare(token_value(first), token_value(second));
+        return true;
+    default:
+        return false;
+    }
+}
+
+/**
+ * @brief Fold a comparison of two literals.
+ *
+ * @param[in,out] node The comparison.
+ *
+ * @return True if it was folded.
+ */
+static bool fold_comparison(expr_node_s *node)
+{
+    const T_token *first = &node->left->token, *second = &node->right->token;
+    bool first_nil = first->type == TOKEN_KEYWORD, second_nil = second->type == TOKEN_KEYWORD;
+    int order;
+
+    /* Only the equality is defined for nil */
+    if (first_nil || second_nil) {
+        if (node->token.type != TOKEN_EQUAL && node->token.type != TOKEN_NOT_EQUAL_TO) {
+            return false;
+        }
+        set_bool(node, (first_nil == second_nil) == (node->token.type == TOKEN_EQUAL));
+        return true;
+    }
+
+    /* Operands of different types are an error of the interpreter */
+    if (!compare_literals(first, second, &order)) {
+        return false;
+    }
+    switch (node->token.type) {
+    case TOKEN_EQUAL:
+        set_bool(node, order == 0);
+        break;
+    case TOKEN_NOT_EQUAL_TO:
+        set_bool(node, order != 0);
+        break;
+    case TOKEN_LESS_THAN:
+        set_bool(node, order < 0);
+        break;
+    case TOKEN_LESS_EQUAL_THAN:
+        set_bool(node, order <= 0);
+        break;
+    case TOKEN_GREATER_THAN:
+        set_bool(node, order > 0);
+        break;
+    case TOKEN_GREATER_EQUAL_THAN:
+        set_bool(node, order >= 0);
+        break;
+    default:
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Fold a binary operator applied to two literals.
+ *
+ * @param[in,out] node The operator.
+ * @param[in,out] literals Arena for the values of new literals.
+ *
+ * @return True if it was folded.
+ */
+static bool fold_binary(expr_node_s *node, arena_s *literals)
+{
+    const T_token *first = &node->left->token, *second = &node->right->token;
+    const char *a, *b;
+    int64_t integer;
+    double number;
+    char *text;
+    size_t a_length, b_length;
+    literal_u value;
+
+    switch (node->token.type) {
+    case TOKEN_ADD:
+    case TOKEN_SUB:
+    case TOKEN_MUL:
+    case TOKEN_DIVISION:
+    case TOKEN_FLOOR_DIVISION:
+        if (first->type == TOKEN_INT && second->type == TOKEN_INT) {
+            if (!fold_integer(node->token.type, TOKEN_LITERAL(first).integer,
+                    TOKEN_LITERAL(second).integer, &integer)) {
+                return false;
+            }
+            set_integer(node, integer, literals);
+            return true;
+        }
+        if (first->type != TOKEN_NUMBER || second->type != TOKEN_NUMBER
+            || !fold_number(node->token.type, TOKEN_LITERAL(first).number,
+                TOKEN_LITERAL(second).number, &number)) {
+            return false;
+        }
+        set_number(node, number, literals);
+        return true;
+    case TOKEN_STRING_CONCAT:
+        if (first->type != TOKEN_STRING || second->type != TOKEN_STRING) {
+            return false;
+        }
+        /* The encoding of a character does not depend on its neighbours */
+        a = token_value(first);
+        b = token_value(second);
+        a_length = strlen(a);
+        b_length = strlen(b);
+        text = arena_alloc(literals, a_length + b_length + 1);
+        memcpy(text, a, a_length);
+        memcpy(text + a_length, b, b_length + 1);
+        value.integer = 0;
+        set_literal(node, TOKEN_STRING, new_literal(literals, value, text, a_length + b_length));
+        return true;
+    default:
+        return fold_comparison(node);
+    }
+}
+
+/**
+ * @brief Replace an integer literal converted to a number by a number literal.
+ *
+ * @param[in,out] node The operand.
+ * @param[in,out] literals Arena for the value of the new literal.
+ */
+static void promote_literal(expr_node_s *node, arena_s *literals)
+{
+    if (node->to_number && !node->left && node->token.type == TOKEN_INT) {
+        set_number(node, (double)TOKEN_LITERAL(&node->token).integer, literals);
+        node->to_number = false;
+    }
+}
+
+bool expr_fold(expr_node_s *node, arena_s *literals)
+{
+    expr_node_s *left = node->left, *right = node->right;
+
+    if (!left) {
+        return false;
+    }
+
+    /* The string length */
+    if (!right) {
+        if (left->left || left->token.type != TOKEN_STRING) {
+            return false;
+        }
+        node->token.line = left->token.line;
+        set_integer(node, decoded_length(token_value(&left->token)), literals);
+        return true;
+    }
+
+    promote_literal(left, literals);
+    promote_literal(right, literals);
+    if (!is_literal(left) || !is_literal(right)) {
+        return false;
+    }
+    if (!fold_binary(node, literals)) {
+        return false;
+    }
+    /* The folded literal stands where its last operand was */
+    node->token.line = right->token.line;
+    return true;
+}
+
+/**
+ * @brief Check if the value of a node is never nil. The operators fail on nil operands, so their
+ * results are never nil, unlike variables.
+ *
+ * @param[in] node The node.
+ *
+ * @return True for operators and literals other than nil.
+ */
+static bool is_not_nil(const expr_node_s *node)
+{
+    return node->left || (is_literal(node) && node->token.type != TOKEN_KEYWORD);
+}
+
+/**
+ * @brief Check if a node is a numeric literal with the given value.
+ *
+ * @param[in] node The node.
+ * @param[in] value The value, for numbers the sign of zero must match too.
+ *
+ * @return True if it is the literal.
+ */
+static bool is_number(const expr_node_s *node, int64_t value)
+{
+    double number;
+
+    if (node->left) {
+        return false;
+    }
+    if (node->token.type == TOKEN_INT) {
+        return TOKEN_LITERAL(&node->token).integer == value;
+    }
+    if (node->token.type != TOKEN_NUMBER) {
+        return false;
+    }
+    number = TOKEN_LITERAL(&node->token).number;
+    return number == (double)value && !signbit(number);
+}
+
+/**
+ * @brief Replace a node by one of its operands.
+ *
+ * @param[in,out] node The node.
+ * @param[in] operand The operand of the same type that has the value of the node.
+ *
+ * @return True.
+ */
+static bool replace_by(expr_node_s *node, const expr_node_s *operand)
+{
+    *node = *operand;
+    return true;
+}
+
+bool expr_simplify(expr_node_s *node)
+{
+    expr_node_s *left = node->left, *right = node->right;
+    bool is_int;
+
+    /* A conversion of an operand changes its value */
+    if (!right || left->to_number || right->to_number) {
+        return false;
+    }
+    is_int = node->type == SYM_TYPE_INT;
+
+    switch (node->token.type) {
+    case TOKEN_ADD:
+        /* Adding a positive zero to a negative one gives a positive one */
+        if (is_int && is_number(right, 0) && is_not_nil(left)) {
+            return replace_by(node, left);
+        }
+        if (is_int && is_number(left, 0) && is_not_nil(right)) {
+            return replace_by(node, right);
+        }
+        return false;
+    case TOKEN_SUB:
+        if (is_number(right, 0) && is_not_nil(left)) {
+            return replace_by(node, left);
+        }
+        return false;
+    case TOKEN_MUL:
+        if (is_number(right, 1) && is_not_nil(left)) {
+            return replace_by(node, left);
+        }
+        if (is_number(left, 1) && is_not_nil(right)) {
+            return replace_by(node, right);
+        }
+        /* A variable is pushed twice instead of the literal, the addition is cheaper */
+        if (is_number(right, 2) && left->token.type == TOKEN_ID) {
+            node->token.type = TOKEN_ADD;
+            *right = *left;
+            return true;
+        }
+        if (is_number(left, 2) && right->token.type == TOKEN_ID) {
+            node->token.type = TOKEN_ADD;
+            *left = *right;
+            return true;
+        }
+        return false;
+    case TOKEN_STRING_CONCAT:
+        if (right->token.type == TOKEN_STRING && !*token_value(&right->token)
+            && is_not_nil(left)) {
+            return replace_by(node, left);
+        }
+        if (left->token.type == TOKEN_STRING && !*token_value(&left->token)
+            && is_not_nil(right)) {
+            return replace_by(node, right);
+        }
+        return false;
+    default:
+        return false;
+    }
+}
@@ -0,0 +1,66 @@
+/**
+ * @file exp_tree.h
+ * Projekt: Implementace prekladace imperativniho jazyka IFJ21.
+ * @author Tadeas Vintrlik <xvintr04@stud.fit.vutbr.cz>
+ * @brief Tree of a parsed expression passed from the expression parser to the code generator and
+ * its rewrites.
+ */
+
+#ifndef _EXP_TREE_H
+#define _EXP_TREE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "arena.h"
+#include "token_stack.h"
+
+/**
+ * @brief Node of an expression tree. Operands have no children, the string length has only the
+ * left one and the binary operators both. The nodes are allocated in the arena of the compilation
+ * and live until the expression is generated.
+ */
+typedef struct expr_node {
+    T_token token; /* Copy of the operand or the operator */
+    struct expr_node *left;
+    struct expr_node *right;
+    struct expr_value *value; /* Value of the node in the current basic block */
+    uint8_t type; /* symbol_type_e of the value of the node */
+    bool to_number; /* The integer value is converted to a number for the operator above */
+    bool reuse; /* The value is pushed from where it was kept, the operands are not generated */
+} expr_node_s;
+
+/**
+ * @brief Tree of a whole expression.
+ */
+typedef struct expr_tree {
+    expr_node_s *root;
+    unsigned size; /* Number of nodes */
+} expr_tree_s;
+
+/**
+ * @brief Fold an operator applied to literals into a literal, following the typing rules of
+ * sem_check_expr_type. Integer literals converted to a number are replaced by number literals
+ * first. Operations that fail at run time, like a division by zero, or that the interpreter
+ * computes differently are not folded.
+ *
+ * @param[in,out] node Operator node with checked operands. Its children are folded already.
+ * @param[in,out] literals Arena for the values of the new literals.
+ *
+ * @return True if the node was turned into a literal.
+ */
+bool expr_fold(expr_node_s *node, arena_s *literals);
+
+/**
+ * @brief Simplify an operator with a neutral operand, like `x + 0`, `x * 1` or `x .. ""`, to the
+ * other operand, and a variable multiplied by two to an addition. The operand must not be nil, as
+ * the operator would fail on it, so only operators and literals are kept in place of the node.
+ * Integer and number operands are never mixed and the sign of a zero number is preserved.
+ *
+ * @param[in,out] node Operator node with checked operands that could not be folded.
+ *
+ * @return True if the node was simplified.
+ */
+bool expr_simplify(expr_node_s *node);
+
+#endif /* _EXP_TREE_H */
@@ -0,0 +1,248 @@
+/**
+ * @file exp_values.c
+ * Projekt: Implementace prekladace imperativniho jazyka IFJ21.
+ * @author Tadeas Vintrlik <xvintr04@stud.fit.vutbr.cz>
+ * @brief Implementation of the table of values computed in a basic block.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "common.h"
+#include "exp_values.h"
+
+#define EXP_VERSIONS_INITIAL_CAPACITY 64
+
+/**
+ * @brief Hash a pointer or a pair of numbers.
+ *
+ * @param[in] first The first number.
+ * @param[in] second The second number.
+ * @param[in] op The operator.
+ *
+ * @return The hash.
+ */
+static unsigned hash_key(uint64_t first, uint64_t second, unsigned op)
+{
+    uint64_t hash = (first * 0x9e3779b97f4a7c15u) ^ (second + op) * 0xc2b2ae3d27d4eb4fu;
+
+    return (unsigned)(hash ^ hash >> 29);
+}
+
+/**
+ * @brief Find the slot of the version of a variable.
+ *
+ * @param[in] values The table.
+ * @param[in] name Interned name of the variable.
+ *
+ * @return The slot, its name is NULL if the variable has no version yet.
+ */
+static expr_version_s *find_version(const expr_values_s *values, const char *name)
+{
+    unsigned mask = values->versions_capacity - 1;
+    unsigned i = hash_key((uintptr_t)name, 0, 0) & mask;
+
+    /* Interned names are equal only if they are the same pointer */
+    while (values->versions[i].name && values->versions[i].name != name) {
+        i = (i + 1) & mask;
+    }
+    return &values->versions[i];
+}
+
+/**
+ * @brief Get the current version of a variable.
+ *
+ * @param[in] values The table.
+ * @param[in] name Interned name of the variable.
+ *
+ * @return The version, 0 if the variable was never assigned to.
+ */
+static unsigned get_version(const expr_values_s *values, const char *name)
+{
+    return find_version(values, name)->version;
+}
+
+/**
+ * @brief Double the capacity of the table of versions.
+ *
+ * @param[in,out] values The table.
+ */
+static void grow_versions(expr_values_s *values)
+{
+    expr_version_s *old = values->versions;
+    unsigned old_capacity = values->versions_capacity;
+
+    values->versions_capacity *= 2;
+    values->versions = calloc(values->versions_capacity, sizeof *values->versions);
+    ALLOC_CHECK(values->versions);
+    for (unsigned i = 0; i < old_capacity; i++) {
+        if (old[i].name) {
+            *find_version(values, old[i].name) = old[i];
+        }
+    }
+    FREE(old);
+}
+
+void expr_values_init(expr_values_s *values)
+{
+    values->table = calloc(EXP_VALUES_SIZE, sizeof *values->table);
+    ALLOC_CHECK(values->table);
+    values->versions = calloc(EXP_VERSIONS_INITIAL_CAPACITY, sizeof *values->versions);
+    ALLOC_CHECK(values->versions);
+    values->versions_capacity = EXP_VERSIONS_INITIAL_CAPACITY;
+    values->versions_count = 0;
+    values->last_version = 0;
+    values->numbers = 0;
+    values->stamp = 0;
+    /* The zeroed slots belong to no basic block */
+    values->generation = 0;
+    expr_values_clear(values);
+}
+
+void expr_values_destroy(expr_values_s *values)
+{
+    FREE(values->table);
+    FREE(values->versions);
+}
+
+void expr_values_clear(expr_values_s *values)
+{
+    values->generation++;
+    values->count = 0;
+    values->result = NULL;
+    expr_values_call(values);
+}
+
+void expr_values_call(expr_values_s *values)
+{
+    for (unsigned i = 0; i < EXP_VALUES_TEMPS; i++) {
+        values->temps[i] = 0;
+        values->temp_stamps[i] = 0;
+    }
+}
+
+void expr_values_assign(expr_values_s *values, const char *name, expr_value_s *value)
+{
+    expr_version_s *version;
+
+    if (4 * (values->versions_count + 1) > 3 * values->versions_capacity) {
+        grow_versions(values);
+    }
+    version = find_version(values, name);
+    if (!version->name) {
+        version->name = name;
+        values->versions_count++;
+    }
+    version->version = ++values->last_version;
+
+    if (value) {
+        value->variable = name;
+        value->version = version->version;
+    }
+}
+
+void expr_values_begin(expr_values_s *values, unsigned size)
+{
+    /* Keep the table at most half full, a full basic block starts over */
+    if (2 * (values->count + size) > EXP_VALUES_SIZE) {
+        expr_values_clear(values);
+    }
+    values->stamp++;
+}
+
+expr_value_s *expr_values_find(expr_values_s *values, const expr_node_s *node)
+{
+    const T_token *token = &node->token;
+    uint64_t first = 0, second = 0;
+    uint8_t flags = 0;
+    expr_value_s *value;
+    unsigned i;
+
+    if (node->left) {
+        first = node->left->value->number;
+        second = node->right ? node->right->value->number : 0;
+        flags = node->left->to_number | (node->right && node->right->to_number) << 1;
+    } else {
+        switch (token->type) {
+        case TOKEN_ID:
+            first = (uintptr_t)token->handle.name;
+            second = get_version(values, token->handle.name);
+            break;
+        case TOKEN_INT:
+        case TOKEN_BOOL:
+            first = (uint64_t)TOKEN_LITERAL(token).integer;
+            break;
+        case TOKEN_NUMBER:
+            memcpy(&first, &TOKEN_LITERAL(token).number, sizeof first);
+            break;
+        case TOKEN_STRING:
+            /* Equal strings with a different text only miss the reuse */
+            first = (uintptr_t)token_value(token);
+            break;
+        default:
+            break;
+        }
+    }
+
+    for (i = hash_key(first, second, token->type);; i++) {
+        value = &values->table[i & (EXP_VALUES_SIZE - 1)];
+        if (value->generation != values->generation) {
+            break;
+        }
+        if (value->op == token->type && value->flags == flags && value->first == first
+            && value->second == second) {
+            return value;
+        }
+    }
+
+    value->first = first;
+    value->second = second;
+    value->generation = values->generation;
+    value->number = ++values->numbers;
+    value->variable = NULL;
+    value->version = 0;
+    value->stamp = 0;
+    value->temp = -1;
+    value->op = token->type;
+    value->flags = flags;
+    values->count++;
+    return value;
+}
+
+const char *expr_values_variable(const expr_values_s *values, const expr_value_s *value)
+{
+    if (value->variable && get_version(values, value->variable) == value->version) {
+        return value->variable;
+    }
+    return NULL;
+}
+
+int expr_values_temp(const expr_values_s *values, const expr_value_s *value)
+{
+    if (value->temp >= 0 && values->temps[value->temp] == value->number) {
+        return value->temp;
+    }
+    return -1;
+}
+
+int expr_values_reserve(expr_values_s *values, expr_value_s *value)
+{
+    int temp = expr_values_temp(values, value);
+
+    if (temp < 0) {
+        /* The least recently used temporary not needed by the current expression */
+        for (int i = 0; i < EXP_VALUES_TEMPS; i++) {
+            if (values->temp_stamps[i] != values->stamp
+                && (temp < 0 || values->temp_stamps[i] < values->temp_stamps[temp])) {
+                temp = i;
+            }
+        }
+        if (temp < 0) {
+            return -1;
+        }
+        values->temps[temp] = value->number;
+        value->temp = temp;
+    }
+    values->temp_stamps[temp] = values->stamp;
+    return temp;
+}
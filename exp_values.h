@@ -0,0 +1,160 @@
+/**
+ * @file exp_values.h
+ * Projekt: Implementace prekladace imperativniho jazyka IFJ21.
+ * @author Tadeas Vintrlik <xvintr04@stud.fit.vutbr.cz>
+ * @brief Header for the table of values computed in a basic block, used to compute repeated
+ * subexpressions only once.
+ */
+
+#ifndef _EXP_VALUES_H
+#define _EXP_VALUES_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "exp_tree.h"
+
+/**
+ * @brief Number of global temporaries that keep values for later expressions.
+ */
+#define EXP_VALUES_TEMPS 8
+
+/**
+ * @brief Number of slots of the table of values, a power of two.
+ */
+#define EXP_VALUES_SIZE 2048
+
+/**
+ * @brief A value computed in the current basic block. Two nodes have the same value if they apply
+ * the same operator to the same values, or if they are the same literal or the same version of a
+ * variable.
+ */
+typedef struct expr_value {
+    uint64_t first; /* Value number of the left operand, the literal or the variable */
+    uint64_t second; /* Value number of the right operand or the version of the variable */
+    unsigned generation; /* Basic block of the entry, the slot is empty for an older one */
+    unsigned number; /* Value number, unique for the whole compilation */
+    const char *variable; /* Variable holding the value or NULL */
+    unsigned version; /* Version of the variable when it got the value */
+    unsigned stamp; /* The last expression the value was used in */
+    int temp; /* Temporary holding the value or -1 */
+    uint8_t op; /* Type of the token of the node */
+    uint8_t flags; /* Conversions of the operands */
+} expr_value_s;
+
+/**
+ * @brief Version of a variable, changed by every assignment.
+ */
+typedef struct expr_version {
+    const char *name; /* Interned name, NULL for an empty slot */
+    unsigned version;
+} expr_version_s;
+
+/**
+ * @brief Values of the current basic block together with where they are kept.
+ */
+typedef struct expr_values {
+    expr_value_s *table;
+    unsigned count; /* Number of values in the current basic block */
+    unsigned generation; /* Current basic block */
+    unsigned numbers; /* Last used value number */
+    unsigned stamp; /* Current expression */
+    expr_version_s *versions; /* Hash table of the versions of the variables */
+    unsigned versions_capacity; /* Power of two */
+    unsigned versions_count;
+    unsigned last_version;
+    unsigned temps[EXP_VALUES_TEMPS]; /* Value number held by each temporary, 0 if none */
+    unsigned temp_stamps[EXP_VALUES_TEMPS]; /* The last expression that used the temporary */
+    expr_value_s *result; /* Value of the last expression, NULL after the end of a basic block */
+} expr_values_s;
+
+/**
+ * @brief Initialize an empty table.
+ *
+ * @param[out] values The table to initialize.
+ */
+void expr_values_init(expr_values_s *values);
+
+/**
+ * @brief Free the table.
+ *
+ * @param[in,out] values The table to destroy.
+ */
+void expr_values_destroy(expr_values_s *values);
+
+/**
+ * @brief Forget all values, to be called where a new basic block starts.
+ *
+ * @param[in,out] values The table.
+ */
+void expr_values_clear(expr_values_s *values);
+
+/**
+ * @brief Forget the values kept in the temporaries, to be called after a call of a function that
+ * may use them.
+ *
+ * @param[in,out] values The table.
+ */
+void expr_values_call(expr_values_s *values);
+
+/**
+ * @brief Record an assignment to a variable. The values computed from its previous version are
+ * no longer found.
+ *
+ * @param[in,out] values The table.
+ * @param[in] name Interned name of the variable.
+ * @param[in] value The value the variable gets. NULL if it is not known.
+ */
+void expr_values_assign(expr_values_s *values, const char *name, expr_value_s *value);
+
+/**
+ * @brief Start a new expression. Makes sure the table has room for all the values of it.
+ *
+ * @param[in,out] values The table.
+ * @param[in] size Number of nodes of the expression.
+ */
+void expr_values_begin(expr_values_s *values, unsigned size);
+
+/**
+ * @brief Find the value of a node, add it if it is new. The values of the operands of the node
+ * must be set already.
+ *
+ * @param[in,out] values The table.
+ * @param[in] node The node.
+ *
+ * @return The value. Valid until the end of the basic block.
+ */
+expr_value_s *expr_values_find(expr_values_s *values, const expr_node_s *node);
+
+/**
+ * @brief Get the variable that holds a value.
+ *
+ * @param[in] values The table.
+ * @param[in] value The value.
+ *
+ * @return Name of the variable. NULL if no variable holds the value.
+ */
+const char *expr_values_variable(const expr_values_s *values, const expr_value_s *value);
+
+/**
+ * @brief Get the temporary that holds a value.
+ *
+ * @param[in] values The table.
+ * @param[in] value The value.
+ *
+ * @return Index of the temporary. -1 if no temporary holds the value.
+ */
+int expr_values_temp(const expr_values_s *values, const expr_value_s *value);
+
+/**
+ * @brief Reserve a temporary for a value until the end of the current expression. A temporary the
+ * value already has is kept, otherwise the one unused for the longest time is taken.
+ *
+ * @param[in,out] values The table.
+ * @param[in,out] value The value.
+ *
+ * @return Index of the temporary. -1 if all of them are used by the current expression.
+ */
+int expr_values_reserve(expr_values_s *values, expr_value_s *value);
+
+#endif /* _EXP_VALUES_H */
@@ -0,0 +1,159 @@
+/**
+ * @file htable.c
+ * Projekt: Implementace prekladace imperativniho jazyka IFJ21.
+ * @author Tadeas Vintrlik <xvintr04@stud.fit.vutbr.cz>
+ * @brief Implementation of the hash table with interned string keys.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "htable.h"
+
+#define HTABLE_INITIAL_CAPACITY 16
+
+/**
+ * @brief Distance of a slot from the home slot of a hash.
+ *
+ * @param[in] htable The table.
+ * @param[in] slot Index of the slot.
+ * @param[in] hash The hash.
+ *
+ * @return Number of slots probed before @p slot.
+ */
+static unsigned probe_distance(const htable_s *htable, unsigned slot, unsigned hash)
+{
+    return (slot - hash) & (htable->capacity - 1);
+}
+
+/**
+ * @brief Find the slot of a key.
+ *
+ * @param[in] htable The table.
+ * @param[in] key The key.
+ * @param[in] hash Hash of the key.
+ *
+ * @return The slot. NULL if the key is not in the table.
+ */
+static htable_entry_s *find_entry(const htable_s *htable, const char *key, unsigned hash)
+{
+    unsigned mask = htable->capacity - 1;
+
+    if (!htable->capacity) {
+        return NULL;
+    }
+
+    for (unsigned i = hash & mask, distance = 0;; i = (i + 1) & mask, distance++) {
+        htable_entry_s *entry = &htable->table[i];
+
+        /* The key would have taken the place of a key closer to its home */
+        if (!entry->key || probe_distance(htable, i, entry->hash) < distance) {
+            return NULL;
+        }
+        if (entry->key == key) {
+            return entry;
+        }
+    }
+}
+
+/**
+ * @brief Place an entry that is not in the table yet. There must be an empty slot.
+ *
+ * @param[in,out] htable The table.
+ * @param[in] entry The entry to place.
+ */
+static void place_entry(htable_s *htable, htable_entry_s entry)
+{
+    unsigned mask = htable->capacity - 1;
+    htable_entry_s swap;
+
+    for (unsigned i = entry.hash & mask, distance = 0;; i = (i + 1) & mask, distance++) {
+        htable_entry_s *slot = &htable->table[i];
+
+        if (!slot->key) {
+            *slot = entry;
+            return;
+        }
+
+        /* Take the slot from a key closer to its home and continue placing that one */
+        if (probe_distance(htable, i, slot->hash) < distance) {
+            swap = *slot;
+            *slot = entry;
+            entry = swap;
+            distance = probe_distance(htable, i, entry.hash);
+        }
+    }
+}
+
+/**
+ * @brief Double the capacity of the table and move all the entries over. The hashes are kept in
+ * the entries, so no key is hashed again.
+ *
+ * @param[in,out] htable The table.
+ */
+static void grow_table(htable_s *htable)
+{
+    htable_entry_s *old = htable->table;
+    unsigned old_capacity = htable->capacity;
+
+    htable->capacity = old_capacity ? 2 * old_capacity : HTABLE_INITIAL_CAPACITY;
+    htable->table = calloc(htable->capacity, sizeof *htable->table);
+    ALLOC_CHECK(htable->table);
+
+    for (unsigned i = 0; i < old_capacity; i++) {
+        if (old[i].key) {
+            place_entry(htable, old[i]);
+        }
+    }
+    FREE(old);
+}
+
+void htable_init(htable_s *htable)
+{
+    htable->table = NULL;
+    htable->capacity = 0;
+    htable->count = 0;
+}
+
+bool htable_search(const htable_s *htable, const char *key, void **value)
+{
+    htable_entry_s *entry = find_entry(htable, key, intern_hash(key));
+
+    if (!entry) {
+        return false;
+    }
+    if (value) {
+        *value = entry->value;
+    }
+    return true;
+}
+
+void htable_insert(htable_s *htable, const char *key, void *value)
+{
+    htable_entry_s entry = { key, value, intern_hash(key) };
+    htable_entry_s *found = find_entry(htable, key, entry.hash);
+
+    if (found) {
+        found->value = value;
+        return;
+    }
+
+    /* Keep the table at most three quarters full */
+    if (4 * (htable->count + 1) > 3 * htable->capacity) {
+        grow_table(htable);
+    }
+    place_entry(htable, entry);
+    htable->count++;
+}
+
+void htable_destroy(htable_s *htable, destructor destructor)
+{
+    for (unsigned i = 0; i < htable->capacity; i++) {
+        htable_entry_s *entry = &htable->table[i];
+        if (entry->key) {
+            FREE_VALUE(entry, destructor);
+        }
+    }
+    FREE(htable->table);
+    htable_init(htable);
+}
@@ -0,0 +1,73 @@
+/**
+ * @file htable.h
+ * Projekt: Implementace prekladace imperativniho jazyka IFJ21.
+ * @author Tadeas Vintrlik <xvintr04@stud.fit.vutbr.cz>
+ * @brief Header for the hash table with interned string keys.
+ */
+
+#ifndef _HTABLE_H_
+#define _HTABLE_H_
+
+#include <stdbool.h>
+
+#include "common.h"
+#include "intern.h"
+
+/**
+ * @brief Slot of the hash table.
+ */
+typedef struct htable_entry {
+    const char *key; /* NULL for an empty slot */
+    void *value;
+    unsigned hash; /* Hash of the key, taken from the pool of interned names */
+} htable_entry_s;
+
+/**
+ * @brief Hash table with open addressing and Robin Hood linear probing. Every key is at most as far
+ * from its home slot as the keys it passed on the way, so a search can stop as soon as it meets a
+ * key closer to home than the searched one would be. Entries cannot be removed one by one. Keys
+ * are interned names, so they are never hashed again and are compared by the pointer.
+ */
+typedef struct htable {
+    htable_entry_s *table;
+    unsigned capacity; /* Power of two or zero */
+    unsigned count;
+} htable_s;
+
+/**
+ * @brief Initialize an empty table. Does not allocate anything.
+ *
+ * @param[out] htable The table to initialize.
+ */
+void htable_init(htable_s *htable);
+
+/**
+ * @brief Search for a key.
+ *
+ * @param[in] htable The table.
+ * @param[in] key Interned name to find.
+ * @param[out] value If the key was found its value will be placed here. If @p value is NULL the
+ * value will not be stored.
+ *
+ * @return True if the key was found.
+ */
+bool htable_search(const htable_s *htable, const char *key, void **value);
+
+/**
+ * @brief Insert a key with a value. If the key is already present its value is replaced.
+ *
+ * @param[in,out] htable The table.
+ * @param[in] key Interned name. Is not copied, must be valid as long as the table.
+ * @param[in] value The value.
+ */
+void htable_insert(htable_s *htable, const char *key, void *value);
+
+/**
+ * @brief Free the table and its values.
+ *
+ * @param[in,out] htable The table to destroy. It is left empty and can be used again.
+ * @param[in] destructor Destructor for the values. If NULL FREE is used.
+ */
+void htable_destroy(htable_s *htable, destructor destructor);
+
+#endif /* _HTABLE_H_ */
@@ -0,0 +1,139 @@
+/**
+ * @file intern.c
+ * Projekt: Implementace prekladace imperativniho jazyka IFJ21.
+ * @author Tadeas Vintrlik <xvintr04@stud.fit.vutbr.cz>
+ * @brief Implementation of the pool of interned identifier names.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "common.h"
+#include "intern.h"
+
+#define INTERN_INITIAL_CAPACITY 256
+#define INTERN_BLOCK_SIZE 4096
+
+/**
+ * @brief Find the slot of a name, or the empty slot where it belongs.
+ *
+ * @param[in] table The hash table.
+ * @param[in] capacity Capacity of the table, a power of two.
+ * @param[in] name The name.
+ * @param[in] length Length of the name.
+ * @param[in] hash Hash of the name.
+ *
+ * @return The slot.
+ */
+static intern_entry_s *find_slot(
+    intern_entry_s *table, unsigned capacity, const char *name, unsigned length, unsigned hash)
+{
+    unsigned i = hash & (capacity - 1);
+
+    while (table[i].name
+        && (table[i].hash != hash || table[i].length != length
+            || memcmp(table[i].name, name, length))) {
+        i = (i + 1) & (capacity - 1);
+    }
+    return &table[i];
+}
+
+/**
+ * @brief Double the capacity of the hash table and move all the names over.
+ *
+ * @param[in,out] pool The pool.
+ */
+static void grow_table(intern_s *pool)
+{
+    unsigned capacity = pool->capacity ? 2 * pool->capacity : INTERN_INITIAL_CAPACITY;
+    intern_entry_s *table = calloc(capacity, sizeof *table);
+    ALLOC_CHECK(table);
+
+    for (unsigned i = 0; i < pool->capacity; i++) {
+        intern_entry_s *entry = &pool->table[i];
+        if (entry->name) {
+            *find_slot(table, capacity, entry->name, entry->length, entry->hash) = *entry;
+        }
+    }
+
+    FREE(pool->table);
+    pool->table = table;
+    pool->capacity = capacity;
+}
+
+/**
+ * @brief Copy a name into the storage blocks of the pool, together with its hash.
+ *
+ * @param[in,out] pool The pool.
+ * @param[in] name The name.
+ * @param[in] length Length of the name.
+ * @param[in] hash Hash of the name.
+ *
+ * @return The null terminated copy.
+ */
+static const char *store_name(intern_s *pool, const char *name, unsigned length, unsigned hash)
+{
+    /* The hash in front of every name must stay aligned */
+    unsigned used = (pool->block_used + sizeof(unsigned) - 1) & ~(sizeof(unsigned) - 1);
+    unsigned needed = sizeof(intern_name_s) + length + 1;
+    intern_name_s *copy;
+
+    if (!pool->block || used + needed > pool->block_size) {
+        unsigned size = MAX(INTERN_BLOCK_SIZE, needed);
+        intern_block_s *block = malloc(sizeof *block + size);
+        ALLOC_CHECK(block);
+        block->previous = pool->block;
+        pool->block = block;
+        pool->block_size = size;
+        used = 0;
+    }
+
+    copy = (intern_name_s *)(pool->block->content + used);
+    copy->hash = hash;
+    memcpy(copy->name, name, length);
+    copy->name[length] = '\0';
+    pool->block_used = used + needed;
+    return copy->name;
+}
+
+void intern_init(intern_s *pool)
+{
+    pool->table = NULL;
+    pool->capacity = 0;
+    pool->count = 0;
+    pool->block = NULL;
+    pool->block_used = 0;
+    pool->block_size = 0;
+}
+
+const char *intern_string(intern_s *pool, const char *name, unsigned length)
+{
+    unsigned hash = hash_name(name, length);
+    intern_entry_s *slot;
+
+    /* Keep the table at most half full */
+    if (2 * (pool->count + 1) > pool->capacity) {
+        grow_table(pool);
+    }
+
+    slot = find_slot(pool->table, pool->capacity, name, length, hash);
+    if (!slot->name) {
+        slot->name = store_name(pool, name, length, hash);
+        slot->length = length;
+        slot->hash = hash;
+        pool->count++;
+    }
+    return slot->name;
+}
+
+void intern_destroy(intern_s *pool)
+{
+    while (pool->block) {
+        intern_block_s *previous = pool->block->previous;
+        FREE(pool->block);
+        pool->block = previous;
+    }
+    FREE(pool->table);
+    intern_init(pool);
+}
@@ -0,0 +1,90 @@
+/**
+ * @file intern.h
+ * Projekt: Implementace prekladace imperativniho jazyka IFJ21.
+ * @author Tadeas Vintrlik <xvintr04@stud.fit.vutbr.cz>
+ * @brief Header for the pool of interned identifier names.
+ */
+
+#ifndef _INTERN_H_
+#define _INTERN_H_
+
+#include <stddef.h>
+
+/**
+ * @brief An interned name together with its precomputed hash.
+ */
+typedef struct intern_entry {
+    const char *name; /* NULL for an empty slot */
+    unsigned length;
+    unsigned hash;
+} intern_entry_s;
+
+/**
+ * @brief Interned name as it is stored in the blocks of the pool. The hash precedes the name, so it
+ * can be read from the name alone.
+ */
+typedef struct intern_name {
+    unsigned hash;
+    char name[];
+} intern_name_s;
+
+/**
+ * @brief Block of memory the interned names are stored in. Blocks are never moved, so the names
+ * stay valid until the pool is destroyed.
+ */
+typedef struct intern_block {
+    struct intern_block *previous;
+    char content[];
+} intern_block_s;
+
+/**
+ * @brief Pool of unique names. Each distinct name is stored once, so two interned names are equal
+ * if and only if they are the same pointer.
+ */
+typedef struct intern {
+    intern_entry_s *table; /* Hash table with open addressing and linear probing */
+    unsigned capacity; /* Power of two or zero */
+    unsigned count;
+    intern_block_s *block; /* Block the next name is stored in */
+    unsigned block_used;
+    unsigned block_size;
+} intern_s;
+
+/**
+ * @brief Initialize an empty pool. Does not allocate anything.
+ *
+ * @param[out] pool The pool to initialize.
+ */
+void intern_init(intern_s *pool);
+
+/**
+ * @brief Get the unique copy of a name, insert it into the pool if it is not there yet.
+ *
+ * @param[in,out] pool The pool.
+ * @param[in] name The name, need not be null terminated.
+ * @param[in] length Length of the name.
+ *
+ * @return The null terminated interned name. Valid until the pool is destroyed.
+ */
+const char *intern_string(intern_s *pool, const char *name, unsigned length);
+
+/**
+ * @brief Get the hash of an interned name without hashing it again.
+ *
+ * @param[in] name Name returned by intern_string.
+ *
+ * @return The hash computed when the name was interned, the same as hash_name gives.
+ */
+static inline unsigned intern_hash(const char *name)
+{
+    return ((const intern_name_s *)(name - offsetof(intern_name_s, name)))->hash;
+}
+
+/**
+ * @brief Free the pool and all the names in it.
+ *
+ * @param[in,out] pool The pool to destroy.
+ */
+void intern_destroy(intern_s *pool);
+
+#endif /* _INTERN_H_ */
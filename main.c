@@ -12,8 +12,17 @@
 #include "parser.h"
 #include "scanner.h"
 
-int main(void)
+int main(int argc, char **argv)
 {
-    initialize_scanner();
-    return start_parsing();
+    context_s ctx;
+    rc_e ret;
+
+    /* The source is read from the path given as the first argument or from stdin */
+    if ((ret = initialize_scanner(&ctx, argc > 1 ? argv[1] : NULL)) != RC_OK) {
+        return ret;
+    }
+    ctx.out = stdout;
+    ret = start_parsing(&ctx);
+    destroy_scanner(&ctx);
+    return ret;
 }
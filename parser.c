@@ -16,115 +16,136 @@
 #include "token_stack.h"
 #include <stdbool.h>
 
-static rc_e rc = RC_SYN_ERR;
-
 #define GET_CHECK(TYPE)                                                                            \
-    token = get_next_token();                                                                      \
+    token = get_next_token(ctx);                                                                   \
     if (token->type != TYPE) {                                                                     \
         print_unexpected_token(token, TYPE, "");                                                   \
         return false;                                                                              \
     }
 
 #define GET_CHECK_CMP(TYPE, VALUE)                                                                 \
-    token = get_next_token();                                                                      \
-    if (token->type != TYPE || strcmp(VALUE, token->value->content) != 0) {                        \
+    token = get_next_token(ctx);                                                                   \
+    if (token->type != TYPE || !token_equals(token, VALUE)) {                                      \
         print_unexpected_token(token, TYPE, VALUE);                                                \
         return false;                                                                              \
     }
 
-static symtable_s symtable;
+#define GET_CHECK_KEYWORD(KEYWORD)                                                                 \
+    token = get_next_token(ctx);                                                                   \
+    if (token->type != TOKEN_KEYWORD || token->keyword != KEYWORD) {                               \
+        print_unexpected_token(token, TOKEN_KEYWORD, keyword_to_string(KEYWORD));                  \
+        return false;                                                                              \
+    }
 
-static bool rule_PROG();
-static bool rule_CODE();
-static bool rule_TOP_ELEM();
+static bool rule_PROG(context_s *ctx);
+static bool rule_CODE(context_s *ctx);
+static bool rule_TOP_ELEM(context_s *ctx);
 
-static bool rule_DECL();
-static bool rule_DEF();
-static bool rule_CALL(bool top_level);
+static bool rule_DECL(context_s *ctx);
+static bool rule_DEF(context_s *ctx);
+static bool rule_CALL(context_s *ctx, bool top_level, symbol_s **called);
 
-static bool rule_PARAM_LIST(tstack_s *);
-static bool rule_NEXT_PARAM(tstack_s *);
-static bool rule_PARAM(tstack_s *);
+static bool rule_PARAM_LIST(context_s *ctx, tstack_s *);
+static bool rule_NEXT_PARAM(context_s *ctx, tstack_s *);
+static bool rule_PARAM(context_s *ctx, tstack_s *);
 
-static bool rule_RET_LIST(tstack_s *);
-static bool rule_TYPE_LIST(tstack_s *);
-static bool rule_NEXT_TYPE(tstack_s *);
-static bool rule_TYPE(tstack_s *);
+static bool rule_RET_LIST(context_s *ctx, tstack_s *);
+static bool rule_TYPE_LIST(context_s *ctx, tstack_s *);
+static bool rule_NEXT_TYPE(context_s *ctx, tstack_s *);
+static bool rule_TYPE(context_s *ctx, tstack_s *);
 
-static bool rule_ARG_LIST();
-static bool rule_ARG();
-static bool rule_NEXT_ARG();
+static bool rule_ARG_LIST(context_s *ctx, tstack_s *);
+static bool rule_ARG(context_s *ctx, tstack_s *);
+static bool rule_NEXT_ARG(context_s *ctx, tstack_s *);
 
-static bool rule_BODY();
-static bool rule_STATEMENT_LIST();
+static bool rule_BODY(context_s *ctx);
+static bool rule_STATEMENT_LIST(context_s *ctx);
 
-static bool rule_IF_ELSE();
-static bool rule_WHILE();
-static bool rule_EXPR(symbol_type_e *type);
-static bool rule_VAR_DECL();
+static bool rule_IF_ELSE(context_s *ctx);
+static bool rule_WHILE(context_s *ctx);
+static bool rule_EXPR(context_s *ctx, symbol_type_e *type);
+static bool rule_VAR_DECL(context_s *ctx);
 
-static bool left_side_function();
-static bool right_side_function(sll_s *left_side_ids);
-static bool assign_call_to_left_ids(sll_s *left_side_ids, T_token *fun_symbol, unsigned line);
-static bool assign_expressions_to_left_ids(sll_s *left_side_ids, unsigned line);
-static bool evaluate_return_expressions(unsigned line);
+static bool left_side_function(context_s *ctx);
+static bool right_side_function(context_s *ctx, sll_s *left_side_ids);
+static bool assign_call_to_left_ids(
+    context_s *ctx, sll_s *left_side_ids, symbol_s *fun_symbol, unsigned line);
+static bool assign_expressions_to_left_ids(context_s *ctx, sll_s *left_side_ids, unsigned line);
+static bool evaluate_return_expressions(context_s *ctx, unsigned line);
 
-rc_e start_parsing()
+rc_e start_parsing(context_s *ctx)
 {
     rc_e ret;
-    symtable_init(&symtable);
-    ret = rule_PROG() ? RC_OK : rc;
+    jmp_buf lex_error;
+
+    ctx->rc = RC_SYN_ERR;
+    symtable_init(&ctx->symtable, &ctx->names);
+    arena_init(&ctx->arena);
+    expr_values_init(&ctx->values);
+
+    /* The scanner jumps back here on a lexical error */
+    if (setjmp(lex_error)) {
+        ctx->lex_error = NULL;
+        symtable_destroy(&ctx->symtable);
+        arena_destroy(&ctx->arena);
+        expr_values_destroy(&ctx->values);
+        return RC_LEX_ERR;
+    }
+    ctx->lex_error = &lex_error;
+
+    ret = rule_PROG(ctx) ? RC_OK : ctx->rc;
+    ctx->lex_error = NULL;
 
     if (ret == RC_OK) {
-        gen_function_call_list();
+        gen_function_call_list(ctx);
     }
 
-    symtable_destroy(&symtable);
+    symtable_destroy(&ctx->symtable);
+    arena_destroy(&ctx->arena);
+    expr_values_destroy(&ctx->values);
     return ret;
 }
 
-static bool rule_PROG()
+static bool rule_PROG(context_s *ctx)
 {
     T_token *token;
 
-    GET_CHECK_CMP(TOKEN_KEYWORD, "require");
+    GET_CHECK_KEYWORD(REQUIRE);
     token_destroy(token);
 
     GET_CHECK_CMP(TOKEN_STRING, "ifj21");
     token_destroy(token);
 
-    gen_prog_start();
+    gen_prog_start(ctx);
 
-    return rule_CODE();
+    return rule_CODE(ctx);
 }
 
-static bool rule_CODE()
+static bool rule_CODE(context_s *ctx)
 {
-    T_token *token = get_next_token();
-
-    if (token->type == TOKEN_EOF) {
-        token_destroy(token);
+    if (peek_token(ctx, 0)->type == TOKEN_EOF) {
+        token_destroy(get_next_token(ctx));
         return true;
     } else {
-        unget_token(token);
-        return rule_TOP_ELEM() && rule_CODE();
+        return rule_TOP_ELEM(ctx) && rule_CODE(ctx);
     }
 }
 
-static bool rule_TOP_ELEM()
+static bool rule_TOP_ELEM(context_s *ctx)
 {
-    T_token *first_token = get_next_token();
+    T_token *first_token = peek_token(ctx, 0);
 
     if (first_token->type == TOKEN_ID) {
-        /* Declaration of function checked in rule_CALL */
-        unget_token(first_token);
-        return rule_CALL(true);
+        /* Declaration of function checked in rule_CALL */
+        return rule_CALL(ctx, true, NULL);
     } else if (first_token->type == TOKEN_KEYWORD) {
-        unget_token(first_token);
-        if (!strcmp("global", first_token->value->content)) {
-            return rule_DECL();
-        } else if (!strcmp("function", first_token->value->content)) {
-            return rule_DEF();
+        switch (first_token->keyword) {
+        case GLOBAL:
+            return rule_DECL(ctx);
+        case FUNCTION:
+            return rule_DEF(ctx);
+        default:
+            break;
         }
     }
 
@@ -132,16 +153,17 @@ static bool rule_TOP_ELEM()
     return false;
 }
 
-static bool rule_CALL(bool top_level)
+static bool rule_CALL(context_s *ctx, bool top_level, symbol_s **called)
 {
-    T_token *token, *function;
-    tstack_s *in_params = malloc(sizeof *in_params);
-    ALLOC_CHECK(in_params);
-    tstack_init(in_params);
+    T_token *token;
+    symbol_s *function;
+    /* Top-level calls are kept until the end of the compilation */
+    tstack_s *in_params = arena_alloc(&ctx->arena, sizeof *in_params);
+    tstack_init_arena(in_params, &ctx->arena);
 
     GET_CHECK(TOKEN_ID);
     unsigned line = token->line;
-    if (!sem_check_call_function(token, &symtable, &function, &rc)) {
+    if (!sem_check_call_function(token, &ctx->symtable, &function, &ctx->rc)) {
         return false;
     }
     token_destroy(token);
@@ -149,97 +171,91 @@ static bool rule_CALL(bool top_level)
     GET_CHECK(TOKEN_LEFT_BRACKET);
     token_destroy(token);
 
-    if (!rule_ARG_LIST(in_params)) {
+    if (!rule_ARG_LIST(ctx, in_params)) {
         return false;
     }
 
     // NOTE: The write(...) function can never have a semantic error
-    if (strcmp("write", function->value->content)
-        && !sem_call_types_compatible(function, in_params, line, &rc)) {
+    if (strcmp(function->name, "write")
+        && !sem_call_types_compatible(function, in_params, line, &ctx->rc)) {
         return false;
     }
 
     if (top_level) {
-        gen_call_insert(function, in_params);
+        gen_call_insert(ctx, function, in_params);
     } else {
-        gen_func_call(function, in_params);
+        gen_func_call(ctx, function, in_params);
     }
 
     GET_CHECK(TOKEN_RIGHT_BRACKET);
     token_destroy(token);
 
+    if (called) {
+        *called = function;
+    }
     return true;
 }
 
-static bool rule_DECL()
+static bool rule_DECL(context_s *ctx)
 {
     T_token *token;
 
-    GET_CHECK_CMP(TOKEN_KEYWORD, "global");
+    GET_CHECK_KEYWORD(GLOBAL);
     token_destroy(token);
 
     GET_CHECK(TOKEN_ID);
 
-    if (!sem_check_redecl(token, &symtable, &rc)) {
+    if (!sem_check_redecl(token, &ctx->symtable, &ctx->rc)) {
         return false;
     }
 
-    token->fun_info = malloc(sizeof(function_info_s));
-    ALLOC_CHECK(token->fun_info);
-    function_info_init(token->fun_info);
-    token->fun_info->defined = false;
-
-    symtable_insert_token_global(&symtable, token);
-    T_token *function_symbol = token;
+    symbol_s *function_symbol = symtable_insert_function(&ctx->symtable, token, false);
+    token_destroy(token);
 
     GET_CHECK(TOKEN_COLON);
     token_destroy(token);
-    GET_CHECK_CMP(TOKEN_KEYWORD, "function");
+    GET_CHECK_KEYWORD(FUNCTION);
     token_destroy(token);
     GET_CHECK(TOKEN_LEFT_BRACKET);
     token_destroy(token);
 
-    if (!rule_TYPE_LIST(function_symbol->fun_info->in_params)) {
+    if (!rule_TYPE_LIST(ctx, function_symbol->fun_info.in_params)) {
         return false;
     }
 
     GET_CHECK(TOKEN_RIGHT_BRACKET);
     token_destroy(token);
 
-    return rule_RET_LIST(function_symbol->fun_info->out_params);
+    return rule_RET_LIST(ctx, function_symbol->fun_info.out_params);
 }
 
-static bool rule_DEF()
+static bool rule_DEF(context_s *ctx)
 {
-    T_token *token, *function_symbol = NULL;
+    T_token *token;
+    symbol_s *function_symbol = NULL;
 
-    GET_CHECK_CMP(TOKEN_KEYWORD, "function");
+    GET_CHECK_KEYWORD(FUNCTION);
     token_destroy(token);
 
     GET_CHECK(TOKEN_ID);
-    if (!sem_check_redef(token, &symtable, &function_symbol, &rc)) {
-        if (function_symbol->fun_info->defined) {
+    if (!sem_check_redef(token, &ctx->symtable, &function_symbol, &ctx->rc)) {
+        if (function_symbol->fun_info.defined) {
             return false;
         }
     } else {
-        /* First time definition */
-        token->fun_info = malloc(sizeof(function_info_s));
-        ALLOC_CHECK(token->fun_info);
-        function_info_init(token->fun_info);
-        token->fun_info->defined = true;
-
-        symtable_insert_token_global(&symtable, token);
-        function_symbol = token;
+        /* First time definition */
+        function_symbol = symtable_insert_function(&ctx->symtable, token, true);
     }
+    token_destroy(token);
 
     GET_CHECK(TOKEN_LEFT_BRACKET);
     token_destroy(token);
-    symtable_new_frame(&symtable);
+    symtable_new_frame(&ctx->symtable);
 
     tstack_s *defined_params_in = malloc(sizeof(tstack_s));
     ALLOC_CHECK(defined_params_in);
     tstack_init(defined_params_in);
-    if (!rule_PARAM_LIST(defined_params_in)) {
+    if (!rule_PARAM_LIST(ctx, defined_params_in)) {
         return false;
     }
 
@@ -249,80 +265,85 @@ static bool rule_DEF()
     tstack_s *defined_types_out = malloc(sizeof(tstack_s));
     ALLOC_CHECK(defined_types_out);
     tstack_init(defined_types_out);
-    if (!rule_RET_LIST(defined_types_out)) {
+    if (!rule_RET_LIST(ctx, defined_types_out)) {
         return false;
     }
 
     /* If defining a pre-declared function check the types */
-    if (!function_symbol->fun_info->defined) {
-        if (!sem_check_decl_def_params(function_symbol, defined_params_in, &rc)) {
+    if (!function_symbol->fun_info.defined) {
+        if (!sem_check_decl_def_params(function_symbol, defined_params_in, &ctx->rc)) {
             return false;
         }
 
-        if (!sem_check_decl_def_returns(function_symbol, defined_params_in, &rc)) {
+        if (!sem_check_decl_def_returns(function_symbol, defined_params_in, &ctx->rc)) {
             return false;
         }
-        function_symbol->fun_info->defined = true;
+        function_symbol->fun_info.defined = true;
     }
 
     // Must copy in params as they are also on the local frame (so they don't get destroyed)
     tstack_s *copy = tstack_copy(defined_params_in);
+    sll_destroy(defined_params_in, false);
     FREE(defined_params_in);
-    function_symbol->fun_info->in_params = copy;
-    function_symbol->fun_info->out_params = defined_types_out;
-
-    gen_func_start(function_symbol->value->content, copy, sll_get_length(defined_types_out));
-    if (!rule_BODY()) {
+    tstack_destroy(function_symbol->fun_info.in_params);
+    tstack_destroy(function_symbol->fun_info.out_params);
+    FREE(function_symbol->fun_info.in_params);
+    FREE(function_symbol->fun_info.out_params);
+    function_symbol->fun_info.in_params = copy;
+    function_symbol->fun_info.out_params = defined_types_out;
+
+    gen_func_start(ctx, function_symbol->name, copy, sll_get_length(defined_types_out));
+    if (!rule_BODY(ctx)) {
         return false;
     }
 
-    GET_CHECK_CMP(TOKEN_KEYWORD, "end");
-    symtable_pop_frame(&symtable);
-    gen_func_end();
+    GET_CHECK_KEYWORD(END);
+    symtable_pop_frame(&ctx->symtable);
+    gen_func_end(ctx);
     token_destroy(token);
 
     return true;
 }
 
-static bool rule_PARAM_LIST(tstack_s *collected_params)
+static bool rule_PARAM_LIST(context_s *ctx, tstack_s *collected_params)
 {
-    if (!rule_PARAM(collected_params)) {
+    if (!rule_PARAM(ctx, collected_params)) {
         return true;
     }
 
-    return rule_NEXT_PARAM(collected_params);
+    return rule_NEXT_PARAM(ctx, collected_params);
 }
 
-static bool rule_NEXT_PARAM(tstack_s *collected_params)
+static bool rule_NEXT_PARAM(context_s *ctx, tstack_s *collected_params)
 {
-    T_token *token = get_next_token();
+    T_token *token = get_next_token(ctx);
 
     if (token->type == TOKEN_COMMA) {
         token_destroy(token);
-        return rule_PARAM(collected_params) && rule_NEXT_PARAM(collected_params);
+        return rule_PARAM(ctx, collected_params) && rule_NEXT_PARAM(ctx, collected_params);
     } else {
-        unget_token(token);
+        unget_token(ctx, token);
         return true;
     }
 }
 
-static bool rule_PARAM(tstack_s *collected_params)
+static bool rule_PARAM(context_s *ctx, tstack_s *collected_params)
 {
-    T_token *token = get_next_token();
+    T_token *token = get_next_token(ctx);
 
     if (token->type != TOKEN_ID) {
-        unget_token(token);
+        unget_token(ctx, token);
         return false;
     }
 
-    symtable_insert_token_top(&symtable, token);
+    symtable_insert_token_top(&ctx->symtable, token);
     sll_insert_last(collected_params, token);
     T_token *param_token = token;
 
     GET_CHECK(TOKEN_COLON);
     token_destroy(token);
 
-    if (!rule_TYPE(collected_params)) {
+    if (!rule_TYPE(ctx, collected_params)) {
         return false;
     }
 
@@ -339,56 +360,61 @@ static bool rule_PARAM(tstack_s *collected_params)
     return true;
 }
 
-static bool rule_RET_LIST(tstack_s *collected_types)
+static bool rule_RET_LIST(context_s *ctx, tstack_s *collected_types)
 {
-    T_token *token = get_next_token();
+    T_token *token = get_next_token(ctx);
 
     if (token->type == TOKEN_COLON) {
         token_destroy(token);
-        return rule_TYPE(collected_types) && rule_NEXT_TYPE(collected_types);
+        return rule_TYPE(ctx, collected_types) && rule_NEXT_TYPE(ctx, collected_types);
     } else {
-        unget_token(token);
+        unget_token(ctx, token);
         return true;
     }
 }
 
-static bool rule_TYPE_LIST(tstack_s *collected_types)
+static bool rule_TYPE_LIST(context_s *ctx, tstack_s *collected_types)
 {
-    if (!rule_TYPE(collected_types)) {
+    if (!rule_TYPE(ctx, collected_types)) {
         return true;
     }
 
-    return rule_NEXT_TYPE(collected_types);
+    return rule_NEXT_TYPE(ctx, collected_types);
 }
 
-static bool rule_NEXT_TYPE(tstack_s *collected_types)
+static bool rule_NEXT_TYPE(context_s *ctx, tstack_s *collected_types)
 {
-    T_token *token = get_next_token();
+    T_token *token = get_next_token(ctx);
 
     if (token->type == TOKEN_COMMA) {
         token_destroy(token);
-        return rule_TYPE(collected_types) && rule_NEXT_TYPE(collected_types);
+        return rule_TYPE(ctx, collected_types) && rule_NEXT_TYPE(ctx, collected_types);
     } else {
-        unget_token(token);
+        unget_token(ctx, token);
         return true;
     }
 }
 
-static bool rule_TYPE(tstack_s *collected_types)
+static bool rule_TYPE(context_s *ctx, tstack_s *collected_types)
 {
-    T_token *token = get_next_token();
+    T_token *token = get_next_token(ctx);
 
     if (token->type == TOKEN_KEYWORD) {
-        if (!strcmp("nil", token->value->content)) {
+        switch (token->keyword) {
+        case NIL:
             token->symbol_type = SYM_TYPE_NIL;
-        } else if (!strcmp("integer", token->value->content)) {
+            break;
+        case INTEGER:
             token->symbol_type = SYM_TYPE_INT;
-        } else if (!strcmp("number", token->value->content)) {
+            break;
+        case NUMBER:
             token->symbol_type = SYM_TYPE_NUMBER;
-        } else if (!strcmp("string", token->value->content)) {
+            break;
+        case STRING:
             token->symbol_type = SYM_TYPE_STRING;
-        } else {
-            unget_token(token);
+            break;
+        default:
+            unget_token(ctx, token);
             return false;
         }
 
@@ -401,27 +427,27 @@ static bool rule_TYPE(tstack_s *collected_types)
         return true;
     }
 
-    unget_token(token);
+    unget_token(ctx, token);
     return false;
 }
 
-static bool rule_ARG_LIST(tstack_s *in_params)
+static bool rule_ARG_LIST(context_s *ctx, tstack_s *in_params)
 {
-    if (!rule_ARG(in_params)) {
+    if (!rule_ARG(ctx, in_params)) {
         return true;
     }
 
-    return rule_NEXT_ARG(in_params);
+    return rule_NEXT_ARG(ctx, in_params);
 }
 
-static bool rule_ARG(tstack_s *in_params)
+static bool rule_ARG(context_s *ctx, tstack_s *in_params)
 {
-    T_token *token = get_next_token();
+    T_token *token = get_next_token(ctx);
     T_token *symbol;
 
     switch (token->type) {
     case TOKEN_ID:
-        if (!sem_check_id_decl(token, &symtable, &symbol, &rc)) {
+        if (!sem_check_id_decl(token, &ctx->symtable, &symbol, &ctx->rc)) {
             return false;
         }
         token->symbol_type = symbol->symbol_type;
@@ -436,15 +462,15 @@ static bool rule_ARG(tstack_s *in_params)
         token->symbol_type = SYM_TYPE_STRING;
         break;
     case TOKEN_KEYWORD:
-        if (!strcmp("nil", token->value->content)) {
+        if (token->keyword == NIL) {
             token->symbol_type = SYM_TYPE_NIL;
             break;
         }
 
-        unget_token(token);
+        unget_token(ctx, token);
         return false;
     default:
-        unget_token(token);
+        unget_token(ctx, token);
         return false;
     }
 
@@ -452,168 +478,161 @@ static bool rule_ARG(tstack_s *in_params)
     return true;
 }
 
-static bool rule_NEXT_ARG(tstack_s *in_params)
+static bool rule_NEXT_ARG(context_s *ctx, tstack_s *in_params)
 {
-    T_token *token = get_next_token();
+    T_token *token = get_next_token(ctx);
 
     if (token->type == TOKEN_COMMA) {
         token_destroy(token);
 
-        return rule_ARG(in_params) && rule_NEXT_ARG(in_params);
+        return rule_ARG(ctx, in_params) && rule_NEXT_ARG(ctx, in_params);
     } else {
-        unget_token(token);
+        unget_token(ctx, token);
         return true;
     }
 }
 
 ///////////
 
-static bool rule_BODY()
+static bool rule_BODY(context_s *ctx)
 {
-    if (!rule_STATEMENT_LIST()) {
+    if (!rule_STATEMENT_LIST(ctx)) {
         return false;
     }
     return true;
 }
 
-static bool rule_STATEMENT_LIST()
+static bool rule_STATEMENT_LIST(context_s *ctx)
 {
-    T_token *token = get_next_token();
-    tstack_s *ret_list = malloc(sizeof *ret_list);
-    ALLOC_CHECK(ret_list);
-    tstack_init(ret_list);
+    T_token *token = peek_token(ctx, 0);
+    unsigned line;
 
     switch (token->type) {
     case TOKEN_KEYWORD:
-        unget_token(token);
-
-        if (!strcmp("return", token->value->content)) {
-            token = get_next_token(); // Skip the token we returned to the scanner
+        switch (token->keyword) {
+        case RETURN:
+            token = get_next_token(ctx); // Skip the peeked return keyword
+            line = token->line;
             token_destroy(token);
 
-            if (!evaluate_return_expressions(token->line)) {
+            if (!evaluate_return_expressions(ctx, line)) {
                 return false;
             }
-            printf("POPFRAME\nRETURN\n");
-            return rule_STATEMENT_LIST();
-        } else if (!strcmp("if", token->value->content)) {
-            return rule_IF_ELSE() && rule_STATEMENT_LIST();
-        } else if (!strcmp("while", token->value->content)) {
-            return rule_WHILE() && rule_STATEMENT_LIST();
-        } else if (!strcmp("local", token->value->content)) {
-            return rule_VAR_DECL() && rule_STATEMENT_LIST();
+            fprintf(ctx->out, "POPFRAME\nRETURN\n");
+            return rule_STATEMENT_LIST(ctx);
+        case IF:
+            return rule_IF_ELSE(ctx) && rule_STATEMENT_LIST(ctx);
+        case WHILE:
+            return rule_WHILE(ctx) && rule_STATEMENT_LIST(ctx);
+        case LOCAL:
+            return rule_VAR_DECL(ctx) && rule_STATEMENT_LIST(ctx);
+        default:
+            return true;
         }
-
-        return true;
     case TOKEN_ID:
-        unget_token(token);
-
-        return left_side_function() && rule_STATEMENT_LIST();
+        return left_side_function(ctx) && rule_STATEMENT_LIST(ctx);
     default:
-        unget_token(token);
         return true;
     }
 }
 
-static bool rule_IF_ELSE()
+static bool rule_IF_ELSE(context_s *ctx)
 {
     T_token *token;
 
-    GET_CHECK_CMP(TOKEN_KEYWORD, "if");
+    GET_CHECK_KEYWORD(IF);
     token_destroy(token);
 
     symbol_type_e expr_type;
-    if (!rule_EXPR(&expr_type)) {
+    gen_cond_start(ctx);
+    if (!rule_EXPR(ctx, &expr_type)) {
         return false;
     }
 
     if (expr_type != SYM_TYPE_BOOL) {
-        puts("PUSHS nil@nil");
-        puts("EQS");
-        puts("NOTS");
+        gen_cond_not_nil(ctx);
     }
 
-    GET_CHECK_CMP(TOKEN_KEYWORD, "then");
-    unsigned label = gen_jump_else();
+    GET_CHECK_KEYWORD(THEN);
+    unsigned label = gen_jump_else(ctx);
     token_destroy(token);
 
-    symtable_new_frame(&symtable);
-    if (!rule_BODY()) {
+    symtable_new_frame(&ctx->symtable);
+    if (!rule_BODY(ctx)) {
         return false;
     }
-    symtable_pop_frame(&symtable);
+    symtable_pop_frame(&ctx->symtable);
 
-    GET_CHECK_CMP(TOKEN_KEYWORD, "else");
-    gen_else_label(label);
+    GET_CHECK_KEYWORD(ELSE);
+    gen_else_label(ctx, label);
     token_destroy(token);
 
-    symtable_new_frame(&symtable);
-    if (!rule_BODY()) {
+    symtable_new_frame(&ctx->symtable);
+    if (!rule_BODY(ctx)) {
         return false;
     }
-    symtable_pop_frame(&symtable);
+    symtable_pop_frame(&ctx->symtable);
 
-    GET_CHECK_CMP(TOKEN_KEYWORD, "end");
-    gen_if_end(label);
+    GET_CHECK_KEYWORD(END);
+    gen_if_end(ctx, label);
     token_destroy(token);
 
     return true;
 }
 
-static bool rule_WHILE()
+static bool rule_WHILE(context_s *ctx)
 {
     T_token *token;
 
-    GET_CHECK_CMP(TOKEN_KEYWORD, "while");
-    unsigned label = gen_while_label();
+    GET_CHECK_KEYWORD(WHILE);
+    unsigned label = gen_while_label(ctx);
     token_destroy(token);
 
     symbol_type_e expr_type;
-    if (!rule_EXPR(&expr_type)) {
+    gen_cond_start(ctx);
+    if (!rule_EXPR(ctx, &expr_type)) {
         return false;
     }
 
     if (expr_type != SYM_TYPE_BOOL) {
-        puts("PUSHS nil@nil");
-        puts("EQS");
-        puts("NOTS");
+        gen_cond_not_nil(ctx);
     }
 
-    GET_CHECK_CMP(TOKEN_KEYWORD, "do");
-    gen_while_jump_end(label);
+    GET_CHECK_KEYWORD(DO);
+    gen_while_jump_end(ctx, label);
     token_destroy(token);
 
-    symtable_new_frame(&symtable);
-    if (!rule_BODY()) {
+    symtable_new_frame(&ctx->symtable);
+    if (!rule_BODY(ctx)) {
         return false;
     }
-    symtable_pop_frame(&symtable);
+    symtable_pop_frame(&ctx->symtable);
 
-    gen_while_jump_loop(label);
-    GET_CHECK_CMP(TOKEN_KEYWORD, "end");
-    gen_while_end_label(label);
+    gen_while_jump_loop(ctx, label);
+    GET_CHECK_KEYWORD(END);
+    gen_while_end_label(ctx, label);
     token_destroy(token);
 
     return true;
 }
 
-static bool rule_VAR_DECL()
+static bool rule_VAR_DECL(context_s *ctx)
 {
     T_token *token;
     // left_side_ids always contains exactly one ID
     sll_s left_side_ids;
     sll_init(&left_side_ids);
 
-    GET_CHECK_CMP(TOKEN_KEYWORD, "local");
+    GET_CHECK_KEYWORD(LOCAL);
     token_destroy(token);
 
     GET_CHECK(TOKEN_ID);
     T_token *symbol = token;
-    if (!sem_check_id_redecl(token, &symtable, &rc)) {
+    if (!sem_check_id_redecl(token, &ctx->symtable, &ctx->rc)) {
         return false;
     }
 
-    gen_var_decl(token);
+    gen_var_decl(ctx, token);
 
     sll_insert_head(&left_side_ids, token);
 
@@ -623,45 +642,38 @@ static bool rule_VAR_DECL()
     tstack_s collected_type;
     tstack_init(&collected_type);
 
-    if (!rule_TYPE(&collected_type)) {
+    if (!rule_TYPE(ctx, &collected_type)) {
         return false;
     }
 
     symbol->symbol_type = tstack_top(&collected_type)->symbol_type;
-    symtable_insert_token_top(&symtable, token_copy(symbol));
+    symtable_insert_token_top(&ctx->symtable, token_copy(symbol));
     tstack_destroy(&collected_type);
 
-    token = get_next_token();
+    token = get_next_token(ctx);
 
     if (token->type == TOKEN_DECLAR) {
         token_destroy(token);
         // left_side_ids always contains exactly one ID
-        return right_side_function(&left_side_ids);
+        return right_side_function(ctx, &left_side_ids);
     } else {
-        unget_token(token);
+        unget_token(ctx, token);
         return true;
     }
 }
 
-static bool rule_EXPR(symbol_type_e *type) { return exp_parse(&symtable, &rc, type); }
+static bool rule_EXPR(context_s *ctx, symbol_type_e *type) { return exp_parse(ctx, type); }
 
-static bool left_side_function()
+static bool left_side_function(context_s *ctx)
 {
     T_token *token;
     sll_s left_side_ids;
     sll_init(&left_side_ids);
 
-    GET_CHECK(TOKEN_ID);
-
     // We need two tokens to decide if this is a function call
-    T_token *token2 = get_next_token();
-
-    unget_token(token2);
-    unget_token(token);
-
     // Assuming function call (no assignment, left_side_ids is empty)
-    if (token2->type == TOKEN_LEFT_BRACKET) {
-        return right_side_function(&left_side_ids);
+    if (peek_token(ctx, 1)->type == TOKEN_LEFT_BRACKET) {
+        return right_side_function(ctx, &left_side_ids);
     }
 
     while (true) {
@@ -670,14 +682,14 @@ static bool left_side_function()
         sll_insert_last(&left_side_ids, token);
 
         T_token *symbol;
-        if (!symtable_search_all(&symtable, token->value->content, &symbol)) {
+        if (!symtable_search_all(&ctx->symtable, token_value(token), &symbol)) {
             ERR_MSG("Assigning to undeclared variable.", token->line);
-            rc = RC_SEM_UNDEF_ERR;
+            ctx->rc = RC_SEM_UNDEF_ERR;
             return false;
         }
         token->symbol_type = symbol->symbol_type;
 
-        token = get_next_token();
+        token = get_next_token(ctx);
 
         // We have collected all of the left side IDs
         if (token->type == TOKEN_DECLAR) {
@@ -690,27 +702,22 @@ static bool left_side_function()
         }
     }
 
-    return right_side_function(&left_side_ids);
+    return right_side_function(ctx, &left_side_ids);
 }
 
 /**
  * @brief Evaluates function call or expressions on right side and assigns them to ids.
  *
+ * @param[in,out] ctx Context of the compilation.
  * @param[in] left_side_ids List of IDs to assign to. If empty, results of eval are discarded.
  *
  * @return true Right side is syntactically correct.
  * @return false Right side is syntactically incorrect.
  */
-static bool right_side_function(sll_s *left_side_ids)
+static bool right_side_function(context_s *ctx, sll_s *left_side_ids)
 {
-    T_token *token = get_next_token();
-    T_token *token_2 = get_next_token();
-    unget_token(token_2);
-    unget_token(token);
-
-    /* Has to be allocated separately since rule_CALL frees the tokens */
-    char *func_name = my_strdup(token->value->content);
-    ALLOC_CHECK(func_name);
+    T_token *token = peek_token(ctx, 0);
+    T_token *token_2 = peek_token(ctx, 1);
 
     unsigned line = token->line;
 
@@ -719,72 +726,65 @@ static bool right_side_function(sll_s *left_side_ids)
 
     if (left_side_empty && is_call) {
         // handles "fun(a, b)"
-        FREE(func_name);
-        return rule_CALL(false);
+        return rule_CALL(ctx, false, NULL);
     } else if (!left_side_empty && is_call) {
         // handles "a, b, c = fun(a, b)"
+        symbol_s *fun_symbol;
 
-        if (!rule_CALL(false)) {
+        if (!rule_CALL(ctx, false, &fun_symbol)) {
             return false;
         }
 
-        T_token *fun_symbol;
-        // Existence checked in rule_CALL
-        symtable_search_global(&symtable, func_name, &fun_symbol);
-        FREE(func_name);
-
-        return assign_call_to_left_ids(left_side_ids, fun_symbol, line);
+        return assign_call_to_left_ids(ctx, left_side_ids, fun_symbol, line);
     } else if (!left_side_empty && !is_call) {
         // handles "a, b = b, a..."
-        FREE(func_name);
-        return assign_expressions_to_left_ids(left_side_ids, line);
+        return assign_expressions_to_left_ids(ctx, left_side_ids, line);
     }
 
     assert(false);
-    FREE(func_name);
     return sll_is_empty(left_side_ids);
 }
 
-static bool assign_call_to_left_ids(sll_s *left_side_ids, T_token *fun_symbol, unsigned line)
+static bool assign_call_to_left_ids(
+    context_s *ctx, sll_s *left_side_ids, symbol_s *fun_symbol, unsigned line)
 {
-    if (!sem_check_call_assign(left_side_ids, fun_symbol->fun_info->out_params, line, &rc)) {
+    if (!sem_check_call_assign(left_side_ids, fun_symbol->fun_info.out_params, line, &ctx->rc)) {
         return false;
     }
 
     sll_activate(left_side_ids);
-    sll_activate(fun_symbol->fun_info->out_params);
+    sll_activate(fun_symbol->fun_info.out_params);
 
     unsigned ret_index = 0;
 
     while (!tstack_empty(left_side_ids)) {
         T_token *id = tstack_top(left_side_ids);
-        T_token *out_param = sll_get_active(fun_symbol->fun_info->out_params);
-
-        if (id->symbol_type == SYM_TYPE_NUMBER && out_param->symbol_type == SYM_TYPE_INT) {
-            printf("INT2FLOAT TF@%%retval%d TF@%%retval%d\n", ret_index, ret_index);
-        }
+        T_token *out_param = sll_get_active(fun_symbol->fun_info.out_params);
 
-        printf("MOVE LF@%s TF@%%retval%d\n", id->value->content, ret_index);
+        gen_assign_result(ctx, id, ret_index,
+            id->symbol_type == SYM_TYPE_NUMBER && out_param->symbol_type == SYM_TYPE_INT);
         ret_index++;
 
         tstack_pop(left_side_ids, true);
-        sll_next(fun_symbol->fun_info->out_params);
+        sll_next(fun_symbol->fun_info.out_params);
     }
 
     return true;
 }
 
-static bool assign_expressions_to_left_ids(sll_s *left_side_ids, unsigned line)
+static bool assign_expressions_to_left_ids(context_s *ctx, sll_s *left_side_ids, unsigned line)
 {
     sll_activate(left_side_ids);
     bool first = true;
+    /* A single expression that is not converted is the value of the variable afterwards */
+    bool bind = sll_get_length(left_side_ids) == 1;
 
     while (sll_is_active(left_side_ids)) {
         if (!first) {
-            T_token *token = get_next_token();
+            T_token *token = get_next_token(ctx);
 
             if (token->type != TOKEN_COMMA) {
-                unget_token(token);
+                unget_token(ctx, token);
                 break;
             }
 
@@ -794,21 +794,22 @@ static bool assign_expressions_to_left_ids(sll_s *left_side_ids, unsigned line)
         first = false;
 
         symbol_type_e expr_type;
-        if (!rule_EXPR(&expr_type)) {
+        if (!rule_EXPR(ctx, &expr_type)) {
             return false;
         }
 
         T_token *left = sll_get_active(left_side_ids);
         if (!sem_check_type_compatible(left->symbol_type, expr_type)) {
             ERR_MSG("Assigning to invalid type.\n", line);
-            rc = RC_SEM_ASSIGN_ERR;
+            ctx->rc = RC_SEM_ASSIGN_ERR;
             return false;
         }
 
         if (left->symbol_type == SYM_TYPE_NUMBER && expr_type == SYM_TYPE_INT) {
-            puts("POPS GF@%tmp1");
-            puts("INT2FLOAT GF@%tmp1 GF@%tmp1");
-            puts("PUSHS GF@%tmp1");
+            fputs("POPS GF@%tmp1\n", ctx->out);
+            fputs("INT2FLOAT GF@%tmp1 GF@%tmp1\n", ctx->out);
+            fputs("PUSHS GF@%tmp1\n", ctx->out);
+            bind = false;
         }
 
         sll_next(left_side_ids);
@@ -816,19 +817,19 @@ static bool assign_expressions_to_left_ids(sll_s *left_side_ids, unsigned line)
 
     if (sll_is_active(left_side_ids)) {
         ERR_MSG("Not enough expressions on right side of assignment.\n", line);
-        rc = RC_SEM_ASSIGN_ERR;
+        ctx->rc = RC_SEM_ASSIGN_ERR;
         return false;
     }
 
-    T_token *token = get_next_token();
+    T_token *token = get_next_token(ctx);
 
     if (token->type == TOKEN_COMMA) {
         ERR_MSG("Too many expressions on right side of assignment.\n", line);
-        rc = RC_SEM_ASSIGN_ERR;
+        ctx->rc = RC_SEM_ASSIGN_ERR;
         return false;
     }
 
-    unget_token(token);
+    unget_token(ctx, token);
 
     tstack_reverse(&left_side_ids);
     sll_activate(left_side_ids);
@@ -836,26 +837,27 @@ static bool assign_expressions_to_left_ids(sll_s *left_side_ids, unsigned line)
     while (!tstack_empty(left_side_ids)) {
         T_token *id = tstack_top(left_side_ids);
 
-        printf("POPS LF@%s\n", id->value->content);
+        gen_assign(ctx, id, bind);
         tstack_pop(left_side_ids, true);
     }
+    FREE(left_side_ids);
 
     return true;
 }
 
-static bool evaluate_return_expressions(unsigned line)
+static bool evaluate_return_expressions(context_s *ctx, unsigned line)
 {
-    T_token *defined_func = symtable_get_current_def(&symtable);
-    sll_s *out_params = defined_func->fun_info->out_params;
+    symbol_s *defined_func = symtable_get_current_def(&ctx->symtable);
+    sll_s *out_params = defined_func->fun_info.out_params;
     sll_activate(out_params);
 
     unsigned expr_index = 0;
     while (sll_is_active(out_params)) {
         if (expr_index > 0) {
-            T_token *token = get_next_token();
+            T_token *token = get_next_token(ctx);
 
             if (token->type != TOKEN_COMMA) {
-                unget_token(token);
+                unget_token(ctx, token);
                 break;
             }
 
@@ -863,8 +865,8 @@ static bool evaluate_return_expressions(unsigned line)
         }
 
         symbol_type_e expr_type;
-        if (!rule_EXPR(&expr_type)) {
-            if (rc == RC_OK) {
+        if (!rule_EXPR(ctx, &expr_type)) {
+            if (ctx->rc == RC_OK) {
                 // If there is no next expression here, the return statement is correct
                 break;
             }
@@ -874,28 +876,28 @@ static bool evaluate_return_expressions(unsigned line)
         T_token *out_param = sll_get_active(out_params);
         if (!sem_check_type_compatible(out_param->symbol_type, expr_type)) {
             ERR_MSG("Return type incompatible with function definition.\n", line);
-            rc = RC_SEM_CALL_ERR;
+            ctx->rc = RC_SEM_CALL_ERR;
             return false;
         }
 
-        printf("POPS LF@%%retval%d\n", expr_index);
+        fprintf(ctx->out, "POPS LF@%%retval%d\n", expr_index);
 
         expr_index++;
         sll_next(out_params);
     }
 
     if (!sll_is_active(out_params)) {
-        T_token *token = get_next_token();
+        T_token *token = get_next_token(ctx);
 
         if (token->type == TOKEN_COMMA) {
             token_destroy(token);
 
             ERR_MSG("Too many expressions in return statement.\n", line);
-            rc = RC_SEM_CALL_ERR;
+            ctx->rc = RC_SEM_CALL_ERR;
             return false;
         }
 
-        unget_token(token);
+        unget_token(ctx, token);
     }
 
     return true;
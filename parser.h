@@ -21,6 +21,6 @@
 #include <stdlib.h>
 #include <string.h>
 
-rc_e start_parsing();
+rc_e start_parsing(context_s *ctx);
 
 #endif
@@ -6,11 +6,22 @@
  * @brief Scanner implementation.
  */
 
-#include <ctype.h>
+#define _POSIX_C_SOURCE 200809L
+
+#include <fcntl.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 #include "scanner.h"
 
@@ -43,407 +54,1120 @@ typedef enum {
     STATE_BLOCK_COMMENT,
     STATE_BLOCK_COMMENT_ENDING,
     STATE_DIV_OR_FLOOR_DIV,
-
+    STATE_COUNT /* Number of states, not a valid state */
 } State;
-static bool is_keyword(char *word)
+
+/**
+ * @brief Classes of input characters. Characters in the same class are never distinguished by any
+ * state of the FSM.
+ */
+typedef enum {
+    CC_EOF, /* End of file or 0xff byte (which reads as EOF into a char) */
+    CC_CTRL, /* Control characters not mentioned below */
+    CC_TAB_CR, /* '\t' and '\r' */
+    CC_NEWLINE,
+    CC_SPACE,
+    CC_OTHER, /* Printable characters not mentioned below, 0x1f and 0x7f */
+    CC_HIGH, /* Bytes 0x80 to 0xfe */
+    CC_D01, /* Digits '0' and '1' */
+    CC_D2,
+    CC_D34,
+    CC_D5,
+    CC_D69,
+    CC_EXP, /* 'e' and 'E' */
+    CC_HEX, /* Hexadecimal digits other than 'e' and 'E' */
+    CC_ESC, /* 'n' and 't' */
+    CC_X, /* Lowercase 'x' */
+    CC_LETTER, /* Other letters and '_' */
+    CC_QUOTE,
+    CC_BACKSLASH,
+    CC_PLUS,
+    CC_MINUS,
+    CC_STAR,
+    CC_HASH,
+    CC_LPAR,
+    CC_RPAR,
+    CC_COMMA,
+    CC_COLON,
+    CC_EQUAL,
+    CC_LESS,
+    CC_GREATER,
+    CC_TILDE,
+    CC_DOT,
+    CC_SLASH,
+    CC_LBRACKET,
+    CC_RBRACKET,
+    CC_COUNT /* Number of classes, not a valid class */
+} char_class_e;
+
+/**
+ * @brief Actions done by the FSM when taking a transition.
+ */
+typedef enum {
+    ACT_DEFAULT, /* Use the default transition of the state */
+    ACT_ERROR, /* Lexical error */
+    ACT_NEXT, /* Go to target state */
+    ACT_SPAN, /* Go to target state and skip all characters it would stay in on its own */
+    ACT_UNGET, /* Return the character and go to target state */
+    ACT_NEWLINE, /* Count a line the token starts on and go to target state */
+    ACT_COMMENT_NEWLINE, /* Count a line inside a comment and go to target state */
+    ACT_EMIT, /* Return token of target type */
+    ACT_EMIT_UNGET /* Return the character and return token of target type */
+} action_e;
+
+/**
+ * @brief Transition of the FSM. Target is a State or a token_type for the emitting actions.
+ */
+typedef struct transition {
+    unsigned char action;
+    unsigned char target;
+} transition_s;
+
+#define ERROR { ACT_ERROR, STATE_START }
+#define NEXT(STATE) { ACT_NEXT, STATE }
+#define SPAN(STATE) { ACT_SPAN, STATE }
+#define UNGET(STATE) { ACT_UNGET, STATE }
+#define NEWLINE(STATE) { ACT_NEWLINE, STATE }
+#define COMMENT_NEWLINE(STATE) { ACT_COMMENT_NEWLINE, STATE }
+#define EMIT(TYPE) { ACT_EMIT, TYPE }
+#define EMIT_UNGET(TYPE) { ACT_EMIT_UNGET, TYPE }
+
+#define DIGITS(T) [CC_D01] = T, [CC_D2] = T, [CC_D34] = T, [CC_D5] = T, [CC_D69] = T
+#define LETTERS(T) [CC_EXP] = T, [CC_HEX] = T, [CC_ESC] = T, [CC_X] = T, [CC_LETTER] = T
+
+/**
+ * @brief Class of every input byte.
+ */
+static const unsigned char char_classes[256] = {
+    /* 0x00 - 0x0f */
+    CC_CTRL, CC_CTRL, CC_CTRL, CC_CTRL, CC_CTRL, CC_CTRL, CC_CTRL, CC_CTRL,
+    CC_CTRL, CC_TAB_CR, CC_NEWLINE, CC_CTRL, CC_CTRL, CC_TAB_CR, CC_CTRL, CC_CTRL,
+    /* 0x10 - 0x1f */
+    CC_CTRL, CC_CTRL, CC_CTRL, CC_CTRL, CC_CTRL, CC_CTRL, CC_CTRL, CC_CTRL,
+    CC_CTRL, CC_CTRL, CC_CTRL, CC_CTRL, CC_CTRL, CC_CTRL, CC_CTRL, CC_OTHER,
+    /* 0x20 - 0x2f */
+    CC_SPACE, CC_OTHER, CC_QUOTE, CC_HASH, CC_OTHER, CC_OTHER, CC_OTHER, CC_OTHER,
+    CC_LPAR, CC_RPAR, CC_STAR, CC_PLUS, CC_COMMA, CC_MINUS, CC_DOT, CC_SLASH,
+    /* 0x30 - 0x3f */
+    CC_D01, CC_D01, CC_D2, CC_D34, CC_D34, CC_D5, CC_D69, CC_D69,
+    CC_D69, CC_D69, CC_COLON, CC_OTHER, CC_LESS, CC_EQUAL, CC_GREATER, CC_OTHER,
+    /* 0x40 - 0x4f */
+    CC_OTHER, CC_HEX, CC_HEX, CC_HEX, CC_HEX, CC_EXP, CC_HEX, CC_LETTER,
+    CC_LETTER, CC_LETTER, CC_LETTER, CC_LETTER, CC_LETTER, CC_LETTER, CC_LETTER, CC_LETTER,
+    /* 0x50 - 0x5f */
+    CC_LETTER, CC_LETTER, CC_LETTER, CC_LETTER, CC_LETTER, CC_LETTER, CC_LETTER, CC_LETTER,
+    CC_LETTER, CC_LETTER, CC_LETTER, CC_LBRACKET, CC_BACKSLASH, CC_RBRACKET, CC_OTHER, CC_LETTER,
+    /* 0x60 - 0x6f */
+    CC_OTHER, CC_HEX, CC_HEX, CC_HEX, CC_HEX, CC_EXP, CC_HEX, CC_LETTER,
+    CC_LETTER, CC_LETTER, CC_LETTER, CC_LETTER, CC_LETTER, CC_LETTER, CC_ESC, CC_LETTER,
+    /* 0x70 - 0x7f */
+    CC_LETTER, CC_LETTER, CC_LETTER, CC_LETTER, CC_ESC, CC_LETTER, CC_LETTER, CC_LETTER,
+    CC_X, CC_LETTER, CC_LETTER, CC_OTHER, CC_OTHER, CC_OTHER, CC_TILDE, CC_OTHER,
+    /* 0x80 - 0x8f */
+    CC_HIGH, CC_HIGH, CC_HIGH, CC_HIGH, CC_HIGH, CC_HIGH, CC_HIGH, CC_HIGH,
+    CC_HIGH, CC_HIGH, CC_HIGH, CC_HIGH, CC_HIGH, CC_HIGH, CC_HIGH, CC_HIGH,
+    /* 0x90 - 0x9f */
+    CC_HIGH, CC_HIGH, CC_HIGH, CC_HIGH, CC_HIGH, CC_HIGH, CC_HIGH, CC_HIGH,
+    CC_HIGH, CC_HIGH, CC_HIGH, CC_HIGH, CC_HIGH, CC_HIGH, CC_HIGH, CC_HIGH,
+    /* 0xa0 - 0xaf */
+    CC_HIGH, CC_HIGH, CC_HIGH, CC_HIGH, CC_HIGH, CC_HIGH, CC_HIGH, CC_HIGH,
+    CC_HIGH, CC_HIGH, CC_HIGH, CC_HIGH, CC_HIGH, CC_HIGH, CC_HIGH, CC_HIGH,
+    /* 0xb0 - 0xbf */
+    CC_HIGH, CC_HIGH, CC_HIGH, CC_HIGH, CC_HIGH, CC_HIGH, CC_HIGH, CC_HIGH,
+    CC_HIGH, CC_HIGH, CC_HIGH, CC_HIGH, CC_HIGH, CC_HIGH, CC_HIGH, CC_HIGH,
+    /* 0xc0 - 0xcf */
+    CC_HIGH, CC_HIGH, CC_HIGH, CC_HIGH, CC_HIGH, CC_HIGH, CC_HIGH, CC_HIGH,
+    CC_HIGH, CC_HIGH, CC_HIGH, CC_HIGH, CC_HIGH, CC_HIGH, CC_HIGH, CC_HIGH,
+    /* 0xd0 - 0xdf */
+    CC_HIGH, CC_HIGH, CC_HIGH, CC_HIGH, CC_HIGH, CC_HIGH, CC_HIGH, CC_HIGH,
+    CC_HIGH, CC_HIGH, CC_HIGH, CC_HIGH, CC_HIGH, CC_HIGH, CC_HIGH, CC_HIGH,
+    /* 0xe0 - 0xef */
+    CC_HIGH, CC_HIGH, CC_HIGH, CC_HIGH, CC_HIGH, CC_HIGH, CC_HIGH, CC_HIGH,
+    CC_HIGH, CC_HIGH, CC_HIGH, CC_HIGH, CC_HIGH, CC_HIGH, CC_HIGH, CC_HIGH,
+    /* 0xf0 - 0xff */
+    CC_HIGH, CC_HIGH, CC_HIGH, CC_HIGH, CC_HIGH, CC_HIGH, CC_HIGH, CC_HIGH,
+    CC_HIGH, CC_HIGH, CC_HIGH, CC_HIGH, CC_HIGH, CC_HIGH, CC_HIGH, CC_EOF,
+};
+
+/**
+ * @brief Transitions taken when the table below does not list the class for the state.
+ */
+static const transition_s default_transitions[STATE_COUNT] = {
+    [STATE_START] = ERROR,
+    [STATE_ID_OR_KEYWORD] = EMIT_UNGET(TOKEN_ID),
+    [STATE_INT] = EMIT_UNGET(TOKEN_INT),
+    [STATE_DOT] = ERROR,
+    [STATE_NUMBER] = EMIT_UNGET(TOKEN_NUMBER),
+    [STATE_EXP_NUMBER] = EMIT_UNGET(TOKEN_NUMBER),
+    [STATE_EXPONENT] = ERROR,
+    [STATE_STRING_START] = SPAN(STATE_STRING_START),
+    [STATE_STRING_ESCAPE] = ERROR,
+    [STATE_STRING_ESCAPE_FIRST_ZERO_ONE] = ERROR,
+    [STATE_STRING_ESCAPE_FIRST_TWO] = ERROR,
+    [STATE_STRING_ESCAPE_SECOND_ZERO_TO_FOUR] = ERROR,
+    [STATE_STRING_ESCAPE_SECOND_ZERO_TO_NINE] = ERROR,
+    [STATE_STRING_ESCAPE_SECOND_FIVE] = ERROR,
+    [STATE_STRING_ESCAPE_HEX_FIRST] = ERROR,
+    [STATE_STRING_ESCAPE_HEX_SECOND] = ERROR,
+    [STATE_EQUAL_OR_DECLAR] = EMIT_UNGET(TOKEN_DECLAR),
+    [STATE_LESS_THAN_OR_LESS_EQUAL] = EMIT_UNGET(TOKEN_LESS_THAN),
+    [STATE_GREATER_THAN_OR_GREATER_EQUAL] = EMIT_UNGET(TOKEN_GREATER_THAN),
+    [STATE_NOT_EQUAL] = ERROR,
+    [STATE_CONCAT] = ERROR,
+    [STATE_SUB_OR_COMMENT] = EMIT_UNGET(TOKEN_SUB),
+    [STATE_LINE_OR_BLOCK_COMMENT] = UNGET(STATE_LINE_COMMENT),
+    [STATE_LINE_OR_BLOCK_COMMENT_2] = SPAN(STATE_LINE_COMMENT),
+    [STATE_LINE_COMMENT] = SPAN(STATE_LINE_COMMENT),
+    [STATE_BLOCK_COMMENT] = SPAN(STATE_BLOCK_COMMENT),
+    [STATE_BLOCK_COMMENT_ENDING] = SPAN(STATE_BLOCK_COMMENT),
+    [STATE_DIV_OR_FLOOR_DIV] = EMIT_UNGET(TOKEN_DIVISION),
+};
+
+/**
+ * @brief Transition table of the FSM indexed by the state and the class of the read character.
+ */
+static const transition_s transitions[STATE_COUNT][CC_COUNT] = {
+    [STATE_START] = {
+        LETTERS(NEXT(STATE_ID_OR_KEYWORD)),
+        DIGITS(NEXT(STATE_INT)),
+        [CC_EOF] = EMIT(TOKEN_EOF),
+        [CC_NEWLINE] = NEWLINE(STATE_START),
+        [CC_TAB_CR] = NEXT(STATE_START),
+        [CC_SPACE] = NEXT(STATE_START),
+        [CC_QUOTE] = SPAN(STATE_STRING_START),
+        [CC_PLUS] = EMIT(TOKEN_ADD),
+        [CC_STAR] = EMIT(TOKEN_MUL),
+        [CC_HASH] = EMIT(TOKEN_STRING_LENGTH),
+        [CC_LPAR] = EMIT(TOKEN_LEFT_BRACKET),
+        [CC_RPAR] = EMIT(TOKEN_RIGHT_BRACKET),
+        [CC_COMMA] = EMIT(TOKEN_COMMA),
+        [CC_COLON] = EMIT(TOKEN_COLON),
+        [CC_EQUAL] = NEXT(STATE_EQUAL_OR_DECLAR),
+        [CC_LESS] = NEXT(STATE_LESS_THAN_OR_LESS_EQUAL),
+        [CC_GREATER] = NEXT(STATE_GREATER_THAN_OR_GREATER_EQUAL),
+        [CC_TILDE] = NEXT(STATE_NOT_EQUAL),
+        [CC_MINUS] = NEXT(STATE_SUB_OR_COMMENT),
+        [CC_DOT] = NEXT(STATE_CONCAT),
+        [CC_SLASH] = NEXT(STATE_DIV_OR_FLOOR_DIV),
+    },
+    [STATE_ID_OR_KEYWORD] = {
+        LETTERS(NEXT(STATE_ID_OR_KEYWORD)),
+        DIGITS(NEXT(STATE_ID_OR_KEYWORD)),
+    },
+    [STATE_INT] = {
+        DIGITS(NEXT(STATE_INT)),
+        [CC_EXP] = NEXT(STATE_EXPONENT),
+        [CC_DOT] = NEXT(STATE_DOT),
+    },
+    [STATE_DOT] = {
+        DIGITS(NEXT(STATE_NUMBER)),
+    },
+    [STATE_NUMBER] = {
+        DIGITS(NEXT(STATE_NUMBER)),
+        [CC_EXP] = NEXT(STATE_EXPONENT),
+    },
+    [STATE_EXP_NUMBER] = {
+        DIGITS(NEXT(STATE_EXP_NUMBER)),
+    },
+    [STATE_EXPONENT] = {
+        DIGITS(NEXT(STATE_EXP_NUMBER)),
+        [CC_PLUS] = NEXT(STATE_EXP_NUMBER),
+        [CC_MINUS] = NEXT(STATE_EXP_NUMBER),
+    },
+    [STATE_STRING_START] = {
+        [CC_EOF] = ERROR,
+        [CC_CTRL] = ERROR,
+        [CC_TAB_CR] = ERROR,
+        [CC_NEWLINE] = ERROR,
+        [CC_HIGH] = ERROR,
+        [CC_BACKSLASH] = NEXT(STATE_STRING_ESCAPE),
+        [CC_QUOTE] = EMIT(TOKEN_STRING),
+    },
+    [STATE_STRING_ESCAPE] = {
+        [CC_D01] = NEXT(STATE_STRING_ESCAPE_FIRST_ZERO_ONE),
+        [CC_D2] = NEXT(STATE_STRING_ESCAPE_FIRST_TWO),
+        [CC_ESC] = NEXT(STATE_STRING_START),
+        [CC_QUOTE] = NEXT(STATE_STRING_START),
+        [CC_BACKSLASH] = NEXT(STATE_STRING_START),
+        [CC_X] = NEXT(STATE_STRING_ESCAPE_HEX_FIRST),
+    },
+    [STATE_STRING_ESCAPE_FIRST_ZERO_ONE] = {
+        DIGITS(NEXT(STATE_STRING_ESCAPE_SECOND_ZERO_TO_NINE)),
+    },
+    [STATE_STRING_ESCAPE_FIRST_TWO] = {
+        [CC_D01] = NEXT(STATE_STRING_ESCAPE_SECOND_ZERO_TO_FOUR),
+        [CC_D2] = NEXT(STATE_STRING_ESCAPE_SECOND_ZERO_TO_FOUR),
+        [CC_D34] = NEXT(STATE_STRING_ESCAPE_SECOND_ZERO_TO_FOUR),
+        [CC_D5] = NEXT(STATE_STRING_ESCAPE_SECOND_FIVE),
+    },
+    [STATE_STRING_ESCAPE_SECOND_ZERO_TO_FOUR] = {
+        DIGITS(NEXT(STATE_STRING_START)),
+    },
+    [STATE_STRING_ESCAPE_SECOND_ZERO_TO_NINE] = {
+        DIGITS(NEXT(STATE_STRING_START)),
+    },
+    [STATE_STRING_ESCAPE_SECOND_FIVE] = {
+        [CC_D01] = NEXT(STATE_STRING_START),
+        [CC_D2] = NEXT(STATE_STRING_START),
+        [CC_D34] = NEXT(STATE_STRING_START),
+        [CC_D5] = NEXT(STATE_STRING_START),
+    },
+    [STATE_STRING_ESCAPE_HEX_FIRST] = {
+        DIGITS(NEXT(STATE_STRING_ESCAPE_HEX_SECOND)),
+        [CC_EXP] = NEXT(STATE_STRING_ESCAPE_HEX_SECOND),
+        [CC_HEX] = NEXT(STATE_STRING_ESCAPE_HEX_SECOND),
+    },
+    [STATE_STRING_ESCAPE_HEX_SECOND] = {
+        DIGITS(NEXT(STATE_STRING_START)),
+        [CC_EXP] = NEXT(STATE_STRING_START),
+        [CC_HEX] = NEXT(STATE_STRING_START),
+    },
+    [STATE_EQUAL_OR_DECLAR] = {
+        [CC_EQUAL] = EMIT(TOKEN_EQUAL),
+    },
+    [STATE_LESS_THAN_OR_LESS_EQUAL] = {
+        [CC_EQUAL] = EMIT(TOKEN_LESS_EQUAL_THAN),
+    },
+    [STATE_GREATER_THAN_OR_GREATER_EQUAL] = {
+        [CC_EQUAL] = EMIT(TOKEN_GREATER_EQUAL_THAN),
+    },
+    [STATE_NOT_EQUAL] = {
+        [CC_EQUAL] = EMIT(TOKEN_NOT_EQUAL_TO),
+    },
+    [STATE_CONCAT] = {
+        [CC_DOT] = EMIT(TOKEN_STRING_CONCAT),
+    },
+    [STATE_SUB_OR_COMMENT] = {
+        [CC_MINUS] = NEXT(STATE_LINE_OR_BLOCK_COMMENT),
+    },
+    [STATE_LINE_OR_BLOCK_COMMENT] = {
+        [CC_LBRACKET] = NEXT(STATE_LINE_OR_BLOCK_COMMENT_2),
+    },
+    [STATE_LINE_OR_BLOCK_COMMENT_2] = {
+        [CC_LBRACKET] = SPAN(STATE_BLOCK_COMMENT),
+    },
+    [STATE_LINE_COMMENT] = {
+        [CC_NEWLINE] = UNGET(STATE_START),
+        [CC_EOF] = UNGET(STATE_START),
+    },
+    [STATE_BLOCK_COMMENT] = {
+        [CC_RBRACKET] = NEXT(STATE_BLOCK_COMMENT_ENDING),
+        [CC_NEWLINE] = COMMENT_NEWLINE(STATE_BLOCK_COMMENT),
+        [CC_EOF] = ERROR,
+    },
+    [STATE_BLOCK_COMMENT_ENDING] = {
+        [CC_RBRACKET] = NEXT(STATE_START),
+    },
+    [STATE_DIV_OR_FLOOR_DIV] = {
+        [CC_SLASH] = EMIT(TOKEN_FLOOR_DIVISION),
+    },
+};
+static char *keywords[] = { "do", "else", "end", "function", "global", "if", "integer", "local",
+    "nil", "number", "require", "return", "string", "then", "while", "" };
+
+char *keyword_to_string(Keyword keyword) { return keywords[keyword]; }
+
+/**
+ * @brief Find out which keyword the word is. Candidates are chosen by the length and the first
+ * character so at most one string comparison is done.
+ *
+ * @param[in] word The identifier or keyword to check.
+ * @param[in] len Length of the @p word.
+ *
+ * @return The keyword. NO_KEYWORD if the word is an identifier.
+ */
+static Keyword keyword_lookup(const char *word, unsigned len)
 {
-    char *keywords[] = { "do", "else", "end", "function", "global", "if", "integer", "local", "nil",
-        "number", "require", "return", "string", "then", "while" };
+    Keyword candidate = NO_KEYWORD;
 
-    for (int i = 0; i < 15; i++) {
-        if (!strcmp(word, keywords[i])) {
-            return true;
+    switch (len) {
+    case 2:
+        candidate = word[0] == 'd' ? DO : word[0] == 'i' ? IF : NO_KEYWORD;
+        break;
+    case 3:
+        candidate = word[0] == 'e' ? END : word[0] == 'n' ? NIL : NO_KEYWORD;
+        break;
+    case 4:
+        candidate = word[0] == 'e' ? ELSE : word[0] == 't' ? THEN : NO_KEYWORD;
+        break;
+    case 5:
+        candidate = word[0] == 'l' ? LOCAL : word[0] == 'w' ? WHILE : NO_KEYWORD;
+        break;
+    case 6:
+        switch (word[0]) {
+        case 'g':
+            candidate = GLOBAL;
+            break;
+        case 'n':
+            candidate = NUMBER;
+            break;
+        case 'r':
+            candidate = RETURN;
+            break;
+        case 's':
+            candidate = STRING;
+            break;
         }
+        break;
+    case 7:
+        candidate = word[0] == 'i' ? INTEGER : word[0] == 'r' ? REQUIRE : NO_KEYWORD;
+        break;
+    case 8:
+        candidate = FUNCTION;
+        break;
     }
 
-    return false;
+    if (candidate != NO_KEYWORD && memcmp(word, keywords[candidate], len)) {
+        candidate = NO_KEYWORD;
+    }
+    return candidate;
 }
 
-tstack_s token_stack;
+/**
+ * @brief Read the whole file descriptor into a growable heap buffer. Used for pipes and terminals.
+ *
+ * @param[in,out] ctx Context of the compilation.
+ * @param[in] fd File descriptor to read until end of file.
+ *
+ * @return RC_OK on success. RC_INTERNAL_ERR if reading failed.
+ */
+static rc_e source_read(context_s *ctx, int fd)
+{
+    size_t limit = 4096;
+    ssize_t got;
+
+    ctx->source.content = malloc(limit);
+    ALLOC_CHECK(ctx->source.content);
+    ctx->source.size = 0;
+    ctx->source.mapped = false;
 
-void initialize_scanner() { tstack_init(&token_stack); }
+    while ((got = read(fd, ctx->source.content + ctx->source.size, limit - ctx->source.size))
+        != 0) {
+        if (got < 0) {
+            fputs("Reading of the source file failed.\n", stderr);
+            return RC_INTERNAL_ERR;
+        }
+        ctx->source.size += got;
+        if (ctx->source.size == limit) {
+            limit = 2 * limit;
+            ctx->source.content = realloc(ctx->source.content, limit);
+            ALLOC_CHECK(ctx->source.content);
+        }
+    }
 
-void unget_token(T_token *token) { tstack_push(&token_stack, token); }
+    return RC_OK;
+}
 
-T_token *get_next_token()
+/**
+ * @brief Load the whole source file into memory. Regular files are mapped, anything else is read.
+ *
+ * @param[in,out] ctx Context of the compilation.
+ * @param[in] fd File descriptor of the source file.
+ *
+ * @return RC_OK on success. RC_INTERNAL_ERR if the file could not be loaded.
+ */
+static rc_e source_load(context_s *ctx, int fd)
 {
-    if (!tstack_empty(&token_stack)) {
-        T_token *result = tstack_top(&token_stack);
-        tstack_pop(&token_stack, false);
+    struct stat st;
+    void *mapping;
 
-        return result;
+    /* Only map regular files read from their very beginning */
+    if (fstat(fd, &st) || !S_ISREG(st.st_mode) || st.st_size == 0
+        || lseek(fd, 0, SEEK_CUR) != 0) {
+        return source_read(ctx, fd);
     }
 
-    static int curr_line = 1;
-    // initializce dynamic string str
+    mapping = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapping == MAP_FAILED) {
+        return source_read(ctx, fd);
+    }
+    posix_madvise(mapping, st.st_size, POSIX_MADV_SEQUENTIAL);
 
-    T_token *token = malloc(sizeof(T_token));
-    ALLOC_CHECK(token);
-    token_init(token);
+    ctx->source.content = mapping;
+    ctx->source.size = st.st_size;
+    ctx->source.mapped = true;
+    return RC_OK;
+}
 
-    token->line = curr_line;
-    dynamic_string_s *str = token->value;
+/**
+ * @brief Get next character of the source. Mimics getc so that the FSM stays the same.
+ *
+ * @param[in,out] ctx Context of the compilation.
+ *
+ * @return The next character. EOF when the whole source was read.
+ */
+static inline int source_getc(context_s *ctx)
+{
+    return ctx->cursor < ctx->source_end ? *ctx->cursor++ : EOF;
+}
 
-    // first, state is at the start
-    State state = STATE_START;
+/**
+ * @brief Return the character to the source. Mimics ungetc so returning EOF does nothing.
+ *
+ * @param[in,out] ctx Context of the compilation.
+ * @param[in] c The character that was last read.
+ */
+static inline void source_ungetc(context_s *ctx, char c)
+{
+    if (c != EOF) {
+        ctx->cursor--;
+    }
+}
 
-    char c;
-    while (1) {
-        c = getc(stdin);
-        // switch statement for FSM
-        switch (state) {
-        case (STATE_START):
-            if (isalpha(c) || c == '_') {
-                ds_add_char(str, c);
-                state = STATE_ID_OR_KEYWORD;
-            }
-            // with whitespaces we go back to start
-            else if (c == '\n' || c == '\t' || c == '\r' || c == ' ' || c == EOF) {
-                if (c == '\n') {
-                    curr_line++;
-                    token->line = curr_line;
-                } else if (c == EOF) {
-                    token->type = TOKEN_EOF;
-                    return token;
-                }
-                state = STATE_START;
-            } else if (isdigit(c)) {
-                ds_add_char(str, c);
-                state = STATE_INT;
-            } else if (c == '"') {
-                state = STATE_STRING_START;
-            } else if (c == '+') {
-                token->type = TOKEN_ADD;
-                return token;
-            } else if (c == '*') {
-                token->type = TOKEN_MUL;
-                return token;
-            } else if (c == '#') {
-                token->type = TOKEN_STRING_LENGTH;
-                return token;
-            } else if (c == '(') {
-                token->type = TOKEN_LEFT_BRACKET;
-                return token;
-            } else if (c == ')') {
-                token->type = TOKEN_RIGHT_BRACKET;
-                return token;
-            } else if (c == ',') {
-                token->type = TOKEN_COMMA;
-                return token;
-            } else if (c == ':') {
-                token->type = TOKEN_COLON;
-                return token;
-            } else if (c == '=') {
-                state = STATE_EQUAL_OR_DECLAR;
-            } else if (c == '<') {
-                state = STATE_LESS_THAN_OR_LESS_EQUAL;
-            } else if (c == '>') {
-                state = STATE_GREATER_THAN_OR_GREATER_EQUAL;
-            } else if (c == '~') {
-                state = STATE_NOT_EQUAL;
-            } else if (c == '-') {
-                state = STATE_SUB_OR_COMMENT;
-            } else if (c == '.') {
-                state = STATE_CONCAT;
-            } else if (c == '/') {
-                state = STATE_DIV_OR_FLOOR_DIV;
-            } else {
-                exit(RC_LEX_ERR);
-            }
+#if defined(__AVX2__)
+#define SIMD_WIDTH 32
+typedef __m256i simd_t;
+#define simd_load(p) _mm256_loadu_si256((const simd_t *)(p))
+#define simd_set(c) _mm256_set1_epi8(c)
+#define simd_eq(a, b) _mm256_cmpeq_epi8(a, b)
+#define simd_less(a, b) _mm256_cmpgt_epi8(b, a)
+#define simd_or(a, b) _mm256_or_si256(a, b)
+#define simd_mask(v) ((unsigned)_mm256_movemask_epi8(v))
+#elif defined(__SSE2__)
+#define SIMD_WIDTH 16
+typedef __m128i simd_t;
+#define simd_load(p) _mm_loadu_si128((const simd_t *)(p))
+#define simd_set(c) _mm_set1_epi8(c)
+#define simd_eq(a, b) _mm_cmpeq_epi8(a, b)
+#define simd_less(a, b) _mm_cmplt_epi8(a, b)
+#define simd_or(a, b) _mm_or_si128(a, b)
+#define simd_mask(v) ((unsigned)_mm_movemask_epi8(v))
+#endif
 
-            break;
-        case STATE_ID_OR_KEYWORD:
-            if (isalpha(c) || isdigit(c) || c == '_') {
-                ds_add_char(str, c);
-            } else {
-                if (is_keyword(str->content)) {
-                    token->type = TOKEN_KEYWORD;
-                } else {
-                    token->type = TOKEN_ID;
-                }
+/**
+ * @brief Skip the body of a line comment up to the newline or a 0xff byte.
+ *
+ * @param[in] p Where to start skipping.
+ * @param[in] end End of the source.
+ *
+ * @return Position of the first character the FSM has to read.
+ */
+static const char *skip_line_comment(const char *p, const char *end)
+{
+#ifdef SIMD_WIDTH
+    const simd_t newline = simd_set('\n'), eof = simd_set(EOF);
 
-                ungetc(c, stdin);
+    for (; end - p >= SIMD_WIDTH; p += SIMD_WIDTH) {
+        simd_t block = simd_load(p);
+        unsigned stop = simd_mask(simd_or(simd_eq(block, newline), simd_eq(block, eof)));
+        if (stop) {
+            return p + __builtin_ctz(stop);
+        }
+    }
+#endif
+    while (p < end && *p != '\n' && *p != EOF) {
+        p++;
+    }
+    return p;
+}
 
-                return token;
-            }
+/**
+ * @brief Skip the body of a block comment up to ']' or a 0xff byte, counting the skipped lines.
+ *
+ * @param[in] p Where to start skipping.
+ * @param[in] end End of the source.
+ * @param[in,out] lines Line counter to increase by the number of skipped newlines.
+ *
+ * @return Position of the first character the FSM has to read.
+ */
+static const char *skip_block_comment(const char *p, const char *end, int *lines)
+{
+#ifdef SIMD_WIDTH
+    const simd_t newline = simd_set('\n'), bracket = simd_set(']'), eof = simd_set(EOF);
 
-            break;
-        case STATE_INT:
-            if (isdigit(c)) {
-                state = STATE_INT;
-                ds_add_char(str, c);
-            } else if (c == 'e' || c == 'E') {
-                state = STATE_EXPONENT;
-                ds_add_char(str, c);
-            } else if (c == '.') {
-                state = STATE_DOT;
-                ds_add_char(str, c);
-            } else {
-                token->type = TOKEN_INT;
-                token->symbol_type = SYM_TYPE_INT;
-                ungetc(c, stdin);
-
-                return token;
-            }
+    for (; end - p >= SIMD_WIDTH; p += SIMD_WIDTH) {
+        simd_t block = simd_load(p);
+        unsigned newlines = simd_mask(simd_eq(block, newline));
+        unsigned stop = simd_mask(simd_or(simd_eq(block, bracket), simd_eq(block, eof)));
+        if (stop) {
+            /* Only count the newlines before the stopping character */
+            *lines += __builtin_popcount(newlines & ((stop & -stop) - 1));
+            return p + __builtin_ctz(stop);
+        }
+        *lines += __builtin_popcount(newlines);
+    }
+#endif
+    for (; p < end && *p != ']' && *p != EOF; p++) {
+        if (*p == '\n') {
+            (*lines)++;
+        }
+    }
+    return p;
+}
 
-            break;
-        case STATE_DOT:
-            if (isdigit(c)) {
-                state = STATE_NUMBER;
-                ds_add_char(str, c);
-            } else {
-                exit(RC_LEX_ERR);
-            }
+/**
+ * @brief Skip ordinary characters of a string literal. Stops at the quote, backslash and at any
+ * control or non-ASCII byte.
+ *
+ * @param[in] p Where to start skipping.
+ * @param[in] end End of the source.
+ *
+ * @return Position of the first character the FSM has to read.
+ */
+static const char *skip_string(const char *p, const char *end)
+{
+#ifdef SIMD_WIDTH
+    const simd_t quote = simd_set('"'), backslash = simd_set('\\'), space = simd_set(' ');
 
-            break;
-        case STATE_EXPONENT:
-            if (isdigit(c) || c == '+' || c == '-') {
-                state = STATE_EXP_NUMBER;
-                ds_add_char(str, c);
-            } else {
-                exit(RC_LEX_ERR);
-            }
+    for (; end - p >= SIMD_WIDTH; p += SIMD_WIDTH) {
+        simd_t block = simd_load(p);
+        /* Signed comparison, so bytes 0x80 to 0xff are below the space too */
+        unsigned stop = simd_mask(simd_or(
+            simd_less(block, space), simd_or(simd_eq(block, quote), simd_eq(block, backslash))));
+        if (stop) {
+            return p + __builtin_ctz(stop);
+        }
+    }
+#endif
+    while (p < end && (signed char)*p >= ' ' && *p != '"' && *p != '\\') {
+        p++;
+    }
+    return p;
+}
 
-            break;
-        case STATE_NUMBER:
-            if (isdigit(c)) {
-                state = STATE_NUMBER;
-                ds_add_char(str, c);
-            } else if (c == 'e' || c == 'E') {
-                state = STATE_EXPONENT;
-                ds_add_char(str, c);
-            } else {
-                token->type = TOKEN_NUMBER;
-                token->symbol_type = SYM_TYPE_NUMBER;
-                ungetc(c, stdin);
-
-                return token;
-            }
+/**
+ * @brief Skip characters of a scanned string literal that IFJcode21 takes as they are. Stops at
+ * whitespace, control characters, '#' and backslash.
+ *
+ * @param[in] p Where to start skipping.
+ * @param[in] end End of the string literal.
+ *
+ * @return Position of the first character that has to be escaped or decoded.
+ */
+static const char *skip_plain(const char *p, const char *end)
+{
+#ifdef SIMD_WIDTH
+    const simd_t hash = simd_set('#'), backslash = simd_set('\\'), printable = simd_set('!'),
+                 del = simd_set(127);
 
-            break;
-        case STATE_EXP_NUMBER:
-            if (isdigit(c)) {
-                state = STATE_EXP_NUMBER;
-                ds_add_char(str, c);
-            } else {
-                token->type = TOKEN_NUMBER;
-                token->symbol_type = SYM_TYPE_NUMBER;
-                ungetc(c, stdin);
-
-                return token;
-            }
+    for (; end - p >= SIMD_WIDTH; p += SIMD_WIDTH) {
+        simd_t block = simd_load(p);
+        /* The automaton lets only ASCII characters into a string, signed comparison is enough */
+        unsigned stop = simd_mask(simd_or(simd_or(simd_less(block, printable), simd_eq(block, del)),
+            simd_or(simd_eq(block, hash), simd_eq(block, backslash))));
+        if (stop) {
+            return p + __builtin_ctz(stop);
+        }
+    }
+#endif
+    while (p < end && *p > ' ' && *p < 127 && *p != '#' && *p != '\\') {
+        p++;
+    }
+    return p;
+}
 
-            break;
-        case STATE_STRING_START:
-            if (c == '\n') {
-                exit(RC_LEX_ERR);
-            } else if (c == '\\') {
-                state = STATE_STRING_ESCAPE;
-                ds_add_char(str, c);
-            } else if (c == '"') {
-                token->type = TOKEN_STRING;
-                token->symbol_type = SYM_TYPE_STRING;
-                return token;
-            } else if (c >= 31) {
-                state = STATE_STRING_START;
-                ds_add_char(str, c);
-            } else {
-                exit(RC_LEX_ERR);
-            }
+/**
+ * @brief Skip the characters the state would consume without leaving it. Counts the newlines
+ * skipped inside block comments.
+ *
+ * @param[in,out] ctx Context of the compilation.
+ * @param[in] state State entered by the FSM.
+ */
+static void skip_span(context_s *ctx, State state)
+{
+    switch (state) {
+    case STATE_LINE_COMMENT:
+        ctx->cursor = skip_line_comment(ctx->cursor, ctx->source_end);
+        break;
+    case STATE_BLOCK_COMMENT:
+        ctx->cursor = skip_block_comment(ctx->cursor, ctx->source_end, &ctx->line);
+        break;
+    case STATE_STRING_START:
+        ctx->cursor = skip_string(ctx->cursor, ctx->source_end);
+        break;
+    default:
+        break;
+    }
+}
 
-            break;
-        case STATE_STRING_ESCAPE:
-            if (c == '0' || c == '1') {
-                state = STATE_STRING_ESCAPE_FIRST_ZERO_ONE;
-                ds_add_char(str, c);
-            } else if (c == '2') {
-                state = STATE_STRING_ESCAPE_FIRST_TWO;
-                ds_add_char(str, c);
-            } else if (c == 'n' || c == 't' || c == '"' || c == '\\') {
-                state = STATE_STRING_START;
-                ds_add_char(str, c);
-            } else if (c == 'x') {
-                state = STATE_STRING_ESCAPE_HEX_FIRST;
-                ds_add_char(str, c);
-            } else {
-                exit(RC_LEX_ERR);
-            }
+rc_e initialize_scanner(context_s *ctx, const char *path)
+{
+    rc_e ret;
+    int fd = STDIN_FILENO;
 
-            break;
-        case STATE_STRING_ESCAPE_FIRST_TWO:
-            if (c == '5') {
-                state = STATE_STRING_ESCAPE_SECOND_FIVE;
-                ds_add_char(str, c);
-            } else if (c >= '0' && c <= '4') {
-                state = STATE_STRING_ESCAPE_SECOND_ZERO_TO_FOUR;
-                ds_add_char(str, c);
-            } else {
-                exit(RC_LEX_ERR);
-            }
+    ctx->lookahead_first = 0;
+    ctx->lookahead_count = 0;
+    ctx->line = 1;
+    ctx->lex_error = NULL;
+    memset(&ctx->stream, 0, sizeof ctx->stream);
+    intern_init(&ctx->names);
+    arena_init(&ctx->literals);
+    token_pool_init(&ctx->tokens);
 
-            break;
-        case STATE_STRING_ESCAPE_FIRST_ZERO_ONE:
-            if (isdigit(c)) {
-                state = STATE_STRING_ESCAPE_SECOND_ZERO_TO_NINE;
-                ds_add_char(str, c);
-            } else {
-                exit(RC_LEX_ERR);
-            }
+    if (path) {
+        fd = open(path, O_RDONLY);
+        if (fd < 0) {
+            fprintf(stderr, "Could not open the source file: %s\n", path);
+            return RC_INTERNAL_ERR;
+        }
+    }
 
-            break;
-        case STATE_STRING_ESCAPE_SECOND_FIVE:
-            if (c >= '0' && c <= '5') {
-                state = STATE_STRING_START;
-                ds_add_char(str, c);
-            } else {
-                exit(RC_LEX_ERR);
-            }
+    ret = source_load(ctx, fd);
+    if (path) {
+        close(fd);
+    }
 
-            break;
+    ctx->cursor = ctx->source.content;
+    ctx->source_end = ctx->source.content + ctx->source.size;
+    return ret;
+}
+
+void destroy_scanner(context_s *ctx)
+{
+    /* Tokens still read ahead are freed together with the pool */
+    ctx->lookahead_count = 0;
+    token_pool_destroy(&ctx->tokens);
+
+    FREE(ctx->stream.types);
+    FREE(ctx->stream.keywords);
+    FREE(ctx->stream.handles);
+    FREE(ctx->stream.lines);
+    memset(&ctx->stream, 0, sizeof ctx->stream);
+    intern_destroy(&ctx->names);
+    arena_destroy(&ctx->literals);
+
+    if (ctx->source.mapped) {
+        munmap(ctx->source.content, ctx->source.size);
+    } else {
+        FREE(ctx->source.content);
+    }
+    ctx->source.content = NULL;
+    ctx->source.size = 0;
+    ctx->cursor = ctx->source_end = NULL;
+}
+
+/**
+ * @brief Add a character to a string in the IFJcode21 encoding.
+ *
+ * @param[in,out] value String to add the character to.
+ * @param[in] c The character.
+ */
+static void encode_char(dynamic_string_s *value, unsigned char c)
+{
+    char escaped[4] = { '\\', '0' + c / 100, '0' + c / 10 % 10, '0' + c % 10 };
+
+    if (c > ' ' && c < 127 && c != '#' && c != '\\') {
+        ds_add_char(value, c);
+    } else {
+        ds_append(value, escaped, sizeof escaped);
+    }
+}
+
+/**
+ * @brief Get the value of a hexadecimal digit.
+ *
+ * @param[in] c The digit.
+ *
+ * @return Value of the digit.
+ */
+static unsigned hex_digit(char c)
+{
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    return (c | 0x20) - 'a' + 10;
+}
+
+/**
+ * @brief Store a null terminated copy of a text in the arena of literals.
+ *
+ * @param[in,out] ctx Context of the compilation.
+ * @param[in] text The text, need not be null terminated.
+ * @param[in] length Length of the text.
+ *
+ * @return The copy. Valid until the scanner is destroyed.
+ */
+static const char *store_text(context_s *ctx, const char *text, unsigned length)
+{
+    char *copy = arena_alloc(&ctx->literals, length + 1);
+
+    memcpy(copy, text, length);
+    copy[length] = '\0';
+    return copy;
+}
+
+/**
+ * @brief Decode the escape sequences of a string literal and encode it for IFJcode21. Runs of
+ * characters that need no change are copied at once.
+ *
+ * @param[in,out] ctx Context of the compilation.
+ * @param[in,out] literal String literal with the lexeme set to the content of the literal.
+ */
+static void encode_string(context_s *ctx, token_literal_s *literal)
+{
+    const char *p = literal->lexeme, *end = p + literal->length, *plain;
+    dynamic_string_s value;
+    unsigned char c;
+
+    if (skip_plain(p, end) == end) {
+        literal->text = store_text(ctx, literal->lexeme, literal->length);
+        return;
+    }
 
-        case STATE_STRING_ESCAPE_SECOND_ZERO_TO_FOUR:
-            if (isdigit(c)) {
-                state = STATE_STRING_START;
-                ds_add_char(str, c);
-            } else {
-                exit(RC_LEX_ERR);
-            }
+    ds_init(&value);
 
+    while (p < end) {
+        plain = skip_plain(p, end);
+        ds_append(&value, p, plain - p);
+        if (plain == end) {
             break;
-        case STATE_STRING_ESCAPE_SECOND_ZERO_TO_NINE:
-            if (isdigit(c)) {
-                state = STATE_STRING_START;
-                ds_add_char(str, c);
-            } else {
-                exit(RC_LEX_ERR);
-            }
+        }
+
+        p = plain;
+        if (*p != '\\') {
+            encode_char(&value, *p++);
+            continue;
+        }
 
+        /* The automaton only accepts valid escape sequences */
+        switch (*++p) {
+        case 'n':
+            c = '\n';
+            p++;
             break;
-        case STATE_STRING_ESCAPE_HEX_FIRST:
-            if (isdigit(c) || (c >= 'A' && c <= 'F') || (c >= 'a' && c <= 'f')) {
-                state = STATE_STRING_ESCAPE_HEX_SECOND;
-                ds_add_char(str, c);
-            } else {
-                exit(RC_LEX_ERR);
-            }
+        case 't':
+            c = '\t';
+            p++;
             break;
-        case STATE_STRING_ESCAPE_HEX_SECOND:
-            if (isdigit(c) || (c >= 'A' && c <= 'F') || (c >= 'a' && c <= 'f')) {
-                state = STATE_STRING_START;
-                ds_add_char(str, c);
-            } else {
-                exit(RC_LEX_ERR);
-            }
+        case 'x':
+            c = hex_digit(p[1]) * 16 + hex_digit(p[2]);
+            p += 3;
             break;
-        case STATE_EQUAL_OR_DECLAR:
-            if (c == '=') {
-                token->type = TOKEN_EQUAL;
-            } else {
-                token->type = TOKEN_DECLAR;
-                ungetc(c, stdin);
-            }
-
-            return token;
-        case STATE_LESS_THAN_OR_LESS_EQUAL:
-            if (c == '=') {
-                token->type = TOKEN_LESS_EQUAL_THAN;
-            } else {
-                token->type = TOKEN_LESS_THAN;
-                ungetc(c, stdin);
-            }
-
-            return token;
-        case STATE_GREATER_THAN_OR_GREATER_EQUAL:
-            if (c == '=') {
-                token->type = TOKEN_GREATER_EQUAL_THAN;
-            } else {
-                token->type = TOKEN_GREATER_THAN;
-                ungetc(c, stdin);
-            }
-
-            return token;
-        case STATE_NOT_EQUAL:
-            if (c == '=') {
-                token->type = TOKEN_NOT_EQUAL_TO;
-                return token;
-            } else {
-                exit(RC_LEX_ERR);
-            }
-
+        case '"':
+        case '\\':
+            c = *p++;
             break;
-        case STATE_DIV_OR_FLOOR_DIV:
-            if (c == '/') {
-                token->type = TOKEN_FLOOR_DIVISION;
-            } else {
-                token->type = TOKEN_DIVISION;
-                ungetc(c, stdin);
-            }
-
-            return token;
-        case STATE_CONCAT:
-            if (c == '.') {
-                token->type = TOKEN_STRING_CONCAT;
-                return token;
-            } else {
-                exit(RC_LEX_ERR);
-            }
-
+        default:
+            c = (p[0] - '0') * 100 + (p[1] - '0') * 10 + (p[2] - '0');
+            p += 3;
             break;
-        case STATE_SUB_OR_COMMENT:
-            if (c == '-') {
-                state = STATE_LINE_OR_BLOCK_COMMENT;
-            } else {
-                token->type = TOKEN_SUB;
-                ungetc(c, stdin);
+        }
+        encode_char(&value, c);
+    }
 
-                return token;
-            }
+    literal->text = store_text(ctx, value.content, value.size);
+    ds_destroy(&value);
+}
 
-            break;
-        case STATE_LINE_OR_BLOCK_COMMENT:
-            if (c == '[') {
-                state = STATE_LINE_OR_BLOCK_COMMENT_2;
-            } else {
-                ungetc(c, stdin);
-                state = STATE_LINE_COMMENT;
-            }
+/**
+ * @brief Get the type of the value of a literal.
+ *
+ * @param[in] type Type of the token.
+ *
+ * @return Type of the literal. SYM_TYPE_NONE if the token is not a literal.
+ */
+static symbol_type_e literal_type(token_type type)
+{
+    switch (type) {
+    case TOKEN_INT:
+        return SYM_TYPE_INT;
+    case TOKEN_NUMBER:
+        return SYM_TYPE_NUMBER;
+    case TOKEN_STRING:
+        return SYM_TYPE_STRING;
+    default:
+        return SYM_TYPE_NONE;
+    }
+}
 
-            break;
-        case STATE_LINE_OR_BLOCK_COMMENT_2:
-            if (c == '[') {
-                state = STATE_BLOCK_COMMENT;
-            } else {
-                state = STATE_LINE_COMMENT;
-            }
+/**
+ * @brief Stop on a lexical error. Jumps to the point set in the context or exits the process.
+ *
+ * @param[in] ctx Context of the compilation.
+ */
+static void lexical_error(context_s *ctx)
+{
+    if (ctx->lex_error) {
+        longjmp(*ctx->lex_error, RC_LEX_ERR);
+    }
+    exit(RC_LEX_ERR);
+}
 
-            break;
-        case STATE_LINE_COMMENT:
-            if (c == '\n' || c == EOF) {
-                state = STATE_START;
-                ungetc(c, stdin);
-            }
+/**
+ * @brief Convert an integer literal. A literal greater than the largest 64-bit integer is a
+ * lexical error, the interpreter could not represent it.
+ *
+ * @param[in] ctx Context of the compilation, used to report the error.
+ * @param[in] lexeme Digits of the literal.
+ * @param[in] length Number of digits.
+ *
+ * @return Value of the literal.
+ */
+static int64_t parse_integer(context_s *ctx, const char *lexeme, unsigned length)
+{
+    uint64_t value = 0;
+    unsigned digit;
 
-            break;
-        case STATE_BLOCK_COMMENT:
-            if (c == ']') {
-                state = STATE_BLOCK_COMMENT_ENDING;
-            } else if (c == '\n') {
-                curr_line++;
-            } else if (c == EOF) {
-                exit(RC_LEX_ERR);
-            }
+    for (unsigned i = 0; i < length; i++) {
+        digit = lexeme[i] - '0';
+        if (value > (UINT64_MAX - digit) / 10) {
+            lexical_error(ctx);
+        }
+        value = value * 10 + digit;
+    }
+    if (value > INT64_MAX) {
+        lexical_error(ctx);
+    }
+    return (int64_t)value;
+}
 
-            break;
-        case STATE_BLOCK_COMMENT_ENDING:
-            if (c == ']') {
-                state = STATE_START;
-            } else {
-                state = STATE_BLOCK_COMMENT;
-            }
+/**
+ * @brief Set the type of a scanned token and the attributes that follow from it.
+ *
+ * @param[in,out] ctx Context of the compilation.
+ * @param[in,out] token The scanned token.
+ * @param[in] type Type of the token.
+ * @param[in] lexeme Start of the token in the source.
+ * @param[in] end End of the token in the source (the first character not belonging to it).
+ *
+ * @return The @p token.
+ */
+static T_token *finish_token(
+    context_s *ctx, T_token *token, token_type type, const char *lexeme, const char *end)
+{
+    token_literal_s *literal;
+
+    token->type = type;
+
+    switch (type) {
+    case TOKEN_ID:
+        token->keyword = keyword_lookup(lexeme, end - lexeme);
+        if (token->keyword != NO_KEYWORD) {
+            token->type = TOKEN_KEYWORD;
+            token->handle.name = keywords[token->keyword];
+        } else {
+            /* Identifiers are compared a lot, all occurrences share one copy of the name */
+            token->handle.name = intern_string(&ctx->names, lexeme, end - lexeme);
+        }
+        return token;
+    case TOKEN_INT:
+    case TOKEN_NUMBER:
+        break;
+    case TOKEN_STRING:
+        lexeme++; /* The opening quote is not part of the value */
+        break;
+    default:
+        return token;
+    }
+
+    /* The value is stored once, all copies of the token share it */
+    literal = arena_alloc(&ctx->literals, sizeof *literal);
+    literal->lexeme = lexeme;
+    literal->length = end - lexeme;
+    literal->value.integer = 0;
 
+    if (type == TOKEN_STRING) {
+        encode_string(ctx, literal);
+    } else {
+        literal->text = store_text(ctx, lexeme, literal->length);
+        if (type == TOKEN_INT) {
+            literal->value.integer = parse_integer(ctx, lexeme, literal->length);
+        } else {
+            literal->value.number = strtod(literal->text, NULL);
+        }
+    }
+
+    token->handle.literal = literal;
+    token->symbol_type = literal_type(type);
+    return token;
+}
+
+/**
+ * @brief Scan the next token from the source.
+ *
+ * @param[in,out] ctx Context of the compilation.
+ * @param[out] token Initialized token to scan into.
+ *
+ * @return The @p token.
+ */
+static T_token *scan_into(context_s *ctx, T_token *token)
+{
+    token->line = ctx->line;
+
+    // first, state is at the start
+    State state = STATE_START;
+    transition_s transition;
+    const char *lexeme = ctx->cursor, *position;
+
+    char c;
+    while (1) {
+        // the token value is everything read after leaving the start state
+        position = ctx->cursor;
+        if (state == STATE_START) {
+            lexeme = position;
+        }
+
+        c = source_getc(ctx);
+        // table lookup for FSM, EOF is read as 0xff
+        transition = transitions[state][char_classes[(unsigned char)c]];
+        if (transition.action == ACT_DEFAULT) {
+            transition = default_transitions[state];
+        }
+
+        switch (transition.action) {
+        case ACT_NEXT:
+            state = transition.target;
+            break;
+        case ACT_SPAN:
+            state = transition.target;
+            skip_span(ctx, state);
+            break;
+        case ACT_UNGET:
+            source_ungetc(ctx, c);
+            state = transition.target;
             break;
+        case ACT_NEWLINE:
+            ctx->line++;
+            token->line = ctx->line;
+            state = transition.target;
+            break;
+        case ACT_COMMENT_NEWLINE:
+            ctx->line++;
+            state = transition.target;
+            break;
+        case ACT_EMIT_UNGET:
+            source_ungetc(ctx, c);
+            return finish_token(ctx, token, transition.target, lexeme, position);
+        case ACT_EMIT:
+            return finish_token(ctx, token, transition.target, lexeme, position);
+        default:
+            lexical_error(ctx);
         }
     }
 
     return token;
 }
+
+/**
+ * @brief Take the next token from the pre-lexed token stream.
+ *
+ * @param[in,out] ctx Context of the compilation.
+ * @param[out] token Initialized token to fill.
+ *
+ * @return The @p token.
+ */
+static T_token *read_stream(context_s *ctx, T_token *token)
+{
+    token_stream_s *stream = &ctx->stream;
+    unsigned i = stream->next;
+
+    /* Lexing stopped on an error, report it once the parser gets there */
+    if (i == stream->count) {
+        lexical_error(ctx);
+    }
+    /* Lexing stops at the first end of file, keep returning it */
+    if (stream->types[i] != TOKEN_EOF) {
+        stream->next++;
+    }
+
+    token->type = stream->types[i];
+    token->keyword = stream->keywords[i];
+    token->line = stream->lines[i];
+    token->handle = stream->handles[i];
+    token->symbol_type = literal_type(token->type);
+
+    return token;
+}
+
+/**
+ * @brief Get a new token from the token stream if the source was lexed up front or scan it from
+ * the source otherwise.
+ *
+ * @param[in,out] ctx Context of the compilation.
+ *
+ * @return Newly allocated token.
+ */
+static T_token *scan_token(context_s *ctx)
+{
+    T_token *token = token_new(&ctx->tokens);
+
+    return ctx->stream.active ? read_stream(ctx, token) : scan_into(ctx, token);
+}
+
+/**
+ * @brief Append a scanned token to the token stream.
+ *
+ * @param[in,out] ctx Context of the compilation.
+ * @param[in] token The token.
+ */
+static void stream_append(context_s *ctx, const T_token *token)
+{
+    token_stream_s *stream = &ctx->stream;
+
+    if (stream->count == stream->capacity) {
+        /* Roughly one token per four characters of source to start with */
+        stream->capacity = stream->capacity ? stream->capacity * 2 : ctx->source.size / 4 + 16;
+        stream->types = realloc(stream->types, stream->capacity * sizeof *stream->types);
+        ALLOC_CHECK(stream->types);
+        stream->keywords = realloc(stream->keywords, stream->capacity * sizeof *stream->keywords);
+        ALLOC_CHECK(stream->keywords);
+        stream->handles = realloc(stream->handles, stream->capacity * sizeof *stream->handles);
+        ALLOC_CHECK(stream->handles);
+        stream->lines = realloc(stream->lines, stream->capacity * sizeof *stream->lines);
+        ALLOC_CHECK(stream->lines);
+    }
+
+    stream->types[stream->count] = token->type;
+    stream->keywords[stream->count] = token->keyword;
+    stream->handles[stream->count] = token->handle;
+    stream->lines[stream->count] = token->line;
+    stream->count++;
+}
+
+void tokenize_source(context_s *ctx)
+{
+    jmp_buf *outer_lex_error = ctx->lex_error;
+    jmp_buf lex_error;
+    T_token token;
+
+    /* The error is only recorded, it is reported once the parser reads up to it */
+    if (setjmp(lex_error)) {
+        ctx->stream.lex_error = true;
+    } else {
+        ctx->lex_error = &lex_error;
+        do {
+            token_init(&token);
+            stream_append(ctx, scan_into(ctx, &token));
+        } while (token.type != TOKEN_EOF);
+    }
+
+    ctx->lex_error = outer_lex_error;
+    ctx->stream.next = 0;
+    ctx->stream.active = true;
+}
+
+T_token *get_next_token(context_s *ctx)
+{
+    T_token *token;
+
+    if (!ctx->lookahead_count) {
+        return scan_token(ctx);
+    }
+
+    token = ctx->lookahead[ctx->lookahead_first];
+    ctx->lookahead_first = (ctx->lookahead_first + 1) % LOOKAHEAD_SIZE;
+    ctx->lookahead_count--;
+    return token;
+}
+
+T_token *peek_token(context_s *ctx, unsigned k)
+{
+    assert(k < LOOKAHEAD_SIZE);
+
+    while (ctx->lookahead_count <= k) {
+        unsigned last = (ctx->lookahead_first + ctx->lookahead_count) % LOOKAHEAD_SIZE;
+        ctx->lookahead[last] = scan_token(ctx);
+        ctx->lookahead_count++;
+    }
+
+    return ctx->lookahead[(ctx->lookahead_first + k) % LOOKAHEAD_SIZE];
+}
+
+void unget_token(context_s *ctx, T_token *token)
+{
+    assert(ctx->lookahead_count < LOOKAHEAD_SIZE);
+
+    ctx->lookahead_first = (ctx->lookahead_first + LOOKAHEAD_SIZE - 1) % LOOKAHEAD_SIZE;
+    ctx->lookahead[ctx->lookahead_first] = token;
+    ctx->lookahead_count++;
+}
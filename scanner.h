@@ -11,49 +11,74 @@
 #define _SCANNER_H_
 
 #include "common.h"
+#include "context.h"
 #include "token_stack.h"
 
-/**
- * @brief Enum for all the keywords.
- */
-typedef enum {
-    DO,
-    ELSE,
-    END,
-    FUNCTION,
-    GLOBAL,
-    IF,
-    INTEGER,
-    LOCAL,
-    NIL,
-    NUMBER,
-    REQUIRE,
-    RETURN,
-    STRING,
-    THEN,
-    WHILE
-} Keyword;
-
 /**
  * @brief Main function of scanner, returns a token
  * as a structure, returns an error code.
  *
+ * @param[in,out] ctx Context of the compilation.
  * @param[in/out] token Token structure for storing information about tokens.
  *
  * @return int Error value.
  */
-T_token *get_next_token();
+T_token *get_next_token(context_s *ctx);
+
+/**
+ * @brief Look at a token ahead without taking it from the scanner.
+ *
+ * @param[in,out] ctx Context of the compilation.
+ * @param[in] k Which token to look at, 0 is the one get_next_token returns next time. Must be less
+ * than LOOKAHEAD_SIZE.
+ *
+ * @return The token. It is still owned by the scanner until get_next_token returns it.
+ */
+T_token *peek_token(context_s *ctx, unsigned k);
 
 /**
  * @brief Ungets a token, so that get_next_token returns it next time it is called.
  *
+ * @param[in,out] ctx Context of the compilation.
  * @param[in] token Token to unget.
  */
-void unget_token(T_token *token);
+void unget_token(context_s *ctx, T_token *token);
 
 /**
- * @brief Initializes the scanner.
+ * @brief Get the keyword as it is written in the source.
+ *
+ * @param[in] keyword The keyword to convert.
+ *
+ * @return The keyword string. Empty string for NO_KEYWORD.
+ */
+char *keyword_to_string(Keyword keyword);
+
+/**
+ * @brief Initializes the scanner. Loads the entire source file into memory, regular files are
+ * mapped and pipes are read into a buffer.
+ *
+ * @param[in,out] ctx Context of the compilation.
+ * @param[in] path Path to the source file. If NULL the source is read from stdin.
+ *
+ * @return RC_OK on success. RC_INTERNAL_ERR if the source file could not be loaded.
+ */
+rc_e initialize_scanner(context_s *ctx, const char *path);
+
+/**
+ * @brief Lexes the entire source up front into the token stream of the context. The scanner then
+ * only reads tokens from the stream, so lexing and parsing can be measured separately. A lexical
+ * error is reported once the parser reads up to the point where it occurred.
+ *
+ * @param[in,out] ctx Context of an initialized scanner nobody has read any tokens from yet.
+ */
+void tokenize_source(context_s *ctx);
+
+/**
+ * @brief Releases the source file, the pool of tokens and the values of literals. All tokens are
+ * freed with the pool and none of them can be used afterwards.
+ *
+ * @param[in,out] ctx Context of the compilation.
  */
-void initialize_scanner();
+void destroy_scanner(context_s *ctx);
 
 #endif
@@ -57,6 +57,8 @@ static char *token_type_to_string(token_type type)
         return "number literal";
     case TOKEN_STRING:
         return "string literal";
+    case TOKEN_BOOL:
+        return "boolean literal";
     case TOKEN_EOF:
         return "end of file";
     case TOKEN_NON_TERMINAL:
@@ -69,15 +71,20 @@ static char *token_type_to_string(token_type type)
 
 void print_unexpected_token(T_token *bad_token, token_type expected_type, char *expected_content)
 {
-    char *unexpected_string = (*bad_token->value->content) == '\0'
-        ? token_type_to_string(bad_token->type)
-        : bad_token->value->content;
+    /* The token as written in the source */
+    const char *unexpected_string;
+    int length = token_lexeme(bad_token, &unexpected_string);
+
+    if (!length) {
+        unexpected_string = token_type_to_string(bad_token->type);
+        length = strlen(unexpected_string);
+    }
     if (*expected_content == '\0') {
-        fprintf(stderr, "Error on line %d: Got unexpected token \"%s\", expected token %s. \n",
-            bad_token->line, unexpected_string, token_type_to_string(expected_type));
+        fprintf(stderr, "Error on line %d: Got unexpected token \"%.*s\", expected token %s. \n",
+            bad_token->line, length, unexpected_string, token_type_to_string(expected_type));
     } else {
-        fprintf(stderr, "Error on line %d: Got unexpected token \"%s\", expected %s %s. \n",
-            bad_token->line, unexpected_string, token_type_to_string(expected_type),
+        fprintf(stderr, "Error on line %d: Got unexpected token \"%.*s\", expected %s %s. \n",
+            bad_token->line, length, unexpected_string, token_type_to_string(expected_type),
             expected_content);
     }
 }
@@ -153,11 +160,11 @@ static bool token_list_types_compatible(tstack_s *first, tstack_s *second)
     return sll_is_active(first) == sll_is_active(second);
 }
 
-bool sem_call_types_compatible(T_token *function, tstack_s *call_params, unsigned line, rc_e *rc)
+bool sem_call_types_compatible(symbol_s *function, tstack_s *call_params, unsigned line, rc_e *rc)
 {
-    if (!token_list_types_compatible(function->fun_info->in_params, call_params)) {
+    if (!token_list_types_compatible(function->fun_info.in_params, call_params)) {
         ERR_MSG("Function call has invalid parameters: ", line);
-        fprintf(stderr, "%s\n", function->value->content);
+        fprintf(stderr, "%s\n", function->name);
         *rc = RC_SEM_CALL_ERR;
         return false;
     }
@@ -165,11 +172,12 @@ bool sem_call_types_compatible(T_token *function, tstack_s *call_params, unsigne
     return true;
 }
 
-bool sem_check_call_function(T_token *token, symtable_s *symtable, T_token **function, rc_e *rc)
+bool sem_check_call_function(
+    T_token *token, symtable_s *symtable, symbol_s **function, rc_e *rc)
 {
-    if (!symtable_search_global(symtable, token->value->content, function)) {
+    if (!symtable_search_global(symtable, token_value(token), function)) {
         ERR_MSG("Use of undefined function: ", token->line);
-        fprintf(stderr, "'%s'\n", token->value->content);
+        fprintf(stderr, "'%s'\n", token_value(token));
         *rc = RC_SEM_UNDEF_ERR;
         return false;
     }
@@ -177,18 +185,18 @@ bool sem_check_call_function(T_token *token, symtable_s *symtable, T_token **fun
 }
 bool sem_check_redecl(T_token *token, symtable_s *symtable, rc_e *rc)
 {
-    T_token *original;
-    if (symtable_search_global(symtable, token->value->content, &original)) {
-        if (original->fun_info->defined) {
+    symbol_s *original;
+    if (symtable_search_global(symtable, token_value(token), &original)) {
+        if (original->fun_info.defined) {
             ERR_MSG("Function declaration follows function definition: ", token->line);
         } else {
             ERR_MSG("Redeclaring already declared function: ", token->line);
         }
 
         if (original->line == -1) {
-            fprintf(stderr, "'%s' is a built-in function.\n", token->value->content);
+            fprintf(stderr, "'%s' is a built-in function.\n", token_value(token));
         } else {
-            fprintf(stderr, "'%s' original on line: %d\n", token->value->content, original->line);
+            fprintf(stderr, "'%s' original on line: %d\n", token_value(token), original->line);
         }
 
         *rc = RC_SEM_UNDEF_ERR;
@@ -198,16 +206,16 @@ bool sem_check_redecl(T_token *token, symtable_s *symtable, rc_e *rc)
     return true;
 }
 
-bool sem_check_redef(T_token *token, symtable_s *symtable, T_token **function, rc_e *rc)
+bool sem_check_redef(T_token *token, symtable_s *symtable, symbol_s **function, rc_e *rc)
 {
-    if (symtable_search_global(symtable, token->value->content, function)) {
-        if ((*function)->fun_info->defined) {
+    if (symtable_search_global(symtable, token_value(token), function)) {
+        if ((*function)->fun_info.defined) {
             /* If the function was already defined */
             ERR_MSG("Redefining function: ", token->line);
             if ((*function)->line == -1) {
-                fprintf(stderr, "'%s' is a built-in function.\n", token->value->content);
+                fprintf(stderr, "'%s' is a built-in function.\n", token_value(token));
             } else {
-                fprintf(stderr, "'%s' original declaration on line: %d\n", token->value->content,
+                fprintf(stderr, "'%s' original declaration on line: %d\n", token_value(token),
                     (*function)->line);
             }
             *rc = RC_SEM_UNDEF_ERR;
@@ -238,20 +246,20 @@ static bool token_list_types_identical(tstack_s *first, tstack_s *second)
     return sll_is_active(first) == sll_is_active(second);
 }
 
-bool sem_check_decl_def_params(T_token *token, tstack_s *in_params, rc_e *rc)
+bool sem_check_decl_def_params(symbol_s *function, tstack_s *in_params, rc_e *rc)
 {
-    if (!token_list_types_identical(token->fun_info->in_params, in_params)) {
-        ERR_MSG("Mismatch in definition and declaration parameter types.", token->line);
+    if (!token_list_types_identical(function->fun_info.in_params, in_params)) {
+        ERR_MSG("Mismatch in definition and declaration parameter types.", function->line);
         *rc = RC_SEM_UNDEF_ERR;
         return false;
     }
     return true;
 }
 
-bool sem_check_decl_def_returns(T_token *token, tstack_s *out_params, rc_e *rc)
+bool sem_check_decl_def_returns(symbol_s *function, tstack_s *out_params, rc_e *rc)
 {
-    if (!token_list_types_identical(token->fun_info->out_params, out_params)) {
-        ERR_MSG("Mismatch in definition and declaration return types.", token->line);
+    if (!token_list_types_identical(function->fun_info.out_params, out_params)) {
+        ERR_MSG("Mismatch in definition and declaration return types.", function->line);
         *rc = RC_SEM_UNDEF_ERR;
         return false;
     }
@@ -260,9 +268,9 @@ bool sem_check_decl_def_returns(T_token *token, tstack_s *out_params, rc_e *rc)
 
 bool sem_check_id_decl(T_token *token, symtable_s *symtable, T_token **identifier, rc_e *rc)
 {
-    if (!symtable_search_all(symtable, token->value->content, identifier)) {
+    if (!symtable_search_all(symtable, token_value(token), identifier)) {
         ERR_MSG("Use of undeclared variable: ", token->line);
-        fprintf(stderr, "'%s'\n", token->value->content);
+        fprintf(stderr, "'%s'\n", token_value(token));
         *rc = RC_SEM_UNDEF_ERR;
         return false;
     }
@@ -271,25 +279,25 @@ bool sem_check_id_decl(T_token *token, symtable_s *symtable, T_token **identifie
 
 bool sem_check_id_redecl(T_token *token, symtable_s *symtable, rc_e *rc)
 {
-    if (symtable_search_top(symtable, token->value->content, NULL)) {
+    if (symtable_search_top(symtable, token_value(token), NULL)) {
         ERR_MSG("Redeclaring variable error: ", token->line)
-        fprintf(stderr, "'%s'\n", token->value->content);
+        fprintf(stderr, "'%s'\n", token_value(token));
         *rc = RC_SEM_UNDEF_ERR;
         return false;
     }
-    if (symtable_search_global(symtable, token->value->content, NULL)) {
+    if (symtable_search_global(symtable, token_value(token), NULL)) {
         ERR_MSG("Redeclaring function name as variable error: ", token->line)
-        fprintf(stderr, "'%s'\n", token->value->content);
+        fprintf(stderr, "'%s'\n", token_value(token));
         *rc = RC_SEM_UNDEF_ERR;
         return false;
     }
     return true;
 }
 
-bool sem_check_string_length(T_token *token, rc_e *rc)
+bool sem_check_string_length(symbol_type_e type, int line, rc_e *rc)
 {
-    if (token->symbol_type != SYM_TYPE_STRING) {
-        ERR_MSG("Invalid use of '#' operator: expected type string.\n", token->line);
+    if (type != SYM_TYPE_STRING) {
+        ERR_MSG("Invalid use of '#' operator: expected type string.\n", line);
         *rc = RC_SEM_EXP_ERR;
         return false;
     }
@@ -304,85 +312,72 @@ static void invalid_operands(T_token *operator, rc_e * rc)
     *rc = RC_SEM_EXP_ERR;
 }
 
-static bool type_compatible(T_token *first, T_token *third)
+static bool type_compatible(symbol_type_e first, symbol_type_e third)
 {
-    if (first->symbol_type == third->symbol_type) {
+    if (first == third) {
         return true;
     }
-    if (first->symbol_type == SYM_TYPE_NUMBER && third->symbol_type == SYM_TYPE_INT) {
+    if (first == SYM_TYPE_NUMBER && third == SYM_TYPE_INT) {
         return true;
     }
-    if (first->symbol_type == SYM_TYPE_INT && third->symbol_type == SYM_TYPE_NUMBER) {
+    if (first == SYM_TYPE_INT && third == SYM_TYPE_NUMBER) {
         return true;
     }
     return false;
 }
 
-static void convert_ops_to_number(bool convert_first, bool convert_third)
-{
-    puts("POPS GF@%tmp2");
-    puts("POPS GF@%tmp1");
-
-    if (convert_first) {
-        puts("INT2FLOAT GF@%tmp1 GF@%tmp1");
-    }
-
-    if (convert_third) {
-        puts("INT2FLOAT GF@%tmp2 GF@%tmp2");
-    }
-
-    puts("PUSHS GF@%tmp1");
-    puts("PUSHS GF@%tmp2");
-}
-
-bool sem_check_expr_type(T_token *first, T_token *second, T_token *third, rc_e *rc)
+bool sem_check_expr_type(symbol_type_e first, T_token *second, symbol_type_e *third,
+    bool *convert_first, bool *convert_third, rc_e *rc)
 {
+    *convert_first = false;
+    *convert_third = false;
     switch (second->type) {
     case TOKEN_ADD:
     case TOKEN_SUB:
     case TOKEN_MUL:
-        if (first->symbol_type == SYM_TYPE_NUMBER && third->symbol_type == SYM_TYPE_NUMBER) {
+        if (first == SYM_TYPE_NUMBER && *third == SYM_TYPE_NUMBER) {
             break;
-        } else if (first->symbol_type == SYM_TYPE_INT && third->symbol_type == SYM_TYPE_NUMBER) {
-            convert_ops_to_number(true, false);
+        } else if (first == SYM_TYPE_INT && *third == SYM_TYPE_NUMBER) {
+            *convert_first = true;
             break;
-        } else if (first->symbol_type == SYM_TYPE_INT && third->symbol_type == SYM_TYPE_INT) {
+        } else if (first == SYM_TYPE_INT && *third == SYM_TYPE_INT) {
             break;
-        } else if (first->symbol_type == SYM_TYPE_NUMBER && third->symbol_type == SYM_TYPE_INT) {
-            third->symbol_type = SYM_TYPE_NUMBER;
-            convert_ops_to_number(false, true);
+        } else if (first == SYM_TYPE_NUMBER && *third == SYM_TYPE_INT) {
+            *third = SYM_TYPE_NUMBER;
+            *convert_third = true;
             break;
         } else {
             invalid_operands(second, rc);
             return false;
         }
     case TOKEN_DIVISION:
-        if (first->symbol_type == SYM_TYPE_NUMBER && third->symbol_type == SYM_TYPE_NUMBER) {
+        if (first == SYM_TYPE_NUMBER && *third == SYM_TYPE_NUMBER) {
             break;
-        } else if (first->symbol_type == SYM_TYPE_INT && third->symbol_type == SYM_TYPE_NUMBER) {
-            convert_ops_to_number(true, false);
+        } else if (first == SYM_TYPE_INT && *third == SYM_TYPE_NUMBER) {
+            *convert_first = true;
             break;
-        } else if (first->symbol_type == SYM_TYPE_INT && third->symbol_type == SYM_TYPE_INT) {
-            third->symbol_type = SYM_TYPE_NUMBER;
-            convert_ops_to_number(true, true);
+        } else if (first == SYM_TYPE_INT && *third == SYM_TYPE_INT) {
+            *third = SYM_TYPE_NUMBER;
+            *convert_first = true;
+            *convert_third = true;
             break;
-        } else if (first->symbol_type == SYM_TYPE_NUMBER && third->symbol_type == SYM_TYPE_INT) {
-            third->symbol_type = SYM_TYPE_NUMBER;
-            convert_ops_to_number(false, true);
+        } else if (first == SYM_TYPE_NUMBER && *third == SYM_TYPE_INT) {
+            *third = SYM_TYPE_NUMBER;
+            *convert_third = true;
             break;
         } else {
             invalid_operands(second, rc);
             return false;
         }
     case TOKEN_FLOOR_DIVISION:
-        if (first->symbol_type == SYM_TYPE_INT && third->symbol_type == SYM_TYPE_INT) {
+        if (first == SYM_TYPE_INT && *third == SYM_TYPE_INT) {
             break;
         } else {
             invalid_operands(second, rc);
             return false;
         }
     case TOKEN_STRING_CONCAT:
-        if (first->symbol_type == SYM_TYPE_STRING && third->symbol_type == SYM_TYPE_STRING) {
+        if (first == SYM_TYPE_STRING && *third == SYM_TYPE_STRING) {
             break;
         } else {
             invalid_operands(second, rc);
@@ -392,27 +387,27 @@ bool sem_check_expr_type(T_token *first, T_token *second, T_token *third, rc_e *
     case TOKEN_LESS_EQUAL_THAN:
     case TOKEN_GREATER_THAN:
     case TOKEN_GREATER_EQUAL_THAN:
-        if (!type_compatible(first, third)) {
+        if (!type_compatible(first, *third)) {
             ERR_MSG("Comparing incompatible types.\n", second->line);
             *rc = RC_SEM_EXP_ERR;
             return false;
         }
 
-        third->symbol_type = SYM_TYPE_BOOL;
+        *third = SYM_TYPE_BOOL;
         break;
     case TOKEN_EQUAL:
     case TOKEN_NOT_EQUAL_TO:
-        if (first->symbol_type == SYM_TYPE_NIL || third->symbol_type == SYM_TYPE_NIL) {
-            third->symbol_type = SYM_TYPE_BOOL;
+        if (first == SYM_TYPE_NIL || *third == SYM_TYPE_NIL) {
+            *third = SYM_TYPE_BOOL;
             break;
         }
-        if (!type_compatible(first, third)) {
+        if (!type_compatible(first, *third)) {
             ERR_MSG("Comparing incompatible types.\n", second->line);
             *rc = RC_SEM_EXP_ERR;
             return false;
         }
 
-        third->symbol_type = SYM_TYPE_BOOL;
+        *third = SYM_TYPE_BOOL;
         break;
     default:
         /* Should not happen */
@@ -30,7 +30,7 @@ bool sem_check_type_compatible(symbol_type_e first, symbol_type_e second);
  *
  * @note This function is usefull for checking of call parameters.
  *
- * @param[in] function The function token to check for parmeters.
+ * @param[in] function The record of the function to check for parmeters.
  * @param[in] call_params Stack with parameters of the call.
  * @param[in] line Line of the call to generate a helpful error.
  * @param[out] rc Return code to set.
@@ -38,7 +38,7 @@ bool sem_check_type_compatible(symbol_type_e first, symbol_type_e second);
  * @return true All tokens have compatible types.
  * @return false Some tokens don't have compatible type.
  */
-bool sem_call_types_compatible(T_token *function, tstack_s *call_params, unsigned line, rc_e *rc);
+bool sem_call_types_compatible(symbol_s *function, tstack_s *call_params, unsigned line, rc_e *rc);
 
 /**
  * @brief Check if called function was properly defined or declared.
@@ -50,7 +50,8 @@ bool sem_call_types_compatible(T_token *function, tstack_s *call_params, unsigne
  * @return true Function call was proper and the function name was decalred.
  * @return false The function name was not declared.
  */
-bool sem_check_call_function(T_token *token, symtable_s *symtable, T_token **function, rc_e *rc);
+bool sem_check_call_function(
+    T_token *token, symtable_s *symtable, symbol_s **function, rc_e *rc);
 
 /**
  * @brief Check if function was not redeclared.
@@ -68,35 +69,35 @@ bool sem_check_redecl(T_token *token, symtable_s *symtable, rc_e *rc);
  *
  * @param[in] token The token with the function name.
  * @param[in] symtable The symtable where to check for redefinition.
- * @param[out] function The function token found in symtable will contain declaration.
+ * @param[out] function The function record found in symtable will contain declaration.
  * @param[out] rc Return code to set.
  * @return true The function was not redefined.
  * @return false The function was redefined or defined after declaration (function->defined will be
  * false, this return is not an error)
  */
-bool sem_check_redef(T_token *token, symtable_s *symtable, T_token **function, rc_e *rc);
+bool sem_check_redef(T_token *token, symtable_s *symtable, symbol_s **function, rc_e *rc);
 
 /**
  * @brief Check if function declaration and definition parameter types match.
  *
- * @param[in] token The token with the fun_info from symtable.
+ * @param[in] function The record of the function from symtable.
  * @param[in] in_params The stack of collected in parameters. WILL BE FREED IF MATCHING.
  * @param[out] rc Return code to set.
  * @return true The definition was ok.
  * @return false The definition did not match the declaration.
  */
-bool sem_check_decl_def_params(T_token *token, tstack_s *in_params, rc_e *rc);
+bool sem_check_decl_def_params(symbol_s *function, tstack_s *in_params, rc_e *rc);
 
 /**
  * @brief Check if function declaration and definition return types match.
  *
- * @param[in] token The token with the fun_info from symtable.
+ * @param[in] function The record of the function from symtable.
  * @param[in] out_params The stack of collected return types. WILL BE FREED IF MATCHING.
  * @param[out] rc Return code to set.
  * @return true The definition was ok.
  * @return false The definition did not match the declaration.
  */
-bool sem_check_decl_def_returns(T_token *token, tstack_s *out_params, rc_e *rc);
+bool sem_check_decl_def_returns(symbol_s *function, tstack_s *out_params, rc_e *rc);
 
 /**
  * @brief Check if identifier was declared.
@@ -124,25 +125,28 @@ bool sem_check_id_redecl(T_token *token, symtable_s *symtable, rc_e *rc);
 /**
  * @brief Check if the expression passed to string length has correct type.
  *
- * @param[in] token The expression passed to string length.
+ * @param[in] type The type of the expression passed to string length.
+ * @param[in] line The line of the expression.
  * @param[out] rc Return code to set.
  * @return true Called with correct expression.
  * @return false Called with incorrect expression.
  */
-bool sem_check_string_length(T_token *token, rc_e *rc);
+bool sem_check_string_length(symbol_type_e type, int line, rc_e *rc);
 
 /**
  * @brief Check if two operand, one operator expression is semantically correct.
  *
- * @param[in] first First operand. Non-terminal.
+ * @param[in] first Type of the first operand.
  * @param[in] second The operator.
- * @param[in] third Second operand. Non-terminal. Type of this operand will be set to the type of
- * the result.
+ * @param[in,out] third Type of the second operand. It will be set to the type of the result.
+ * @param[out] convert_first Set if the first operand has to be converted to a number.
+ * @param[out] convert_third Set if the second operand has to be converted to a number.
  * @param[out] rc Return code to set.
  * @return true The expression was correct.
  * @return false The expression was incorrect.
  */
-bool sem_check_expr_type(T_token *first, T_token *second, T_token *third, rc_e *rc);
+bool sem_check_expr_type(symbol_type_e first, T_token *second, symbol_type_e *third,
+    bool *convert_first, bool *convert_third, rc_e *rc);
 
 /**
  * @brief Checks if it is semantically correct to assign from @p second to @p first. That means the
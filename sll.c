@@ -7,13 +7,85 @@
 
 #include "sll.h"
 
-void sll_init(sll_s *list)
+/**
+ * @brief Allocate a new element of the list. Spare elements of the list are used first.
+ *
+ * @param[in] list The list the element belongs to.
+ *
+ * @return The uninitialized element.
+ */
+static sll_elem_s *sll_new_elem(sll_s *list)
+{
+    sll_elem_s *new;
+
+    list->length++;
+    if (list->spare) {
+        new = list->spare;
+        list->spare = new->next;
+        return new;
+    }
+    if (list->arena) {
+        return arena_alloc(list->arena, sizeof *new);
+    }
+    new = malloc(sizeof *new);
+    ALLOC_CHECK(new);
+    return new;
+}
+
+/**
+ * @brief Free all the spare elements of the list.
+ *
+ * @param[in] list The list.
+ */
+static void sll_free_spare(sll_s *list)
+{
+    sll_elem_s *spare;
+
+    while (list->spare) {
+        spare = list->spare->next;
+        FREE(list->spare);
+        list->spare = spare;
+    }
+}
+
+/**
+ * @brief Return an element to the spare elements of the list. Elements allocated in an arena are
+ * left to the arena, the part of the arena they are in may be released. An empty list keeps no
+ * spare elements, so lists that are emptied and dropped without sll_destroy do not leak.
+ *
+ * @param[in] list The list the element belongs to.
+ * @param[in] elem The element to free.
+ */
+static void sll_free_elem(sll_s *list, sll_elem_s *elem)
+{
+    if (elem == list->tail) {
+        list->tail = NULL;
+    }
+    list->length--;
+    if (list->arena) {
+        return;
+    }
+
+    elem->next = list->spare;
+    list->spare = elem;
+    if (!list->length) {
+        sll_free_spare(list);
+    }
+}
+
+void sll_init(sll_s *list) { sll_init_arena(list, NULL); }
+
+void sll_init_arena(sll_s *list, arena_s *arena)
 {
     if (!list) {
         return;
     }
     list->head = NULL;
+    list->tail = NULL;
     list->active = NULL;
+    list->length = 0;
+    list->spare = NULL;
+    list->arena = arena;
 }
 
 void sll_insert_head(sll_s *list, void *value)
@@ -23,8 +95,7 @@ void sll_insert_head(sll_s *list, void *value)
     if (!list) {
         return;
     }
-    new = malloc(sizeof *new);
-    ALLOC_CHECK(new);
+    new = sll_new_elem(list);
 
     /* Link as new head */
     tmp = list->head;
@@ -33,6 +104,9 @@ void sll_insert_head(sll_s *list, void *value)
     /* Set element attributes */
     new->value = value;
     new->next = tmp;
+    if (!tmp) {
+        list->tail = new;
+    }
 }
 
 void sll_delete_head(sll_s *list, bool destroy)
@@ -56,7 +130,9 @@ void sll_delete_head(sll_s *list, bool destroy)
         }
     }
 
-    FREE(deleted); /* Free on null does nothing */
+    if (deleted) {
+        sll_free_elem(list, deleted);
+    }
     list->head = tmp;
 }
 
@@ -71,7 +147,7 @@ void sll_destroy(sll_s *list, bool destory)
     }
 
     /* Set the default values to the list */
-    sll_init(list);
+    sll_init_arena(list, list->arena);
 }
 
 void sll_activate(sll_s *list)
@@ -110,12 +186,14 @@ void sll_insert_after(sll_s *list, void *value)
     if (!sll_is_active(list)) {
         return;
     }
-    new = malloc(sizeof *new);
-    ALLOC_CHECK(new);
+    new = sll_new_elem(list);
     new->value = value;
     new->next = list->active->next;
 
     list->active->next = new;
+    if (list->tail == list->active) {
+        list->tail = new;
+    }
 }
 
 void sll_delete_after(sll_s *list, bool destroy)
@@ -136,8 +214,11 @@ void sll_delete_after(sll_s *list, bool destroy)
     if (destroy) {
         FREE(list->active->next->value);
     }
-    FREE(list->active->next);
+    sll_free_elem(list, list->active->next);
     list->active->next = tmp;
+    if (!tmp) {
+        list->tail = list->active;
+    }
 }
 
 void *sll_get_head(const sll_s *list)
@@ -180,46 +261,30 @@ void *sll_get_after(const sll_s *list)
 
 unsigned sll_get_length(const sll_s *list)
 {
-    unsigned len = 0;
-    sll_elem_s *elem;
-
     if (!list) {
-        return len;
+        return 0;
     }
-
-    elem = list->head;
-    while (elem) {
-        len++;
-        elem = elem->next;
-    }
-
-    return len;
+    return list->length;
 }
 
 void sll_insert_last(sll_s *list, void *value)
 {
-    sll_elem_s *old_last;
     sll_elem_s *new;
 
     if (!list) {
         return;
     }
 
-    new = malloc(sizeof *new);
-    ALLOC_CHECK(new);
+    new = sll_new_elem(list);
     new->value = value;
     new->next = NULL;
 
-    old_last = list->head;
-    if (!old_last) {
+    if (list->tail) {
+        list->tail->next = new;
+    } else {
         list->head = new;
-        return;
-    }
-
-    while (old_last->next) {
-        old_last = old_last->next;
     }
-    old_last->next = new;
+    list->tail = new;
 }
 
 void sll_delete_last(sll_s *list, bool destroy)
@@ -246,26 +311,23 @@ void sll_delete_last(sll_s *list, bool destroy)
         if (destroy) {
             FREE(old_last->next->value);
         }
-        FREE(old_last->next);
+        if (old_last->next == list->active) {
+            list->active = NULL;
+        }
+        sll_free_elem(list, old_last->next);
+        old_last->next = NULL;
+        list->tail = old_last;
     }
 }
 
 void *sll_get_last(const sll_s *list)
 {
-    sll_elem_s *last;
-
     if (!list) {
         return NULL;
     }
-
-    last = list->head;
-    if (!last) {
+    if (!list->tail) {
         return NULL;
     }
 
-    while (last->next) {
-        last = last->next;
-    }
-
-    return last->value;
+    return list->tail->value;
 }
@@ -11,6 +11,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#include "arena.h"
 #include "common.h"
 
 /**
@@ -26,7 +27,11 @@ typedef struct sll_elem {
  */
 typedef struct sll {
     sll_elem_s *head;
+    sll_elem_s *tail;
     sll_elem_s *active;
+    unsigned length;
+    sll_elem_s *spare; /* Deleted elements kept for reuse while the list is not empty */
+    arena_s *arena; /* Where the elements are allocated. If NULL they are allocated one by one */
 } sll_s;
 
 /**
@@ -36,6 +41,15 @@ typedef struct sll {
  */
 void sll_init(sll_s *list);
 
+/**
+ * @brief Initialization of a Single Linked List whose elements are allocated in an arena. The
+ * elements are not freed when deleted, they are released together with the arena.
+ *
+ * @param[in,out] list The list to be initialized.
+ * @param[in] arena The arena to allocate the elements in.
+ */
+void sll_init_arena(sll_s *list, arena_s *arena);
+
 /**
  * @brief Insert element into the list as new head.
  *
@@ -136,14 +150,14 @@ void *sll_get_active(const sll_s *list);
 void *sll_get_after(const sll_s *list);
 
 /**
- * @brief Get the length of the list.
+ * @brief Get the length of the list in constant time.
  *
  * @return Length of the list.
  */
 unsigned sll_get_length(const sll_s *list);
 
 /**
- * @brief Insert a new element after the last element of the list.
+ * @brief Insert a new element after the last element of the list in constant time.
  *
  * @param[in,out] list List where to insert the new element.
  * @param[in] value A generic pointer to the new value.
@@ -153,13 +167,15 @@ void sll_insert_last(sll_s *list, void *value);
 /**
  * @brief Remove the last element of the list. Nothing happens if there is no last element.
  *
+ * @note The list is singly linked, so the element before the last one has to be searched for.
+ *
  * @param[in,out] list List where delete the last element.
  * @param[in] destroy Whether to call FREE on value or no.
  */
 void sll_delete_last(sll_s *list, bool destroy);
 
 /**
- * @brief Get the value of the last element.
+ * @brief Get the value of the last element in constant time.
  *
  * @return Gerenic pointer to the value of the last element or NULL if there is no element.
  */
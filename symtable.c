@@ -8,184 +8,243 @@
 #include "symtable.h"
 #include <stdlib.h>
 
-static void data_destroy(void *data) { token_destroy((T_token *)data); }
+/**
+ * @brief Destructor of a record of a function.
+ *
+ * @param[in] data The record.
+ */
+static void symbol_destroy(void *data)
+{
+    symbol_s *symbol = data;
 
-void symtable_insert_token_global(symtable_s *symtable, T_token *token);
+    tstack_destroy(symbol->fun_info.in_params);
+    tstack_destroy(symbol->fun_info.out_params);
+    FREE(symbol->fun_info.in_params);
+    FREE(symbol->fun_info.out_params);
+    FREE(symbol);
+}
 
-static void populate_type_list(tstack_s *type_list, symbol_type_e types[], unsigned count)
+/**
+ * @brief Create a record of a function with an empty signature.
+ *
+ * @param[in] name Name of the function.
+ * @param[in] line Line of the function.
+ * @param[in] defined Whether the function is defined.
+ *
+ * @return The new record.
+ */
+static symbol_s *symbol_create(const char *name, int line, bool defined)
 {
-    for (unsigned i = 0; i < count; i++) {
-        T_token *token = malloc(sizeof(T_token));
-        ALLOC_CHECK(token);
-        token_init(token);
+    symbol_s *symbol = malloc(sizeof *symbol);
+    ALLOC_CHECK(symbol);
 
-        token->symbol_type = types[i];
+    symbol->name = name;
+    symbol->line = line;
+    symbol->fun_info.defined = defined;
 
-        sll_insert_last(type_list, token);
-    }
+    symbol->fun_info.in_params = malloc(sizeof(tstack_s));
+    ALLOC_CHECK(symbol->fun_info.in_params);
+    tstack_init(symbol->fun_info.in_params);
+
+    symbol->fun_info.out_params = malloc(sizeof(tstack_s));
+    ALLOC_CHECK(symbol->fun_info.out_params);
+    tstack_init(symbol->fun_info.out_params);
+
+    return symbol;
 }
 
-static T_token *create_token(const char *key)
+static void populate_type_list(
+    token_pool_s *pool, tstack_s *type_list, symbol_type_e types[], unsigned count)
 {
-    T_token *new;
-    new = malloc(sizeof *new);
-    ALLOC_CHECK(new);
+    for (unsigned i = 0; i < count; i++) {
+        T_token *token = token_new(pool);
 
-    token_init(new);
+        token->symbol_type = types[i];
 
-    for (unsigned i = 0; key[i]; i++) {
-        ds_add_char(new->value, key[i]);
+        sll_insert_last(type_list, token);
     }
+}
 
-    new->fun_info = malloc(sizeof(function_info_s));
-    ALLOC_CHECK(new->fun_info);
-    function_info_init(new->fun_info);
+static symbol_s *create_built_in(symtable_s *symtable, const char *key)
+{
+    symbol_s *new = symbol_create(key, -1, true);
+    function_info_s *fun_info = &new->fun_info;
+    token_pool_s *pool = &symtable->tokens;
 
     if (!strcmp("reads", key)) {
         symbol_type_e out_types[] = { SYM_TYPE_STRING };
-        populate_type_list(new->fun_info->out_params, out_types, 1);
+        populate_type_list(pool, fun_info->out_params, out_types, 1);
 
     } else if (!strcmp("readn", key)) {
         symbol_type_e out_types[] = { SYM_TYPE_NUMBER };
-        populate_type_list(new->fun_info->out_params, out_types, 1);
+        populate_type_list(pool, fun_info->out_params, out_types, 1);
 
     } else if (!strcmp("readi", key)) {
         symbol_type_e out_types[] = { SYM_TYPE_INT };
-        populate_type_list(new->fun_info->out_params, out_types, 1);
+        populate_type_list(pool, fun_info->out_params, out_types, 1);
 
     } else if (!strcmp("tointeger", key)) {
         symbol_type_e in_types[] = { SYM_TYPE_NUMBER };
         symbol_type_e out_types[] = { SYM_TYPE_INT };
-        populate_type_list(new->fun_info->in_params, in_types, 1);
-        populate_type_list(new->fun_info->out_params, out_types, 1);
+        populate_type_list(pool, fun_info->in_params, in_types, 1);
+        populate_type_list(pool, fun_info->out_params, out_types, 1);
 
     } else if (!strcmp("substr", key)) {
         symbol_type_e in_types[] = { SYM_TYPE_STRING, SYM_TYPE_INT, SYM_TYPE_INT };
         symbol_type_e out_types[] = { SYM_TYPE_STRING };
-        populate_type_list(new->fun_info->in_params, in_types, 3);
-        populate_type_list(new->fun_info->out_params, out_types, 1);
+        populate_type_list(pool, fun_info->in_params, in_types, 3);
+        populate_type_list(pool, fun_info->out_params, out_types, 1);
 
     } else if (!strcmp("ord", key)) {
         symbol_type_e in_types[] = { SYM_TYPE_STRING, SYM_TYPE_INT };
         symbol_type_e out_types[] = { SYM_TYPE_INT };
-        populate_type_list(new->fun_info->in_params, in_types, 2);
-        populate_type_list(new->fun_info->out_params, out_types, 1);
+        populate_type_list(pool, fun_info->in_params, in_types, 2);
+        populate_type_list(pool, fun_info->out_params, out_types, 1);
 
     } else if (!strcmp("chr", key)) {
         symbol_type_e in_types[] = { SYM_TYPE_INT };
         symbol_type_e out_types[] = { SYM_TYPE_STRING };
-        populate_type_list(new->fun_info->in_params, in_types, 1);
-        populate_type_list(new->fun_info->out_params, out_types, 1);
+        populate_type_list(pool, fun_info->in_params, in_types, 1);
+        populate_type_list(pool, fun_info->out_params, out_types, 1);
     }
 
-    new->type = TOKEN_ID;
-    new->line = -1;
-    new->fun_info->defined = true;
-
     return new;
 }
 
-void symtable_init(symtable_s *symtable)
+void symtable_init(symtable_s *symtable, intern_s *names)
 {
     sll_s *frames;
-    avl_node_s *global;
 
     /* Initialize the frames list */
+    arena_init(&symtable->arena);
+    token_pool_init(&symtable->tokens);
     frames = malloc(sizeof *frames);
     ALLOC_CHECK(frames);
-    sll_init(frames);
+    sll_init_arena(frames, &symtable->arena);
     symtable->frames = frames;
+    htable_init(&symtable->variables);
 
-    /* Initialize the global frame AVL tree */
-    avl_init(&global);
-    symtable->global = global;
+    /* Initialize the global frame hash table */
+    htable_init(&symtable->global);
     symtable->current_def = NULL;
 
     char *built_ins[] = { "reads", "readn", "readi", "write", "tointeger", "substr", "ord", "chr" };
     for (unsigned i = 0; i < 8; i++) {
-        symtable_insert_token_global(symtable, create_token(built_ins[i]));
+        const char *name = intern_string(names, built_ins[i], strlen(built_ins[i]));
+        symbol_s *symbol = create_built_in(symtable, name);
+        htable_insert(&symtable->global, symbol->name, symbol);
+        symtable->current_def = symbol;
     }
 }
 
+/**
+ * @brief Find the innermost binding of a name.
+ *
+ * @param[in] symtable The table of symbols.
+ * @param[in] key The name.
+ *
+ * @return The binding. NULL if the name is not in scope.
+ */
+static binding_s *find_binding(const symtable_s *symtable, const char *key)
+{
+    binding_s *binding = NULL;
+
+    htable_search(&symtable->variables, key, (void **)&binding);
+    return binding;
+}
+
 bool symtable_search_all(const symtable_s *symtable, const char *key, T_token **token)
 {
-    bool found = false;
+    binding_s *binding;
 
     if (!symtable) {
         return false;
     }
 
-    /* Go through all the frames trying to find the key */
-    sll_activate(symtable->frames);
-    while (sll_is_active(symtable->frames)) {
-        if ((found = avl_search(sll_get_active(symtable->frames), key, (void **)token))) {
-            break;
-        }
-        sll_next(symtable->frames);
+    binding = find_binding(symtable, key);
+    if (!binding) {
+        return false;
     }
-
-    return found;
+    if (token) {
+        *token = binding->token;
+    }
+    return true;
 }
 
 bool symtable_search_top(const symtable_s *symtable, const char *key, T_token **token)
 {
+    binding_s *binding;
+
     if (!symtable) {
         return false;
     }
 
-    if (sll_is_empty(symtable->frames)) {
+    binding = find_binding(symtable, key);
+    if (!binding || binding->frame != sll_get_head(symtable->frames)) {
         return false;
     }
-
-    return avl_search(sll_get_head(symtable->frames), key, (void **)token);
+    if (token) {
+        *token = binding->token;
+    }
+    return true;
 }
 
-bool symtable_search_global(const symtable_s *symtable, const char *key, T_token **token)
+bool symtable_search_global(const symtable_s *symtable, const char *key, symbol_s **symbol)
 {
     if (!symtable) {
         return false;
     }
 
-    return avl_search(symtable->global, key, (void **)token);
+    return htable_search(&symtable->global, key, (void **)symbol);
 }
 
 void symtable_new_frame(symtable_s *symtable)
 {
+    arena_mark_s mark;
+    frame_s *frame;
+
     if (!symtable) {
         return;
     }
 
-    sll_insert_head(symtable->frames, NULL);
+    /* Everything allocated for the frame from now on is released when it is popped */
+    mark = arena_mark(&symtable->arena);
+    frame = arena_alloc(&symtable->arena, sizeof *frame);
+    frame->declared = NULL;
+    frame->mark = mark;
+    sll_insert_head(symtable->frames, frame);
 }
 
 void symtable_pop_frame(symtable_s *symtable)
 {
-    avl_node_s *node;
+    frame_s *frame;
+    binding_s *binding;
+
     if (!symtable) {
         return;
     }
 
-    node = sll_get_head(symtable->frames);
-    avl_destroy(&node, data_destroy);
+    frame = sll_get_head(symtable->frames);
+    if (!frame) {
+        return;
+    }
+
+    /* Undo the declarations of the frame, the shadowed bindings come back into scope */
+    for (binding = frame->declared; binding; binding = binding->previous) {
+        htable_insert(&symtable->variables, token_value(binding->token), binding->shadowed);
+        token_destroy(binding->token);
+    }
     sll_delete_head(symtable->frames, false);
+    arena_release(&symtable->arena, frame->mark);
 }
 
 unsigned symtable_frames_depth(const symtable_s *symtable)
 {
-    unsigned depth = 0;
-    sll_elem_s *elem;
-
     if (!symtable) {
-        return depth;
+        return 0;
     }
 
-    elem = symtable->frames->head;
-    while (elem) {
-        depth++;
-        elem = elem->next;
-    }
-
-    return depth;
+    return sll_get_length(symtable->frames);
 }
 
 bool symtable_frames_empty(const symtable_s *symtable)
@@ -199,7 +258,8 @@ bool symtable_frames_empty(const symtable_s *symtable)
 
 void symtable_insert_token_top(symtable_s *symtable, T_token *token)
 {
-    avl_node_s *node;
+    frame_s *frame;
+    binding_s *binding, *shadowed;
 
     if (!symtable) {
         return;
@@ -209,42 +269,51 @@ void symtable_insert_token_top(symtable_s *symtable, T_token *token)
         return;
     }
 
-    node = sll_get_head(symtable->frames);
-    avl_insert(&node, token->value->content, token);
-    sll_delete_head(symtable->frames, false);
-    sll_insert_head(symtable->frames, node);
+    frame = sll_get_head(symtable->frames);
+
+    /* A repeated parameter shadows the earlier one, the frame frees both tokens when popped */
+    shadowed = find_binding(symtable, token_value(token));
+    binding = arena_alloc(&symtable->arena, sizeof *binding);
+    binding->token = token;
+    binding->frame = frame;
+    binding->shadowed = shadowed;
+    binding->previous = frame->declared;
+    frame->declared = binding;
+    htable_insert(&symtable->variables, token_value(token), binding);
 }
 
-void symtable_insert_token_global(symtable_s *symtable, T_token *token)
+symbol_s *symtable_insert_function(symtable_s *symtable, const T_token *token, bool defined)
 {
+    symbol_s *symbol;
+
     if (!symtable) {
-        return;
+        return NULL;
     }
 
-    avl_insert(&symtable->global, token->value->content, token);
-    if (token->fun_info->defined) {
-        symtable->current_def = token;
+    symbol = symbol_create(token_value(token), token->line, defined);
+    htable_insert(&symtable->global, symbol->name, symbol);
+    if (defined) {
+        symtable->current_def = symbol;
     }
+    return symbol;
 }
 
 void symtable_destroy(symtable_s *symtable)
 {
-    avl_node_s *node;
-
     if (!symtable) {
         return;
     }
 
-    sll_activate(symtable->frames);
-    while (sll_is_active(symtable->frames)) {
-        node = sll_get_head(symtable->frames);
-        avl_destroy(&node, data_destroy);
-        sll_delete_head(symtable->frames, false);
-        sll_activate(symtable->frames);
+    while (!sll_is_empty(symtable->frames)) {
+        symtable_pop_frame(symtable);
     }
     FREE(symtable->frames);
-    avl_destroy(&symtable->global, data_destroy);
+    /* No binding is left in scope, only the names remain */
+    htable_destroy(&symtable->variables, NULL);
+    arena_destroy(&symtable->arena);
+    htable_destroy(&symtable->global, symbol_destroy);
+    token_pool_destroy(&symtable->tokens);
     symtable->current_def = NULL;
 }
 
-T_token *symtable_get_current_def(symtable_s *symtable) { return symtable->current_def; }
+symbol_s *symtable_get_current_def(symtable_s *symtable) { return symtable->current_def; }
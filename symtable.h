@@ -12,30 +12,74 @@
 #include <stdio.h>
 #include <stdlib.h>
 
-#include "avl.h"
+#include "arena.h"
 #include "common.h"
+#include "htable.h"
 #include "sll.h"
 #include "token_stack.h"
 
+/**
+ * @brief Signature of a function. Parameters and return values are lists of tokens of which only
+ * the symbol types are used.
+ */
+typedef struct function_info {
+    tstack_s *in_params;
+    tstack_s *out_params;
+    bool defined;
+} function_info_s;
+
+/**
+ * @brief Record of a function in the global frame.
+ */
+typedef struct symbol {
+    const char *name;
+    int line; /* Line of the first declaration or definition, -1 for built-in functions */
+    function_info_s fun_info;
+} symbol_s;
+
+/**
+ * @brief Binding of a variable name to its token in one frame.
+ */
+typedef struct binding {
+    T_token *token;
+    struct frame *frame; /* Frame the variable was declared in */
+    struct binding *shadowed; /* Earlier binding of the same name, NULL if none */
+    struct binding *previous; /* Binding declared before this one in the same frame */
+} binding_s;
+
+/**
+ * @brief Local frame of variables. Allocated in the arena of the table of symbols together with
+ * its bindings, all of which is released at once when the frame is popped.
+ */
+typedef struct frame {
+    binding_s *declared; /* Undo log of the frame, the last declared binding first */
+    arena_mark_s mark; /* Position in the arena before the frame was created */
+} frame_s;
+
 /**
  * @brief Structure for the table of symbols.
  */
 typedef struct symtable {
-    sll_s *frames;
-    avl_node_s *global;
-    T_token *current_def;
+    sll_s *frames; /* Stack of frame_s, the top frame is the head */
+    htable_s variables; /* Innermost binding of every variable name, NULL when out of scope */
+    htable_s global; /* Functions, values are symbol_s */
+    symbol_s *current_def;
+    arena_s arena; /* Region of the local frames */
+    token_pool_s tokens; /* Types of the built-in functions */
 } symtable_s;
 
 /**
- * @brief Initialization of the table of symbols structure.
+ * @brief Initialization of the table of symbols structure. All the names the table is searched
+ * for must be interned in @p names.
  *
  * @param[in] symtable The table of symbols to initialize.
+ * @param[in,out] names Pool the names of the built-in functions are interned in.
  */
-void symtable_init(symtable_s *symtable);
+void symtable_init(symtable_s *symtable, intern_s *names);
 
 /**
  * @brief Search for a token among all the frames. Excluding global which is meant for functions.
- * only.
+ * only. Takes one lookup regardless of the number of frames.
  *
  * @param[in] symtable The table of symbols to initialize.
  * @param[in] key The key of the token to find.
@@ -59,16 +103,16 @@ bool symtable_search_all(const symtable_s *symtable, const char *key, T_token **
 bool symtable_search_top(const symtable_s *symtable, const char *key, T_token **token);
 
 /**
- * @brief Search for a token in the global frame. Global frame is meant for functions only.
+ * @brief Search for a function in the global frame. Global frame is meant for functions only.
  *
  * @param[in] symtable The table of symbols to initialize.
- * @param[in] key The key of the token to find.
- * @param[out] token If the token was found it will be placed here. If @p token is NULL the token
- * will not be stored. if it was nout found NULL will be stored.
+ * @param[in] key The name of the function to find.
+ * @param[out] symbol If the function was found its record will be placed here. If @p symbol is
+ * NULL the record will not be stored.
  *
- * @return True if token was found. False if not found.
+ * @return True if function was found. False if not found.
  */
-bool symtable_search_global(const symtable_s *symtable, const char *key, T_token **token);
+bool symtable_search_global(const symtable_s *symtable, const char *key, symbol_s **symbol);
 
 /**
  * @brief Creates a new top local frame.
@@ -78,7 +122,8 @@ bool symtable_search_global(const symtable_s *symtable, const char *key, T_token
 void symtable_new_frame(symtable_s *symtable);
 
 /**
- * @brief Pops the top local frame. If there was no frame it does nothing.
+ * @brief Pops the top local frame. If there was no frame it does nothing. Only the names declared
+ * in the frame are visited, everything allocated for the frame in the arena is released at once.
  *
  * @param[in] symtable The table of symbols where to pop the frame.
  */
@@ -112,12 +157,15 @@ bool symtable_frames_empty(const symtable_s *symtable);
 void symtable_insert_token_top(symtable_s *symtable, T_token *token);
 
 /**
- * @brief Insert a new token in the global frame. Meant for functions only.
+ * @brief Create a record of a function with an empty signature and insert it in the global frame.
  *
- * @param[in,out] symtable The table of symbols where to insert a new token.
- * @param[out] token The token to insert.
+ * @param[in,out] symtable The table of symbols where to insert the function.
+ * @param[in] token Name of the function. Only its name and line are used, it is not kept.
+ * @param[in] defined Whether the function is being defined or only declared.
+ *
+ * @return The record of the function.
  */
-void symtable_insert_token_global(symtable_s *symtable, T_token *token);
+symbol_s *symtable_insert_function(symtable_s *symtable, const T_token *token, bool defined);
 
 /**
  * @brief Destructor of the table of symbols structure.
@@ -130,9 +178,9 @@ void symtable_destroy(symtable_s *symtable);
  * @brief Get function currently being defined. Last inserted defined function to global frame.
  *
  * @param symtable The table of symbols of which to get currently defined function.
- * @return T_token* Pointer to token of currently defined function. NULL if no function is defined
- * yet.
+ * @return symbol_s* Pointer to record of currently defined function. NULL if no function is
+ * defined yet.
  */
-T_token *symtable_get_current_def(symtable_s *symtable);
+symbol_s *symtable_get_current_def(symtable_s *symtable);
 
 #endif /* _SYMTABLE_H */
@@ -0,0 +1,163 @@
+/**
+ * @file bench_avl.c
+ * Projekt: Implementace prekladace imperativniho jazyka IFJ21.
+ * @author Tadeas Vintrlik <xvintr04@stud.fit.vutbr.cz>
+ * @brief Microbenchmarks of the AVL Tree operations.
+ *
+ * Usage: ./bench_avl
+ * Keys are generated in a pseudo-random order. Long keys share a prefix longer than the one kept in
+ * the nodes, so their comparisons have to read the keys.
+ */
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "avl.h"
+
+#define BENCH_KEYS 200000
+#define BENCH_KEY_SIZE 32
+#define BENCH_REPEAT 5
+
+static double elapsed(const struct timespec *start, const struct timespec *end)
+{
+    return (end->tv_sec - start->tv_sec) + (end->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static int compare_keys(const void *a, const void *b)
+{
+    return strcmp(*(const char *const *)a, *(const char *const *)b);
+}
+
+static void do_nothing(void *data)
+{
+    (void)data;
+}
+
+/**
+ * @brief Operation measured by the benchmark.
+ */
+typedef enum bench_op {
+    INSERT,
+    INSERT_POOL,
+    BUILD,
+    SEARCH,
+    DELETE_POOL,
+    DESTROY,
+} bench_op_e;
+
+static const char *op_names[] = { "insert", "insert pool", "build sorted", "search",
+    "delete pool", "destroy" };
+
+/**
+ * @brief Run all the operations once and add their times to the best times.
+ *
+ * @param[in] keys Keys in insertion order.
+ * @param[in] copies Copies of the keys in search order, never the same pointers as the keys.
+ * @param[in] sorted The keys sorted.
+ * @param[in,out] best Best time of every operation in seconds.
+ */
+static void bench(char *const *keys, char *const *copies, const char *const *sorted, double *best)
+{
+    struct timespec start, end;
+    double times[DESTROY + 1];
+    avl_node_s *tree = NULL;
+    avl_pool_s pool;
+    unsigned found = 0;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (unsigned i = 0; i < BENCH_KEYS; i++) {
+        avl_insert(&tree, keys[i], NULL);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    times[INSERT] = elapsed(&start, &end);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    avl_destroy(&tree, do_nothing);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    times[DESTROY] = elapsed(&start, &end);
+
+    avl_pool_init(&pool);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (unsigned i = 0; i < BENCH_KEYS; i++) {
+        avl_insert_pool(&tree, keys[i], NULL, &pool);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    times[INSERT_POOL] = elapsed(&start, &end);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (unsigned i = 0; i < BENCH_KEYS; i++) {
+        found += avl_search(tree, copies[i], NULL);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    times[SEARCH] = elapsed(&start, &end);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (unsigned i = 0; i < BENCH_KEYS; i++) {
+        avl_delete_pool(&tree, copies[i], do_nothing, &pool);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    times[DELETE_POOL] = elapsed(&start, &end);
+    avl_pool_destroy(&pool);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    avl_build(&tree, sorted, NULL, BENCH_KEYS, &pool);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    times[BUILD] = elapsed(&start, &end);
+    avl_release(&tree, do_nothing);
+    avl_pool_destroy(&pool);
+
+    if (found != BENCH_KEYS) {
+        fprintf(stderr, "Found %u keys out of %d.\n", found, BENCH_KEYS);
+        exit(1);
+    }
+    for (unsigned op = 0; op <= DESTROY; op++) {
+        if (best[op] < 0 || times[op] < best[op]) {
+            best[op] = times[op];
+        }
+    }
+}
+
+/**
+ * @brief Benchmark keys generated from a format.
+ *
+ * @param[in] format Format of the keys with one unsigned conversion.
+ */
+static void bench_format(const char *format)
+{
+    static char keys[BENCH_KEYS][BENCH_KEY_SIZE], copies[BENCH_KEYS][BENCH_KEY_SIZE];
+    static char *key_order[BENCH_KEYS], *copy_order[BENCH_KEYS];
+    static const char *sorted[BENCH_KEYS];
+    double best[DESTROY + 1];
+
+    /* A multiplier coprime with the number of keys visits every key once */
+    for (unsigned i = 0; i < BENCH_KEYS; i++) {
+        snprintf(keys[i], BENCH_KEY_SIZE, format, i * 7919u % BENCH_KEYS);
+        snprintf(copies[i], BENCH_KEY_SIZE, format, i * 7927u % BENCH_KEYS);
+        key_order[i] = keys[i];
+        copy_order[i] = copies[i];
+        sorted[i] = keys[i];
+    }
+    qsort(sorted, BENCH_KEYS, sizeof *sorted, compare_keys);
+
+    for (unsigned op = 0; op <= DESTROY; op++) {
+        best[op] = -1;
+    }
+    for (unsigned r = 0; r < BENCH_REPEAT; r++) {
+        bench(key_order, copy_order, sorted, best);
+    }
+
+    printf("keys like \"%s\":\n", keys[1]);
+    for (unsigned op = 0; op <= DESTROY; op++) {
+        printf("  %-12s best of %d %8.3f ms, %6.1f ns per key\n", op_names[op], BENCH_REPEAT,
+            best[op] * 1e3, best[op] / BENCH_KEYS * 1e9);
+    }
+}
+
+int main(void)
+{
+    bench_format("v%u");
+    bench_format("local_variable_%u");
+    return 0;
+}
@@ -0,0 +1,117 @@
+/**
+ * @file bench_calls.c
+ * Projekt: Implementace prekladace imperativniho jazyka IFJ21.
+ * @author Tadeas Vintrlik <xvintr04@stud.fit.vutbr.cz>
+ * @brief Scaling benchmark of the compilation of programs with many top-level calls.
+ *
+ * Usage: ./bench_calls
+ * Every top-level call is appended to the list of calls. The time per call should not grow with
+ * the number of calls.
+ */
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "parser.h"
+#include "scanner.h"
+
+#define BENCH_MIN_CALLS 25000
+#define BENCH_MAX_CALLS 200000
+#define BENCH_REPEAT 3
+
+/**
+ * @brief Write a program with a single function called from the top level many times.
+ *
+ * @param[in] f File to write into.
+ * @param[in] calls Number of calls to generate.
+ */
+static void generate_source(FILE *f, unsigned calls)
+{
+    fputs("require \"ifj21\"\nfunction f(x : integer, y : string)\nend\n", f);
+    for (unsigned i = 0; i < calls; i++) {
+        fprintf(f, "f(%u, \"call\")\n", i);
+    }
+}
+
+static double elapsed(const struct timespec *start, const struct timespec *end)
+{
+    return (end->tv_sec - start->tv_sec) + (end->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+/**
+ * @brief Compile a program with the given number of top-level calls.
+ *
+ * @param[in] calls Number of calls.
+ * @param[out] best Best time of the compilation in seconds.
+ *
+ * @return 0 on success.
+ */
+static int bench(unsigned calls, double *best)
+{
+    char path[] = "/tmp/bench_calls_XXXXXX";
+    int fd = mkstemp(path);
+    FILE *f = fd < 0 ? NULL : fdopen(fd, "w");
+    context_s ctx;
+    struct timespec start, end;
+
+    if (!f) {
+        fputs("Could not create the benchmark source.\n", stderr);
+        return 1;
+    }
+    generate_source(f, calls);
+    fclose(f);
+
+    if (initialize_scanner(&ctx, path) != RC_OK) {
+        unlink(path);
+        return 1;
+    }
+    unlink(path);
+    tokenize_source(&ctx);
+
+    ctx.out = fopen("/dev/null", "w");
+    if (!ctx.out) {
+        destroy_scanner(&ctx);
+        return 1;
+    }
+
+    *best = -1;
+    for (unsigned r = 0; r < BENCH_REPEAT; r++) {
+        rc_e ret;
+
+        /* Every run parses the same tokens from the start */
+        ctx.stream.next = 0;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        ret = start_parsing(&ctx);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+
+        if (ret != RC_OK) {
+            fprintf(stderr, "Parsing failed with return code %d.\n", ret);
+            fclose(ctx.out);
+            destroy_scanner(&ctx);
+            return 1;
+        }
+        if (*best < 0 || elapsed(&start, &end) < *best) {
+            *best = elapsed(&start, &end);
+        }
+    }
+
+    fclose(ctx.out);
+    destroy_scanner(&ctx);
+    return 0;
+}
+
+int main(void)
+{
+    double best;
+
+    for (unsigned calls = BENCH_MIN_CALLS; calls <= BENCH_MAX_CALLS; calls *= 2) {
+        if (bench(calls, &best)) {
+            return 1;
+        }
+        printf("%u calls: best of %d %.3f ms, %.1f ns per call\n", calls, BENCH_REPEAT,
+            best * 1e3, best / calls * 1e9);
+    }
+    return 0;
+}
@@ -0,0 +1,111 @@
+/**
+ * @file bench_parser.c
+ * Projekt: Implementace prekladace imperativniho jazyka IFJ21.
+ * @author Tadeas Vintrlik <xvintr04@stud.fit.vutbr.cz>
+ * @brief Throughput benchmark of the parser and code generator on a source lexed up front.
+ *
+ * Usage: ./bench_parser [source.tl]
+ * Without an argument a synthetic source file is generated and parsed.
+ */
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "parser.h"
+#include "scanner.h"
+
+#define BENCH_FUNCTIONS 20000
+#define BENCH_REPEAT 5
+
+/**
+ * @brief Write a synthetic program with declarations, expressions, loops and comments.
+ *
+ * @param[in] f File to write into.
+ * @param[in] functions Number of functions to generate.
+ */
+static void generate_source(FILE *f, unsigned functions)
+{
+    fputs("require \"ifj21\"\n--[[ generated benchmark source\n     with a block comment ]]\n", f);
+    for (unsigned i = 0; i < functions; i++) {
+        fprintf(f, "-- function number %u computes something fairly pointless\n", i);
+        fprintf(f, "function fun_%u(alpha : integer, beta : number, gamma : string) : number\n", i);
+        fprintf(f, "    local counter_%u : integer = alpha * 60 * 60 + 24 // 3\n", i);
+        fprintf(f, "    local value : number = beta / 2.5e1 + counter_%u - 0.125\n", i);
+        fputs("    local text : string = gamma .. \"literal with \\t escapes \\n and \\065\"\n", f);
+        fprintf(f, "    while counter_%u >= 0 do counter_%u = counter_%u - 1 end\n", i, i, i);
+        fputs("    return value\nend\n", f);
+    }
+}
+
+static double elapsed(const struct timespec *start, const struct timespec *end)
+{
+    return (end->tv_sec - start->tv_sec) + (end->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+int main(int argc, char **argv)
+{
+    char generated[] = "/tmp/bench_parser_XXXXXX";
+    const char *path = argc > 1 ? argv[1] : generated;
+    context_s ctx;
+    struct timespec start, end;
+    double lexing, best = -1;
+
+    if (argc <= 1) {
+        int fd = mkstemp(generated);
+        FILE *f = fd < 0 ? NULL : fdopen(fd, "w");
+        if (!f) {
+            fputs("Could not create the benchmark source.\n", stderr);
+            return 1;
+        }
+        generate_source(f, BENCH_FUNCTIONS);
+        fclose(f);
+    }
+
+    if (initialize_scanner(&ctx, path) != RC_OK) {
+        return 1;
+    }
+    if (argc <= 1) {
+        unlink(generated);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    tokenize_source(&ctx);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    lexing = elapsed(&start, &end);
+
+    ctx.out = fopen("/dev/null", "w");
+    if (!ctx.out) {
+        destroy_scanner(&ctx);
+        return 1;
+    }
+
+    for (unsigned r = 0; r < BENCH_REPEAT; r++) {
+        rc_e ret;
+
+        /* Every run parses the same tokens from the start */
+        ctx.stream.next = 0;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        ret = start_parsing(&ctx);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+
+        if (ret != RC_OK) {
+            fprintf(stderr, "Parsing failed with return code %d.\n", ret);
+            fclose(ctx.out);
+            destroy_scanner(&ctx);
+            return 1;
+        }
+        if (best < 0 || elapsed(&start, &end) < best) {
+            best = elapsed(&start, &end);
+        }
+    }
+
+    printf("lexed %u tokens in %.3f ms\n", ctx.stream.count, lexing * 1e3);
+    printf("best of %d: parsed in %.3f ms, %.1f Mtokens/s\n", BENCH_REPEAT, best * 1e3,
+        ctx.stream.count / best / 1e6);
+
+    fclose(ctx.out);
+    destroy_scanner(&ctx);
+    return 0;
+}
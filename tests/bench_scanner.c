@@ -0,0 +1,106 @@
+/**
+ * @file bench_scanner.c
+ * Projekt: Implementace prekladace imperativniho jazyka IFJ21.
+ * @author Tadeas Vintrlik <xvintr04@stud.fit.vutbr.cz>
+ * @brief Throughput benchmark of the scanner.
+ *
+ * Usage: ./bench_scanner [source.tl]
+ * Without an argument a synthetic source file is generated and scanned.
+ */
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "scanner.h"
+
+#define BENCH_FUNCTIONS 20000
+#define BENCH_REPEAT 5
+
+/**
+ * @brief Write a synthetic program with identifiers, literals, operators and comments.
+ *
+ * @param[in] f File to write into.
+ * @param[in] functions Number of functions to generate.
+ */
+static void generate_source(FILE *f, unsigned functions)
+{
+    fputs("require \"ifj21\"\n--[[ generated benchmark source\n     with a block comment ]]\n", f);
+    for (unsigned i = 0; i < functions; i++) {
+        fprintf(f, "-- function number %u computes something fairly pointless\n", i);
+        fprintf(f, "function fun_%u(alpha : integer, beta : number, gamma : string) : number\n", i);
+        fprintf(f, "    local counter_%u : integer = alpha * 60 * 60 + 24 // 3\n", i);
+        fprintf(f, "    local value : number = beta / 2.5e1 + counter_%u - 0.125\n", i);
+        fputs("    local text : string = gamma .. \"literal with \\t escapes \\n and \\065\"\n", f);
+        fprintf(f, "    while counter_%u >= 0 do counter_%u = counter_%u - 1 end\n", i, i, i);
+        fputs("    return value\nend\n", f);
+    }
+}
+
+static double elapsed(const struct timespec *start, const struct timespec *end)
+{
+    return (end->tv_sec - start->tv_sec) + (end->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+int main(int argc, char **argv)
+{
+    char generated[] = "/tmp/bench_scanner_XXXXXX";
+    const char *path = argc > 1 ? argv[1] : generated;
+    context_s ctx;
+    struct timespec start, end;
+    struct stat st;
+    double best = -1;
+    unsigned long tokens = 0;
+
+    if (argc <= 1) {
+        int fd = mkstemp(generated);
+        FILE *f = fd < 0 ? NULL : fdopen(fd, "w");
+        if (!f) {
+            fputs("Could not create the benchmark source.\n", stderr);
+            return 1;
+        }
+        generate_source(f, BENCH_FUNCTIONS);
+        fclose(f);
+    }
+
+    if (stat(path, &st)) {
+        fprintf(stderr, "Could not open the source file: %s\n", path);
+        return 1;
+    }
+
+    for (unsigned r = 0; r < BENCH_REPEAT; r++) {
+        T_token *token;
+
+        if (initialize_scanner(&ctx, path) != RC_OK) {
+            return 1;
+        }
+        tokens = 0;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        do {
+            token = get_next_token(&ctx);
+            tokens++;
+            if (token->type == TOKEN_EOF) {
+                break;
+            }
+            token_destroy(token);
+        } while (1);
+        token_destroy(token);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        destroy_scanner(&ctx);
+
+        if (best < 0 || elapsed(&start, &end) < best) {
+            best = elapsed(&start, &end);
+        }
+    }
+
+    if (argc <= 1) {
+        unlink(generated);
+    }
+
+    printf("scanned %lld bytes, %lu tokens\n", (long long)st.st_size, tokens);
+    printf("best of %d: %.3f ms, %.1f MB/s, %.1f Mtokens/s\n", BENCH_REPEAT, best * 1e3,
+        st.st_size / best / 1e6, tokens / best / 1e6);
+    return 0;
+}
@@ -143,9 +143,13 @@ test_run ./source_codes/whitespaces.tl OK
 test_run ./source_codes/nil_return.tl OK
 test_run ./source_codes/code_after_return.tl OK
 test_run ./source_codes/less_return.tl OK
+test_run ./source_codes/nil_string.tl OK
+test_run ./source_codes/escapes.tl OK
 test_run ./source_codes/syn_err1.tl SYN_ERR
 test_run ./source_codes/syn_err2.tl SYN_ERR
 test_run ./source_codes/lex_err1.tl LEX_ERR
+test_run ./source_codes/lex_err_int1.tl LEX_ERR
+test_run ./source_codes/lex_err_int2.tl LEX_ERR
 test_run ./source_codes/sem_err_undef1.tl SEM_UNDEF_ERR
 test_run ./source_codes/sem_err_undef2.tl SEM_UNDEF_ERR
 test_run ./source_codes/sem_err_undef3.tl SEM_UNDEF_ERR
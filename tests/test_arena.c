@@ -0,0 +1,177 @@
+/**
+ * @file test_arena.c
+ * Projekt: Implementace prekladace imperativniho jazyka IFJ21.
+ * @author Tadeas Vintrlik <xvintr04@stud.fit.vutbr.cz>
+ * @brief Test for the functionality of the region (arena) allocator.
+ */
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <cmocka.h>
+
+#include "arena.h"
+#include "avl.h"
+#include "sll.h"
+
+static int local_setup(void **state)
+{
+    arena_s *arena = malloc(sizeof *arena);
+
+    if (!arena) {
+        return 1;
+    }
+    arena_init(arena);
+
+    *state = arena;
+    return 0;
+}
+
+static int local_teardown(void **state)
+{
+    arena_s *arena = *state;
+
+    arena_destroy(arena);
+    if (arena->block || arena->spare) {
+        return 1;
+    }
+    free(arena);
+
+    return 0;
+}
+
+static void test_alloc(void **state)
+{
+    arena_s *arena = *state;
+    char *small, *other, *big;
+
+    /* Objects are aligned and do not overlap */
+    small = arena_alloc(arena, 3);
+    other = arena_alloc(arena, 1);
+    assert_int_equal((uintptr_t)small % sizeof(arena_align_u), 0);
+    assert_int_equal((uintptr_t)other % sizeof(arena_align_u), 0);
+    assert_true(other >= small + 3);
+    memcpy(small, "ab", 3);
+    *other = 'c';
+    assert_string_equal(small, "ab");
+
+    /* Objects larger than a block get a block of their own */
+    big = arena_alloc(arena, 100000);
+    memset(big, 'x', 100000);
+    assert_string_equal(small, "ab");
+    assert_int_equal(*other, 'c');
+}
+
+static void test_release(void **state)
+{
+    arena_s *arena = *state;
+    arena_mark_s outer, inner;
+    arena_block_s *block;
+    char *kept, *first, *second;
+
+    kept = arena_alloc(arena, 16);
+    strcpy(kept, "kept");
+    outer = arena_mark(arena);
+
+    /* Fill several blocks */
+    for (unsigned i = 0; i < 1000; i++) {
+        arena_alloc(arena, 64);
+    }
+    inner = arena_mark(arena);
+    arena_alloc(arena, 64);
+    arena_release(arena, inner);
+    assert_ptr_equal(arena->block, inner.block);
+    assert_int_equal(arena->used, inner.used);
+
+    /* Releasing to the outer mark keeps the blocks for reuse */
+    arena_release(arena, outer);
+    assert_ptr_equal(arena->block, outer.block);
+    assert_non_null(arena->spare);
+    assert_string_equal(kept, "kept");
+
+    /* Memory after the mark is handed out again */
+    first = arena_alloc(arena, 64);
+    arena_release(arena, outer);
+    second = arena_alloc(arena, 64);
+    assert_ptr_equal(first, second);
+
+    /* A new block is taken from the spare ones */
+    block = arena->spare;
+    while (arena->block == outer.block) {
+        arena_alloc(arena, 64);
+    }
+    assert_ptr_equal(arena->block, block);
+    arena_release(arena, outer);
+}
+
+static void test_sll_arena(void **state)
+{
+    arena_s *arena = *state;
+    arena_mark_s mark = arena_mark(arena);
+    sll_s list;
+    int values[10];
+
+    sll_init_arena(&list, arena);
+    for (int i = 0; i < 10; i++) {
+        values[i] = i;
+        sll_insert_last(&list, &values[i]);
+    }
+    assert_int_equal(sll_get_length(&list), 10);
+    assert_int_equal(*(int *)sll_get_head(&list), 0);
+    assert_int_equal(*(int *)sll_get_last(&list), 9);
+
+    sll_delete_head(&list, false);
+    sll_delete_last(&list, false);
+    assert_int_equal(sll_get_length(&list), 8);
+    assert_int_equal(*(int *)sll_get_head(&list), 1);
+    assert_int_equal(*(int *)sll_get_last(&list), 8);
+
+    /* The list stays in the arena after being destroyed */
+    sll_destroy(&list, false);
+    assert_true(sll_is_empty(&list));
+    assert_ptr_equal(list.arena, arena);
+    arena_release(arena, mark);
+}
+
+static void test_avl_arena(void **state)
+{
+    arena_s *arena = *state;
+    arena_mark_s mark = arena_mark(arena);
+    avl_node_s *tree = NULL;
+    char keys[100][8];
+    void *value;
+
+    for (int i = 0; i < 100; i++) {
+        int *number = malloc(sizeof *number);
+        assert_non_null(number);
+        *number = i;
+        sprintf(keys[i], "k%d", i);
+        avl_insert_arena(&tree, keys[i], number, arena);
+    }
+
+    for (int i = 0; i < 100; i++) {
+        assert_true(avl_search(tree, keys[i], &value));
+        assert_int_equal(*(int *)value, i);
+    }
+    assert_true(tree->height <= 8);
+
+    /* Values are freed, nodes are left to the arena */
+    avl_release(&tree, NULL);
+    assert_null(tree);
+    arena_release(arena, mark);
+}
+
+int main(void)
+{
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_alloc),
+        cmocka_unit_test(test_release),
+        cmocka_unit_test(test_sll_arena),
+        cmocka_unit_test(test_avl_arena),
+    };
+    return cmocka_run_group_tests(tests, local_setup, local_teardown);
+}
@@ -9,6 +9,7 @@
 #include <stdarg.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -50,6 +51,39 @@ static int avl_node_get_balance(avl_node_s *node)
     return 0;
 }
 
+/**
+ * @brief Check the order, the heights and the balance of all the nodes of a tree.
+ *
+ * @param[in] node The root of the tree.
+ * @param[in] count Number of nodes the tree should have.
+ */
+static void avl_check_tree(avl_node_s *node, unsigned count)
+{
+    avl_node_s *stack[AVL_MAX_HEIGHT], *previous = NULL;
+    unsigned depth = 0, visited = 0;
+
+    /* In-order traversal, every key must be greater than the previous one */
+    while (node || depth) {
+        while (node) {
+            int left = node->left ? node->left->height : 0;
+            int right = node->right ? node->right->height : 0;
+            assert_int_equal(node->height, MAX(left, right) + 1);
+            assert_true(ABS(avl_node_get_balance(node)) <= 1);
+            assert_int_equal(node->length, strlen(node->key));
+            stack[depth++] = node;
+            node = node->left;
+        }
+        node = stack[--depth];
+        if (previous) {
+            assert_true(strcmp(previous->key, node->key) < 0);
+        }
+        previous = node;
+        visited++;
+        node = node->right;
+    }
+    assert_int_equal(visited, count);
+}
+
 static int global_setup(void **state)
 {
     ts_s *ts;
@@ -376,6 +410,136 @@ static void test_destroy(void **state)
     assert_null(ts->node);
 }
 
+static void do_nothing(void *data)
+{
+    (void)data;
+}
+
+static void test_prefix(void **state)
+{
+    /* Keys equal in or shorter than the prefix, high bytes and a common start */
+    static const char *keys[] = { "", "a", "abcdefg", "abcdefgh", "abcdefgh_1", "abcdefgh_2",
+        "abcdefghi", "abcdefgi", "b", "\x80", "\xff\xff\xff\xff\xff\xff\xff\xff\xff" };
+    const unsigned count = sizeof keys / sizeof *keys;
+    avl_node_s *tree = NULL;
+    char copy[16];
+    void *value;
+
+    (void)state;
+    /* Insert in reverse order, compare copies so the pointers are not equal */
+    for (unsigned i = count; i-- > 0;) {
+        avl_insert(&tree, keys[i], &keys[i]);
+    }
+    avl_check_tree(tree, count);
+    for (unsigned i = 0; i < count; i++) {
+        strcpy(copy, keys[i]);
+        assert_true(avl_search(tree, copy, &value));
+        assert_ptr_equal(value, &keys[i]);
+    }
+    assert_false(avl_search(tree, "abcdefgh_", NULL));
+    assert_false(avl_search(tree, "abcdefgh_3", NULL));
+    assert_false(avl_search(tree, "abcdef", NULL));
+
+    /* Deleting moves the prefix along with the key */
+    assert_true(avl_delete(&tree, "abcdefgh_1", do_nothing));
+    assert_true(avl_delete(&tree, "abcdefgh", do_nothing));
+    avl_check_tree(tree, count - 2);
+    assert_true(avl_search(tree, "abcdefgh_2", NULL));
+    assert_false(avl_search(tree, "abcdefgh", NULL));
+
+    avl_destroy(&tree, do_nothing);
+}
+
+static void test_pool(void **state)
+{
+    static char keys[2000][16];
+    avl_node_s *tree = NULL;
+    avl_pool_s pool;
+    void *value;
+
+    (void)state;
+    avl_pool_init(&pool);
+    for (int i = 0; i < 2000; i++) {
+        sprintf(keys[i], "variable_%d", (i * 7919) % 2000);
+        avl_insert_pool(&tree, keys[i], keys[i], &pool);
+    }
+    avl_check_tree(tree, 2000);
+
+    /* Delete every other key, the nodes go back to the pool */
+    for (int i = 0; i < 2000; i += 2) {
+        assert_true(avl_delete_pool(&tree, keys[i], do_nothing, &pool));
+    }
+    assert_false(avl_delete_pool(&tree, keys[0], do_nothing, &pool));
+    avl_check_tree(tree, 1000);
+    assert_non_null(pool.free);
+
+    /* Deleted nodes are reused before new ones */
+    for (int i = 0; i < 2000; i += 2) {
+        avl_insert_pool(&tree, keys[i], keys[i], &pool);
+    }
+    assert_null(pool.free);
+    avl_check_tree(tree, 2000);
+    for (int i = 0; i < 2000; i++) {
+        assert_true(avl_search(tree, keys[i], &value));
+        assert_ptr_equal(value, keys[i]);
+    }
+
+    avl_release(&tree, do_nothing);
+    assert_null(tree);
+    avl_pool_destroy(&pool);
+    assert_null(pool.blocks);
+}
+
+static void test_build(void **state)
+{
+    static char names[1000][16];
+    const char *keys[1000];
+    void *values[1000];
+    avl_node_s *tree = NULL;
+    avl_pool_s pool;
+    void *value;
+
+    (void)state;
+    for (int i = 0; i < 1000; i++) {
+        sprintf(names[i], "key_%04d", i);
+        keys[i] = names[i];
+        values[i] = names[i];
+    }
+
+    /* Every size up to a few levels gives a valid tree */
+    avl_pool_init(&pool);
+    for (unsigned count = 0; count <= 40; count++) {
+        avl_build(&tree, keys, values, count, &pool);
+        avl_check_tree(tree, count);
+        avl_release(&tree, do_nothing);
+    }
+    avl_pool_destroy(&pool);
+
+    /* The nodes are in one block and the tree is as low as possible */
+    avl_build(&tree, keys, values, 1000, &pool);
+    avl_check_tree(tree, 1000);
+    assert_int_equal(tree->height, 10);
+    assert_int_equal(pool.block_size, 1000);
+    assert_ptr_equal(tree, pool.end - 1000);
+    assert_ptr_equal(tree->left, tree + 1);
+    assert_true(avl_search(tree, "key_0999", &value));
+    assert_ptr_equal(value, names[999]);
+
+    /* A built tree can be inserted into */
+    avl_insert_pool(&tree, "key_1000", NULL, &pool);
+    avl_check_tree(tree, 1001);
+    avl_release(&tree, do_nothing);
+    avl_pool_destroy(&pool);
+
+    /* Without a pool the nodes are allocated by malloc */
+    avl_build(&tree, keys, NULL, 1000, NULL);
+    avl_check_tree(tree, 1000);
+    assert_true(avl_search(tree, "key_0500", &value));
+    assert_null(value);
+    avl_destroy(&tree, do_nothing);
+    assert_null(tree);
+}
+
 int main(void)
 {
     const struct CMUnitTest tests[] = {
@@ -391,6 +555,9 @@ int main(void)
         cmocka_unit_test(test_delete_rebalace),
         cmocka_unit_test(test_rl_rotate),
         cmocka_unit_test(test_destroy),
+        cmocka_unit_test(test_prefix),
+        cmocka_unit_test(test_pool),
+        cmocka_unit_test(test_build),
     };
     return cmocka_run_group_tests(tests, global_setup, global_teardown);
 }
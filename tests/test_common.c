@@ -9,6 +9,7 @@
 #include <stddef.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include <cmocka.h>
 
@@ -60,11 +61,43 @@ static void test_source_file(void **arg)
     assert_int_equal(source.no_lines, 0);
 }
 
+static void test_dynamic_string(void **arg)
+{
+    dynamic_string_s ds;
+    const char *long_line = "Time is an illusion. Lunchtime doubly so.";
+
+    (void)arg;
+    ds_init(&ds);
+
+    /* Check if initialized correctly */
+    assert_int_equal(ds.size, 0);
+    assert_string_equal(ds.content, "");
+
+    /* Short strings stay inside the structure */
+    ds_append(&ds, "42 and more", 2);
+    ds_add_char(&ds, '!');
+    assert_int_equal(ds.size, 3);
+    assert_string_equal(ds.content, "42!");
+    assert_ptr_equal(ds.content, ds.buffer);
+
+    /* Longer strings are moved to the heap */
+    ds_append(&ds, long_line, strlen(long_line));
+    assert_int_equal(ds.size, 3 + strlen(long_line));
+    assert_string_equal(ds.content + 3, long_line);
+    assert_ptr_not_equal(ds.content, ds.buffer);
+
+    /* Check if destroyed correctly */
+    ds_destroy(&ds);
+    assert_null(ds.content);
+    assert_int_equal(ds.size, 0);
+}
+
 int main(void)
 {
     const struct CMUnitTest tests[] = {
         cmocka_unit_test(test_better_free),
         cmocka_unit_test(test_source_file),
+        cmocka_unit_test(test_dynamic_string),
     };
     return cmocka_run_group_tests(tests, local_setup, local_teardown);
 }
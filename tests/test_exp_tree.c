@@ -0,0 +1,278 @@
+/**
+ * @file test_exp_tree.c
+ * Projekt: Implementace prekladace imperativniho jazyka IFJ21.
+ * @author Tadeas Vintrlik <xvintr04@stud.fit.vutbr.cz>
+ * @brief Test for the rewrites of expression trees.
+ */
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <cmocka.h>
+
+#include "arena.h"
+#include "exp_tree.h"
+
+static int local_setup(void **state)
+{
+    arena_s *arena = malloc(sizeof *arena);
+
+    if (!arena) {
+        return 1;
+    }
+    arena_init(arena);
+
+    *state = arena;
+    return 0;
+}
+
+static int local_teardown(void **state)
+{
+    arena_s *arena = *state;
+
+    arena_destroy(arena);
+    free(arena);
+
+    return 0;
+}
+
+/**
+ * @brief Create a node in the arena.
+ */
+static expr_node_s *new_node(arena_s *arena, token_type type, symbol_type_e symbol_type,
+    expr_node_s *left, expr_node_s *right)
+{
+    expr_node_s *node = arena_alloc(arena, sizeof *node);
+
+    token_init(&node->token);
+    node->token.type = type;
+    node->token.line = 1;
+    node->left = left;
+    node->right = right;
+    node->type = symbol_type;
+    node->to_number = false;
+    return node;
+}
+
+static expr_node_s *new_integer(arena_s *arena, int64_t value)
+{
+    expr_node_s *node = new_node(arena, TOKEN_INT, SYM_TYPE_INT, NULL, NULL);
+    token_literal_s *literal = arena_alloc(arena, sizeof *literal);
+
+    literal->lexeme = literal->text = "";
+    literal->length = 0;
+    literal->value.integer = value;
+    node->token.handle.literal = literal;
+    return node;
+}
+
+static expr_node_s *new_number(arena_s *arena, double value)
+{
+    expr_node_s *node = new_node(arena, TOKEN_NUMBER, SYM_TYPE_NUMBER, NULL, NULL);
+    token_literal_s *literal = arena_alloc(arena, sizeof *literal);
+
+    literal->lexeme = literal->text = "";
+    literal->length = 0;
+    literal->value.number = value;
+    node->token.handle.literal = literal;
+    return node;
+}
+
+static expr_node_s *new_string(arena_s *arena, const char *text)
+{
+    expr_node_s *node = new_node(arena, TOKEN_STRING, SYM_TYPE_STRING, NULL, NULL);
+    token_literal_s *literal = arena_alloc(arena, sizeof *literal);
+
+    literal->lexeme = literal->text = text;
+    literal->length = strlen(text);
+    literal->value.integer = 0;
+    node->token.handle.literal = literal;
+    return node;
+}
+
+static expr_node_s *new_nil(arena_s *arena)
+{
+    expr_node_s *node = new_node(arena, TOKEN_KEYWORD, SYM_TYPE_NIL, NULL, NULL);
+
+    node->token.keyword = NIL;
+    return node;
+}
+
+static expr_node_s *new_binary(arena_s *arena, token_type op, expr_node_s *left, expr_node_s *right)
+{
+    return new_node(arena, op, SYM_TYPE_NONE, left, right);
+}
+
+static void test_integer(void **state)
+{
+    arena_s *arena = *state;
+    expr_node_s *node;
+
+    /* 60 * 60 * 24 */
+    node = new_binary(arena, TOKEN_MUL, new_integer(arena, 60), new_integer(arena, 60));
+    assert_true(expr_fold(node, arena));
+    node = new_binary(arena, TOKEN_MUL, node, new_integer(arena, 24));
+    assert_true(expr_fold(node, arena));
+    assert_null(node->left);
+    assert_int_equal(node->token.type, TOKEN_INT);
+    assert_int_equal(node->type, SYM_TYPE_INT);
+    assert_int_equal(TOKEN_LITERAL(&node->token).integer, 86400);
+    assert_string_equal(token_value(&node->token), "86400");
+
+    node = new_binary(arena, TOKEN_FLOOR_DIVISION, new_integer(arena, 7), new_integer(arena, 2));
+    assert_true(expr_fold(node, arena));
+    assert_int_equal(TOKEN_LITERAL(&node->token).integer, 3);
+
+    /* Overflows are computed by the interpreter */
+    node = new_binary(arena, TOKEN_MUL, new_integer(arena, INT64_MAX), new_integer(arena, 2));
+    assert_false(expr_fold(node, arena));
+    node = new_binary(arena, TOKEN_SUB, new_integer(arena, INT64_MIN), new_integer(arena, 1));
+    assert_false(expr_fold(node, arena));
+
+    /* Division by zero and negative quotients stay */
+    node = new_binary(arena, TOKEN_FLOOR_DIVISION, new_integer(arena, 7), new_integer(arena, 0));
+    assert_false(expr_fold(node, arena));
+    assert_non_null(node->left);
+    node = new_binary(arena, TOKEN_FLOOR_DIVISION, new_integer(arena, -7), new_integer(arena, 2));
+    assert_false(expr_fold(node, arena));
+}
+
+static void test_number(void **state)
+{
+    arena_s *arena = *state;
+    expr_node_s *node, *left, *right;
+
+    /* 1 / 4 converts both operands */
+    left = new_integer(arena, 1);
+    right = new_integer(arena, 4);
+    left->to_number = right->to_number = true;
+    node = new_binary(arena, TOKEN_DIVISION, left, right);
+    assert_true(expr_fold(node, arena));
+    assert_int_equal(node->token.type, TOKEN_NUMBER);
+    assert_int_equal(node->type, SYM_TYPE_NUMBER);
+    assert_true(TOKEN_LITERAL(&node->token).number == 0.25);
+
+    /* The division by zero fails at run time, the conversion is done anyway */
+    left = new_number(arena, 1.5);
+    right = new_integer(arena, 0);
+    right->to_number = true;
+    node = new_binary(arena, TOKEN_DIVISION, left, right);
+    assert_false(expr_fold(node, arena));
+    assert_int_equal(right->token.type, TOKEN_NUMBER);
+    assert_false(right->to_number);
+
+    node = new_binary(arena, TOKEN_MUL, new_number(arena, 1e308), new_number(arena, 10));
+    assert_false(expr_fold(node, arena));
+}
+
+static void test_string(void **state)
+{
+    arena_s *arena = *state;
+    expr_node_s *node;
+
+    node = new_binary(arena, TOKEN_STRING_CONCAT, new_string(arena, "abc\\032"),
+        new_string(arena, "def"));
+    assert_true(expr_fold(node, arena));
+    assert_int_equal(node->token.type, TOKEN_STRING);
+    assert_string_equal(token_value(&node->token), "abc\\032def");
+
+    node = new_node(arena, TOKEN_STRING_LENGTH, SYM_TYPE_INT, node, NULL);
+    assert_true(expr_fold(node, arena));
+    assert_int_equal(node->token.type, TOKEN_INT);
+    assert_int_equal(TOKEN_LITERAL(&node->token).integer, 7);
+}
+
+static void test_comparison(void **state)
+{
+    arena_s *arena = *state;
+    expr_node_s *node;
+
+    node = new_binary(arena, TOKEN_LESS_THAN, new_integer(arena, 1), new_integer(arena, 2));
+    assert_true(expr_fold(node, arena));
+    assert_int_equal(node->token.type, TOKEN_BOOL);
+    assert_int_equal(node->type, SYM_TYPE_BOOL);
+    assert_string_equal(token_value(&node->token), "true");
+
+    /* Strings are compared by their characters, "\032" is a space before "a" */
+    node = new_binary(arena, TOKEN_GREATER_EQUAL_THAN, new_string(arena, "\\032"),
+        new_string(arena, "a"));
+    assert_true(expr_fold(node, arena));
+    assert_string_equal(token_value(&node->token), "false");
+
+    node = new_binary(arena, TOKEN_EQUAL, new_nil(arena), new_integer(arena, 0));
+    assert_true(expr_fold(node, arena));
+    assert_string_equal(token_value(&node->token), "false");
+    node = new_binary(arena, TOKEN_NOT_EQUAL_TO, new_nil(arena), new_nil(arena));
+    assert_true(expr_fold(node, arena));
+    assert_string_equal(token_value(&node->token), "false");
+
+    /* Different types and ordering of nil are errors of the interpreter */
+    node = new_binary(arena, TOKEN_EQUAL, new_integer(arena, 1), new_number(arena, 1));
+    assert_false(expr_fold(node, arena));
+    node = new_binary(arena, TOKEN_LESS_THAN, new_nil(arena), new_nil(arena));
+    assert_false(expr_fold(node, arena));
+}
+
+static expr_node_s *new_variable(arena_s *arena, symbol_type_e type)
+{
+    expr_node_s *node = new_node(arena, TOKEN_ID, type, NULL, NULL);
+
+    node->token.handle.name = "x";
+    return node;
+}
+
+static void test_simplify(void **state)
+{
+    arena_s *arena = *state;
+    expr_node_s *node, *sum;
+
+    /* (x + x) * 1 is the sum itself */
+    sum = new_node(arena, TOKEN_ADD, SYM_TYPE_INT, new_variable(arena, SYM_TYPE_INT),
+        new_variable(arena, SYM_TYPE_INT));
+    node = new_node(arena, TOKEN_MUL, SYM_TYPE_INT, sum, new_integer(arena, 1));
+    assert_true(expr_simplify(node));
+    assert_int_equal(node->token.type, TOKEN_ADD);
+    assert_non_null(node->right);
+
+    /* A variable may be nil, the addition fails on it then */
+    node = new_node(
+        arena, TOKEN_ADD, SYM_TYPE_INT, new_variable(arena, SYM_TYPE_INT), new_integer(arena, 0));
+    assert_false(expr_simplify(node));
+
+    /* Adding a zero number turns a negative zero into a positive one */
+    node = new_node(arena, TOKEN_ADD, SYM_TYPE_NUMBER, sum, new_number(arena, 0));
+    sum->type = SYM_TYPE_NUMBER;
+    assert_false(expr_simplify(node));
+    node = new_node(arena, TOKEN_SUB, SYM_TYPE_NUMBER, sum, new_number(arena, 0));
+    assert_true(expr_simplify(node));
+    assert_int_equal(node->token.type, TOKEN_ADD);
+
+    node = new_node(arena, TOKEN_STRING_CONCAT, SYM_TYPE_STRING, new_string(arena, ""),
+        new_node(arena, TOKEN_STRING_CONCAT, SYM_TYPE_STRING, new_variable(arena, SYM_TYPE_STRING),
+            new_variable(arena, SYM_TYPE_STRING)));
+    assert_true(expr_simplify(node));
+    assert_int_equal(node->left->token.type, TOKEN_ID);
+
+    /* x * 2 */
+    node = new_node(
+        arena, TOKEN_MUL, SYM_TYPE_INT, new_variable(arena, SYM_TYPE_INT), new_integer(arena, 2));
+    assert_true(expr_simplify(node));
+    assert_int_equal(node->token.type, TOKEN_ADD);
+    assert_int_equal(node->right->token.type, TOKEN_ID);
+}
+
+int main(void)
+{
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_integer),
+        cmocka_unit_test(test_number),
+        cmocka_unit_test(test_string),
+        cmocka_unit_test(test_comparison),
+        cmocka_unit_test(test_simplify),
+    };
+    return cmocka_run_group_tests(tests, local_setup, local_teardown);
+}
@@ -0,0 +1,160 @@
+/**
+ * @file test_exp_values.c
+ * Projekt: Implementace prekladace imperativniho jazyka IFJ21.
+ * @author Tadeas Vintrlik <xvintr04@stud.fit.vutbr.cz>
+ * @brief Test for the table of values computed in a basic block.
+ */
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <cmocka.h>
+
+#include "exp_values.h"
+
+typedef struct state {
+    expr_values_s values;
+    expr_node_s nodes[16];
+    token_literal_s literals[16];
+    unsigned count;
+} state_s;
+
+static int local_setup(void **state)
+{
+    state_s *s = malloc(sizeof *s);
+
+    if (!s) {
+        return 1;
+    }
+    expr_values_init(&s->values);
+    s->count = 0;
+
+    *state = s;
+    return 0;
+}
+
+static int local_teardown(void **state)
+{
+    state_s *s = *state;
+
+    expr_values_destroy(&s->values);
+    free(s);
+
+    return 0;
+}
+
+/**
+ * @brief Create a node and find its value, the values of the operands are found already.
+ */
+static expr_node_s *new_node(
+    state_s *s, token_type type, const char *name, expr_node_s *left, expr_node_s *right)
+{
+    expr_node_s *node = &s->nodes[s->count++];
+
+    token_init(&node->token);
+    node->token.type = type;
+    node->token.handle.name = name;
+    node->left = left;
+    node->right = right;
+    node->to_number = false;
+    node->reuse = false;
+    node->value = expr_values_find(&s->values, node);
+    return node;
+}
+
+static expr_node_s *new_integer(state_s *s, int64_t value)
+{
+    token_literal_s *literal = &s->literals[s->count];
+    expr_node_s *node;
+
+    literal->lexeme = literal->text = "";
+    literal->length = 0;
+    literal->value.integer = value;
+    node = &s->nodes[s->count++];
+    token_init(&node->token);
+    node->token.type = TOKEN_INT;
+    node->token.handle.literal = literal;
+    node->left = node->right = NULL;
+    node->to_number = false;
+    node->value = expr_values_find(&s->values, node);
+    return node;
+}
+
+static void test_same_value(void **state)
+{
+    state_s *s = *state;
+    /* Interned names are compared by the pointer */
+    static const char a[] = "a", b[] = "b";
+    expr_node_s *first, *second;
+
+    expr_values_begin(&s->values, 8);
+    first = new_node(s, TOKEN_ADD, NULL, new_node(s, TOKEN_ID, a, NULL, NULL),
+        new_node(s, TOKEN_ID, b, NULL, NULL));
+    second = new_node(s, TOKEN_ADD, NULL, new_node(s, TOKEN_ID, a, NULL, NULL),
+        new_node(s, TOKEN_ID, b, NULL, NULL));
+    assert_ptr_equal(first->value, second->value);
+
+    /* Operands in a different order or converted are another value */
+    second = new_node(s, TOKEN_ADD, NULL, new_node(s, TOKEN_ID, b, NULL, NULL),
+        new_node(s, TOKEN_ID, a, NULL, NULL));
+    assert_ptr_not_equal(first->value, second->value);
+    assert_ptr_equal(new_integer(s, 1)->value, new_integer(s, 1)->value);
+    assert_ptr_not_equal(new_integer(s, 1)->value, new_integer(s, 2)->value);
+}
+
+static void test_assign(void **state)
+{
+    state_s *s = *state;
+    static const char a[] = "a", x[] = "x";
+    expr_node_s *first, *second;
+
+    expr_values_begin(&s->values, 8);
+    first = new_node(s, TOKEN_MUL, NULL, new_node(s, TOKEN_ID, a, NULL, NULL), new_integer(s, 3));
+    expr_values_assign(&s->values, x, first->value);
+    assert_string_equal(expr_values_variable(&s->values, first->value), "x");
+
+    /* Assigning to x loses the value, assigning to a changes the values computed from it */
+    expr_values_assign(&s->values, x, NULL);
+    assert_null(expr_values_variable(&s->values, first->value));
+    expr_values_assign(&s->values, a, NULL);
+    second = new_node(s, TOKEN_MUL, NULL, new_node(s, TOKEN_ID, a, NULL, NULL), new_integer(s, 3));
+    assert_ptr_not_equal(first->value, second->value);
+}
+
+static void test_temps(void **state)
+{
+    state_s *s = *state;
+    expr_value_s *values[EXP_VALUES_TEMPS + 1];
+
+    expr_values_begin(&s->values, 0);
+    for (int i = 0; i < EXP_VALUES_TEMPS; i++) {
+        values[i] = new_integer(s, i)->value;
+        assert_int_equal(expr_values_reserve(&s->values, values[i]), i);
+    }
+    /* All the temporaries are needed by the current expression */
+    values[EXP_VALUES_TEMPS] = new_integer(s, EXP_VALUES_TEMPS)->value;
+    assert_int_equal(expr_values_reserve(&s->values, values[EXP_VALUES_TEMPS]), -1);
+
+    /* The next expression takes the least recently used one */
+    expr_values_begin(&s->values, 0);
+    assert_int_equal(expr_values_reserve(&s->values, values[0]), 0);
+    assert_int_equal(expr_values_reserve(&s->values, values[EXP_VALUES_TEMPS]), 1);
+    assert_int_equal(expr_values_temp(&s->values, values[1]), -1);
+
+    /* A call of a function overwrites them */
+    expr_values_call(&s->values);
+    assert_int_equal(expr_values_temp(&s->values, values[0]), -1);
+}
+
+int main(void)
+{
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test_setup_teardown(test_same_value, local_setup, local_teardown),
+        cmocka_unit_test_setup_teardown(test_assign, local_setup, local_teardown),
+        cmocka_unit_test_setup_teardown(test_temps, local_setup, local_teardown),
+    };
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,122 @@
+/**
+ * @file test_htable.c
+ * Projekt: Implementace prekladace imperativniho jazyka IFJ21.
+ * @author Tadeas Vintrlik <xvintr04@stud.fit.vutbr.cz>
+ * @brief Test for the functionality of the hash table.
+ */
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <cmocka.h>
+
+#include "htable.h"
+
+/* Keys of the table are interned names */
+static intern_s names;
+
+static const char *name(const char *key) { return intern_string(&names, key, strlen(key)); }
+
+static int local_setup(void **state)
+{
+    htable_s *htable = malloc(sizeof *htable);
+
+    if (!htable) {
+        return 1;
+    }
+    htable_init(htable);
+
+    *state = htable;
+    return 0;
+}
+
+static int local_teardown(void **state)
+{
+    htable_s *htable = *state;
+
+    htable_destroy(htable, NULL);
+    if (htable->table || htable->count) {
+        return 1;
+    }
+    free(htable);
+    intern_destroy(&names);
+
+    return 0;
+}
+
+static int *new_value(int number)
+{
+    int *value = malloc(sizeof *value);
+    assert_non_null(value);
+    *value = number;
+    return value;
+}
+
+static void test_search_empty(void **state)
+{
+    htable_s *htable = *state;
+
+    assert_false(htable_search(htable, name("random-key"), NULL));
+}
+
+static void test_insert(void **state)
+{
+    htable_s *htable = *state;
+    int *value, *other;
+
+    value = new_value(1);
+    htable_insert(htable, name("write"), value);
+    assert_int_equal(htable->count, 1);
+
+    /* The same name interned from another place of the source is the same key */
+    assert_true(htable_search(htable, intern_string(&names, "writes", 5), (void **)&other));
+    assert_ptr_equal(other, value);
+    assert_false(htable_search(htable, name("writ"), NULL));
+    assert_false(htable_search(htable, name("writes"), NULL));
+
+    /* Inserting the key again replaces the value */
+    other = new_value(2);
+    htable_insert(htable, name("write"), other);
+    assert_int_equal(htable->count, 1);
+    assert_true(htable_search(htable, name("write"), (void **)&value));
+    assert_int_equal(*value, 2);
+}
+
+static void test_many(void **state)
+{
+    htable_s *htable = *state;
+    static const char *keys[5000];
+    char key[32];
+    unsigned count = htable->count;
+    int *value;
+
+    /* Enough keys to grow the table several times */
+    for (int i = 0; i < 5000; i++) {
+        sprintf(key, "function_%d", i);
+        keys[i] = name(key);
+        htable_insert(htable, keys[i], new_value(i));
+    }
+    assert_int_equal(htable->count, count + 5000);
+    assert_true(4 * htable->count <= 3 * htable->capacity);
+
+    for (int i = 0; i < 5000; i++) {
+        assert_true(htable_search(htable, keys[i], (void **)&value));
+        assert_int_equal(*value, i);
+    }
+    assert_false(htable_search(htable, name("function_5000"), NULL));
+    assert_true(htable_search(htable, name("write"), NULL));
+}
+
+int main(void)
+{
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_search_empty),
+        cmocka_unit_test(test_insert),
+        cmocka_unit_test(test_many),
+    };
+    return cmocka_run_group_tests(tests, local_setup, local_teardown);
+}
@@ -0,0 +1,116 @@
+/**
+ * @file test_intern.c
+ * Projekt: Implementace prekladace imperativniho jazyka IFJ21.
+ * @author Tadeas Vintrlik <xvintr04@stud.fit.vutbr.cz>
+ * @brief Test for the functionality of the pool of interned names.
+ */
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <cmocka.h>
+
+#include "common.h"
+#include "intern.h"
+
+static int local_setup(void **state)
+{
+    intern_s *pool = malloc(sizeof *pool);
+
+    if (!pool) {
+        return 1;
+    }
+    intern_init(pool);
+
+    *state = pool;
+    return 0;
+}
+
+static int local_teardown(void **state)
+{
+    intern_s *pool = *state;
+
+    intern_destroy(pool);
+    if (pool->table || pool->count) {
+        return 1;
+    }
+    free(pool);
+
+    return 0;
+}
+
+static void test_intern_equal(void **state)
+{
+    intern_s *pool = *state;
+    const char source[] = "local counter : integer = counter + 1";
+    const char *first, *second;
+
+    /* Names do not need to be null terminated */
+    first = intern_string(pool, source + 6, 7);
+    assert_string_equal(first, "counter");
+
+    /* The same name is always the same pointer */
+    second = intern_string(pool, source + 26, 7);
+    assert_ptr_equal(first, second);
+    assert_int_equal(pool->count, 1);
+
+    /* A different name is a different pointer */
+    second = intern_string(pool, source + 16, 7);
+    assert_string_equal(second, "integer");
+    assert_ptr_not_equal(first, second);
+    assert_int_equal(pool->count, 2);
+
+    /* A prefix is a different name */
+    second = intern_string(pool, "count", 5);
+    assert_string_equal(second, "count");
+    assert_ptr_not_equal(first, second);
+}
+
+static void test_intern_many(void **state)
+{
+    intern_s *pool = *state;
+    const char *names[2000];
+    char name[32];
+    unsigned count = pool->count;
+
+    /* Enough names to grow the table and to fill several blocks */
+    for (unsigned i = 0; i < 2000; i++) {
+        sprintf(name, "identifier_number_%u", i);
+        names[i] = intern_string(pool, name, strlen(name));
+    }
+    assert_int_equal(pool->count, count + 2000);
+
+    /* Names stored earlier stay valid and are found again */
+    for (unsigned i = 0; i < 2000; i++) {
+        sprintf(name, "identifier_number_%u", i);
+        assert_string_equal(names[i], name);
+        assert_ptr_equal(intern_string(pool, name, strlen(name)), names[i]);
+    }
+    assert_int_equal(pool->count, count + 2000);
+}
+
+static void test_intern_hash(void **state)
+{
+    intern_s *pool = *state;
+    const char *name;
+
+    /* The hash is kept with the name for any length and alignment of the names before it */
+    for (unsigned length = 1; length < 20; length++) {
+        name = intern_string(pool, "abcdefghijklmnopqrstuvwxyz", length);
+        assert_int_equal(intern_hash(name), hash_name(name, length));
+    }
+}
+
+int main(void)
+{
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_intern_equal),
+        cmocka_unit_test(test_intern_many),
+        cmocka_unit_test(test_intern_hash),
+    };
+    return cmocka_run_group_tests(tests, local_setup, local_teardown);
+}
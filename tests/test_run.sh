@@ -2,7 +2,7 @@
 echo "$0"
 for file in $(ls -A)
 do
-    if [ -f "$file" ]&&[ -x "$file" ]&&[ "$file" != "test_run.sh" ]
+    if [ -f "$file" ]&&[ -x "$file" ]&&[ "$file" != "test_run.sh" ]&&[ "${file#bench_}" = "$file" ]
     then
         echo "=== Running $file ==="
         ./"$file"
@@ -319,6 +319,45 @@ static void test_last(void **state)
     assert_int_equal(0, sll_get_length(list));
 }
 
+static void test_tail(void **state)
+{
+    ts_s *ts = *state;
+    sll_s *list = ts->list;
+    int values[4] = { 0, 1, 2, 3 };
+    sll_elem_s *spare;
+
+    /* The tail follows inserts and deletes in the middle of the list */
+    sll_insert_head(list, &values[1]);
+    sll_activate(list);
+    sll_insert_after(list, &values[3]);
+    assert_ptr_equal(sll_get_last(list), &values[3]);
+    sll_insert_after(list, &values[2]);
+    sll_insert_head(list, &values[0]);
+    assert_int_equal(sll_get_length(list), 4);
+    assert_ptr_equal(sll_get_last(list), &values[3]);
+
+    sll_next(list);
+    sll_delete_after(list, false);
+    assert_ptr_equal(sll_get_last(list), &values[2]);
+    assert_int_equal(sll_get_length(list), 3);
+
+    /* Deleted elements are reused */
+    spare = list->spare;
+    assert_non_null(spare);
+    sll_insert_last(list, &values[3]);
+    assert_ptr_equal(list->tail, spare);
+    assert_null(list->spare);
+    assert_int_equal(sll_get_length(list), 4);
+
+    /* An empty list keeps nothing */
+    while (!sll_is_empty(list)) {
+        sll_delete_last(list, false);
+    }
+    assert_null(list->tail);
+    assert_null(list->spare);
+    assert_int_equal(sll_get_length(list), 0);
+}
+
 int main(void)
 {
     const struct CMUnitTest tests[] = {
@@ -333,6 +372,7 @@ int main(void)
         cmocka_unit_test_setup_teardown(test_after, setup_list_three, teardown_list_three),
         cmocka_unit_test_setup(test_length, setup_list_three),
         cmocka_unit_test_setup(test_last, setup_list_three),
+        cmocka_unit_test(test_tail),
     };
     return cmocka_run_group_tests(tests, local_setup, local_teardown);
 }
@@ -21,6 +21,9 @@ typedef struct state {
     symtable_s *symtable;
 } st_s;
 
+/* Names are looked up interned, as the scanner passes them */
+static const char *name(const char *key) { return intern_string(&test_names, key, strlen(key)); }
+
 static int local_setup(void **state)
 {
     st_s *st;
@@ -33,7 +36,7 @@ static int local_setup(void **state)
     if (!st->symtable) {
         return 1;
     }
-    symtable_init(st->symtable);
+    symtable_init(st->symtable, &test_names);
     if (!st->symtable) {
         return 1;
     }
@@ -47,7 +50,7 @@ static int local_teardown(void **state)
     st_s *st = *state;
 
     symtable_destroy(st->symtable);
-    if (st->symtable->global) {
+    if (st->symtable->global.table) {
         return 1;
     }
     free(st->symtable);
@@ -60,40 +63,46 @@ static void test_search_empty(void **state)
 {
     st_s *st = *state;
 
-    assert_false(symtable_search_all(st->symtable, "random-key", NULL));
-    assert_false(symtable_search_top(st->symtable, "random-key", NULL));
-    assert_false(symtable_search_global(st->symtable, "random-key", NULL));
+    assert_false(symtable_search_all(st->symtable, name("random-key"), NULL));
+    assert_false(symtable_search_top(st->symtable, name("random-key"), NULL));
+    assert_false(symtable_search_global(st->symtable, name("random-key"), NULL));
 }
 
 static void test_insert(void **state)
 {
     st_s *st = *state;
-    T_token *token, *out;
+    T_token *token;
+    symbol_s *symbol, *out;
 
-    /* Create and insert a new token into global frame */
+    /* Create and insert a new function into global frame */
     token = create_token("func1", TOKEN_ID);
-    symtable_insert_token_global(st->symtable, token);
-
-    /* Should find it in global frame */
-    assert_true(symtable_search_global(st->symtable, "func1", &out));
-    assert_int_equal(out->type, TOKEN_ID);
-    assert_string_equal(out->value->content, "func1");
+    token->line = 3;
+    symbol = symtable_insert_function(st->symtable, token, true);
+    token_destroy(token);
+
+    /* Should find its record in global frame */
+    assert_true(symtable_search_global(st->symtable, name("func1"), &out));
+    assert_ptr_equal(out, symbol);
+    assert_string_equal(out->name, "func1");
+    assert_int_equal(out->line, 3);
+    assert_true(out->fun_info.defined);
+    assert_true(tstack_empty(out->fun_info.in_params));
 
     /* Should not find it in all frames since it is just for variables */
-    assert_false(symtable_search_all(st->symtable, "func1", &out));
-    assert_int_equal(out->type, TOKEN_ID);
-    assert_string_equal(out->value->content, "func1");
+    assert_false(symtable_search_all(st->symtable, name("func1"), NULL));
 
     token = create_token("func2", TOKEN_ID);
-    symtable_insert_token_global(st->symtable, token);
+    symtable_insert_function(st->symtable, token, false);
+    token_destroy(token);
 
     token = create_token("main", TOKEN_ID);
-    symtable_insert_token_global(st->symtable, token);
+    symtable_insert_function(st->symtable, token, true);
+    token_destroy(token);
 
     /* None of the functions should be in variable frames */
-    assert_false(symtable_search_all(st->symtable, "func1", NULL));
-    assert_false(symtable_search_all(st->symtable, "func2", NULL));
-    assert_false(symtable_search_all(st->symtable, "main", NULL));
+    assert_false(symtable_search_all(st->symtable, name("func1"), NULL));
+    assert_false(symtable_search_all(st->symtable, name("func2"), NULL));
+    assert_false(symtable_search_all(st->symtable, name("main"), NULL));
 }
 
 static void test_new_frame(void **state)
@@ -114,25 +123,25 @@ static void test_new_frame(void **state)
     assert_false(symtable_frames_empty(st->symtable));
 
     /* Searching tokens that are in global frame should not succeed on top */
-    assert_false(symtable_search_top(st->symtable, "main", NULL));
+    assert_false(symtable_search_top(st->symtable, name("main"), NULL));
 
     /* And neither in all since it is just for variables */
-    assert_false(symtable_search_all(st->symtable, "main", NULL));
+    assert_false(symtable_search_all(st->symtable, name("main"), NULL));
 
     /* Create and insert a new token into top frame */
     token = create_token("x", TOKEN_ID);
     symtable_insert_token_top(st->symtable, token);
 
     /* Should find it in top and all frames */
-    assert_true(symtable_search_top(st->symtable, "x", NULL));
-    assert_true(symtable_search_all(st->symtable, "x", NULL));
+    assert_true(symtable_search_top(st->symtable, name("x"), NULL));
+    assert_true(symtable_search_all(st->symtable, name("x"), NULL));
 
     /* But it should not be in global */
-    assert_false(symtable_search_global(st->symtable, "x", NULL));
+    assert_false(symtable_search_global(st->symtable, name("x"), NULL));
 
     /* Insert yet another frame x should not be in top frame now */
     symtable_new_frame(st->symtable);
-    assert_false(symtable_search_top(st->symtable, "x", NULL));
+    assert_false(symtable_search_top(st->symtable, name("x"), NULL));
 }
 
 static void test_pop_frame(void **state)
@@ -150,26 +159,27 @@ static void test_pop_frame(void **state)
 
     /* There still should be a frame but x should be in top frame again */
     assert_false(symtable_frames_empty(st->symtable));
-    assert_true(symtable_search_top(st->symtable, "x", NULL));
+    assert_true(symtable_search_top(st->symtable, name("x"), NULL));
 
     /* Pop once again and there should be none */
     symtable_pop_frame(st->symtable);
     assert_true(symtable_frames_empty(st->symtable));
-    assert_false(symtable_search_top(st->symtable, "x", NULL));
+    assert_false(symtable_search_top(st->symtable, name("x"), NULL));
 
     /* Popping again should do nothing */
     symtable_pop_frame(st->symtable);
     assert_true(symtable_frames_empty(st->symtable));
-    assert_false(symtable_search_top(st->symtable, "x", NULL));
+    assert_false(symtable_search_top(st->symtable, name("x"), NULL));
 
     /* Global tokens (functions) should not be accessible in all since it is just for variables */
-    assert_false(symtable_search_all(st->symtable, "main", NULL));
+    assert_false(symtable_search_all(st->symtable, name("main"), NULL));
 }
 
 static void test_frame_priority(void **state)
 {
     st_s *st = *state;
-    T_token *token, *local, *global;
+    T_token *token, *local;
+    symbol_s *global;
 
     /**
      * Frames: {}
@@ -184,13 +194,14 @@ static void test_frame_priority(void **state)
     token = create_token("func1", TOKEN_ID);
     symtable_insert_token_top(st->symtable, token);
 
-    /* The token found in global and top should not be the same */
-    assert_true(symtable_search_top(st->symtable, "func1", &local));
-    assert_true(symtable_search_global(st->symtable, "func1", &global));
-    assert_int_not_equal(local, global);
+    /* The variable and the function are kept apart */
+    assert_true(symtable_search_top(st->symtable, name("func1"), &local));
+    assert_true(symtable_search_global(st->symtable, name("func1"), &global));
+    assert_ptr_equal(local, token);
+    assert_string_equal(global->name, "func1");
 
     /* The token found in all should be the topmost */
-    assert_true(symtable_search_all(st->symtable, "func1", &token));
+    assert_true(symtable_search_all(st->symtable, name("func1"), &token));
     assert_int_equal(token, local);
 }
 
@@ -224,6 +235,52 @@ static void test_frames_depth(void **state)
     assert_true(symtable_frames_empty(st->symtable));
 }
 
+static void test_shadowing(void **state)
+{
+    st_s *st = *state;
+    T_token *outer, *inner, *other, *again, *out;
+
+    /**
+     * Frames: {}
+     * Global: {func1, func2, main}
+     */
+
+    outer = create_token("x", TOKEN_ID);
+    inner = create_token("x", TOKEN_ID);
+    other = create_token("y", TOKEN_ID);
+
+    symtable_new_frame(st->symtable);
+    symtable_insert_token_top(st->symtable, outer);
+
+    /* The innermost declaration is found, even from deeper frames */
+    symtable_new_frame(st->symtable);
+    symtable_insert_token_top(st->symtable, inner);
+    symtable_insert_token_top(st->symtable, other);
+    symtable_new_frame(st->symtable);
+    assert_true(symtable_search_all(st->symtable, name("x"), &out));
+    assert_ptr_equal(out, inner);
+    assert_false(symtable_search_top(st->symtable, name("x"), NULL));
+    symtable_pop_frame(st->symtable);
+    assert_true(symtable_search_top(st->symtable, name("x"), &out));
+    assert_ptr_equal(out, inner);
+
+    /* Popping the frame brings back the shadowed declaration */
+    symtable_pop_frame(st->symtable);
+    assert_true(symtable_search_all(st->symtable, name("x"), &out));
+    assert_ptr_equal(out, outer);
+    assert_true(symtable_search_top(st->symtable, name("x"), NULL));
+    assert_false(symtable_search_all(st->symtable, name("y"), NULL));
+
+    /* Declaring the name again in the same frame replaces it until the frame is popped */
+    again = create_token("x", TOKEN_ID);
+    symtable_insert_token_top(st->symtable, again);
+    assert_true(symtable_search_top(st->symtable, name("x"), &out));
+    assert_ptr_equal(out, again);
+
+    symtable_pop_frame(st->symtable);
+    assert_false(symtable_search_all(st->symtable, name("x"), NULL));
+}
+
 int main(void)
 {
     const struct CMUnitTest tests[] = {
@@ -233,6 +290,7 @@ int main(void)
         cmocka_unit_test(test_pop_frame),
         cmocka_unit_test(test_frame_priority),
         cmocka_unit_test(test_frames_depth),
+        cmocka_unit_test(test_shadowing),
     };
     return cmocka_run_group_tests(tests, local_setup, local_teardown);
 }
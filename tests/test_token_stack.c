@@ -36,18 +36,18 @@ static void test_simple(void **arg)
     tstack_push(&ts, first);
 
     out = tstack_top(&ts);
-    assert_string_equal(out->value->content, "first");
+    assert_string_equal(token_value(out), "first");
     assert_false(tstack_empty(&ts));
 
     /* Push second token */
     tstack_push(&ts, second);
     out = tstack_top(&ts);
-    assert_string_equal(out->value->content, "second");
+    assert_string_equal(token_value(out), "second");
 
     /* Pop token - should be only one now */
     tstack_pop(&ts, true);
     out = tstack_top(&ts);
-    assert_string_equal(out->value->content, "first");
+    assert_string_equal(token_value(out), "first");
 
     /* Pop the last one, should be empty */
     tstack_pop(&ts, true);
@@ -77,13 +77,13 @@ static void test_terminal_top(void **arg)
     tstack_push(&ts, second);
     out = tstack_terminal_top(&ts);
     assert_non_null(out);
-    assert_string_equal(out->value->content, "second");
+    assert_string_equal(token_value(out), "second");
 
     /* Since we inserted a terminal it should still return the same */
     tstack_push(&ts, third);
     out = tstack_terminal_top(&ts);
     assert_non_null(out);
-    assert_string_equal(out->value->content, "second");
+    assert_string_equal(token_value(out), "second");
 
     tstack_destroy(&ts);
 }
@@ -109,11 +109,11 @@ static void test_terminal_push(void **arg)
     tstack_terminal_push(&ts, in);
 
     out = tstack_top(&ts);
-    assert_string_equal(out->value->content, "in");
+    assert_string_equal(token_value(out), "in");
     tstack_pop(&ts, true);
 
     out = tstack_top(&ts);
-    assert_string_equal(out->value->content, "third");
+    assert_string_equal(token_value(out), "third");
     tstack_pop(&ts, true);
 
     out = tstack_top(&ts);
@@ -121,11 +121,11 @@ static void test_terminal_push(void **arg)
     tstack_pop(&ts, true);
 
     out = tstack_top(&ts);
-    assert_string_equal(out->value->content, "second");
+    assert_string_equal(token_value(out), "second");
     tstack_pop(&ts, true);
 
     out = tstack_top(&ts);
-    assert_string_equal(out->value->content, "first");
+    assert_string_equal(token_value(out), "first");
     tstack_pop(&ts, true);
 
     assert_true(tstack_empty(&ts));
@@ -150,7 +150,7 @@ static void test_terminal_push_advanced(void **arg)
     tstack_terminal_push(&ts, in);
 
     out = tstack_top(&ts);
-    assert_string_equal(out->value->content, "in");
+    assert_string_equal(token_value(out), "in");
     tstack_pop(&ts, true);
 
     out = tstack_top(&ts);
@@ -158,11 +158,11 @@ static void test_terminal_push_advanced(void **arg)
     tstack_pop(&ts, true);
 
     out = tstack_top(&ts);
-    assert_string_equal(out->value->content, "second");
+    assert_string_equal(token_value(out), "second");
     tstack_pop(&ts, true);
 
     out = tstack_top(&ts);
-    assert_string_equal(out->value->content, "first");
+    assert_string_equal(token_value(out), "first");
     tstack_pop(&ts, true);
 
     assert_true(tstack_empty(&ts));
@@ -183,7 +183,7 @@ static void test_terminal_push_empty_stack(void **arg)
     tstack_terminal_push(&ts, in);
 
     out = tstack_top(&ts);
-    assert_string_equal(out->value->content, "in");
+    assert_string_equal(token_value(out), "in");
     tstack_pop(&ts, true);
 
     out = tstack_top(&ts);
@@ -191,6 +191,79 @@ static void test_terminal_push_empty_stack(void **arg)
     tstack_pop(&ts, true);
 }
 
+static void test_value(void **arg)
+{
+    const char source[] = "local abc : string = \"a b\"";
+    token_literal_s literal = { source + 21, 5, "a\\032b", { 0 } };
+    T_token *token, *copy;
+    const char *lexeme;
+
+    (void)arg;
+
+    /* Names of identifiers are interned and null terminated, they are never copied */
+    token = create_token("abc", TOKEN_ID);
+    assert_true(token_equals(token, "abc"));
+    assert_false(token_equals(token, "ab"));
+    assert_false(token_equals(token, "abcd"));
+    assert_int_equal(token_lexeme(token, &lexeme), 3);
+    assert_ptr_equal(lexeme, token_value(token));
+    token_destroy(token);
+
+    /* Literals keep both the value and the lexeme */
+    token = create_token(NULL, TOKEN_STRING);
+    token->handle.literal = &literal;
+    assert_string_equal(token_value(token), "a\\032b");
+    assert_int_equal(token_lexeme(token, &lexeme), 5);
+    assert_memory_equal(lexeme, "\"a b\"", 5);
+
+    /* Copies share the value */
+    copy = token_copy(token);
+    assert_ptr_not_equal(copy, token);
+    assert_ptr_equal(copy->handle.literal, &literal);
+    token_destroy(copy);
+    token_destroy(token);
+
+    /* Operators have no value */
+    token = create_token(NULL, TOKEN_ADD);
+    assert_string_equal(token_value(token), "");
+    assert_int_equal(token_lexeme(token, &lexeme), 0);
+    token_destroy(token);
+}
+
+static void test_pool(void **arg)
+{
+    token_pool_s pool;
+    T_token *tokens[1000], *token;
+
+    (void)arg;
+
+    assert_int_equal(sizeof(T_token), 16);
+
+    /* Tokens from many slabs find their way back to their pool */
+    token_pool_init(&pool);
+    for (int i = 0; i < 1000; i++) {
+        tokens[i] = token_new(&pool);
+        assert_int_equal(tokens[i]->type, TOKEN_ID);
+        tokens[i]->type = TOKEN_EOF;
+    }
+    for (int i = 0; i < 1000; i++) {
+        token_destroy(tokens[i]);
+        assert_ptr_equal(pool.free, tokens[i]);
+    }
+
+    /* Destroyed tokens are reused and initialized again */
+    token = token_new(&pool);
+    assert_ptr_equal(token, tokens[999]);
+    assert_int_equal(token->type, TOKEN_ID);
+    assert_null(token->handle.name);
+
+    /* Copies are allocated from the pool of the original */
+    assert_ptr_equal(token_copy(token), tokens[998]);
+
+    token_pool_destroy(&pool);
+    assert_null(pool.chunks);
+}
+
 int main(void)
 {
     const struct CMUnitTest tests[] = {
@@ -199,6 +272,8 @@ int main(void)
         cmocka_unit_test(test_terminal_push),
         cmocka_unit_test(test_terminal_push_advanced),
         cmocka_unit_test(test_terminal_push_empty_stack),
+        cmocka_unit_test(test_value),
+        cmocka_unit_test(test_pool),
     };
     return cmocka_run_group_tests(tests, NULL, NULL);
 }
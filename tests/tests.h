@@ -8,22 +8,24 @@
 #ifndef _TESTS_H_
 #define _TESTS_H_
 
+#include <string.h>
+
+#include "intern.h"
 #include "token_stack.h"
 
+/* Pool all the tokens of a test are allocated from */
+static token_pool_s test_tokens;
+
+/* Pool the names of the tokens are interned in, like the scanner does */
+static intern_s test_names;
+
 static T_token *create_token(const char *key, token_type type)
 {
     T_token *new;
 
-    new = malloc(sizeof *new);
-    token_init(new);
-
-    for (unsigned i = 0; key[i]; i++) {
-        ds_add_char(new->value, key[i]);
-    }
+    new = token_new(&test_tokens);
+    new->handle.name = key ? intern_string(&test_names, key, strlen(key)) : NULL;
     new->type = type;
-    new->fun_info = malloc(sizeof *new->fun_info);
-    function_info_init(new->fun_info);
-    new->fun_info->defined = true;
 
     return new;
 }
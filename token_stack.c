@@ -7,78 +7,163 @@
 
 #include "token_stack.h"
 
-void token_init(T_token *token)
+/**
+ * @brief Number of slabs cut from one chunk of memory. One more slab is allocated for alignment.
+ */
+#define TOKEN_SLABS_PER_CHUNK 15
+
+/**
+ * @brief Get the pool a token was allocated from.
+ *
+ * @param[in] token The token.
+ *
+ * @return The pool.
+ */
+static token_pool_s *token_pool_of(const T_token *token)
+{
+    uintptr_t slab = (uintptr_t)token & ~(uintptr_t)(TOKEN_SLAB_SIZE - 1);
+    return ((token_slab_s *)slab)->pool;
+}
+
+/**
+ * @brief Start a new slab of tokens. Allocates a new chunk of slabs if the current one is used up.
+ *
+ * @param[in,out] pool The pool.
+ */
+static void token_pool_new_slab(token_pool_s *pool)
 {
-    token->value = malloc(sizeof(dynamic_string_s));
-    ALLOC_CHECK(token->value);
+    token_slab_s *slab;
+    char *chunk;
+    uintptr_t first;
+
+    if (pool->slab_next == pool->slab_end) {
+        chunk = malloc((TOKEN_SLABS_PER_CHUNK + 1) * TOKEN_SLAB_SIZE);
+        ALLOC_CHECK(chunk);
+        *(void **)chunk = pool->chunks;
+        pool->chunks = chunk;
+
+        /* The first aligned slab after the link */
+        first = ((uintptr_t)chunk + sizeof(void *) + TOKEN_SLAB_SIZE - 1)
+            & ~(uintptr_t)(TOKEN_SLAB_SIZE - 1);
+        pool->slab_next = chunk + (first - (uintptr_t)chunk);
+        pool->slab_end = pool->slab_next + TOKEN_SLABS_PER_CHUNK * TOKEN_SLAB_SIZE;
+    }
 
-    ds_init(token->value);
+    slab = (token_slab_s *)pool->slab_next;
+    slab->pool = pool;
+    pool->next = (T_token *)slab + 1;
+    pool->end = (T_token *)slab + TOKEN_SLAB_SIZE / sizeof(T_token);
+    pool->slab_next += TOKEN_SLAB_SIZE;
+}
 
-    token->type = TOKEN_ID;
-    token->line = 0;
-    token->symbol_type = SYM_TYPE_NONE;
-    token->fun_info = NULL;
+void token_pool_init(token_pool_s *pool)
+{
+    pool->free = NULL;
+    pool->next = NULL;
+    pool->end = NULL;
+    pool->slab_next = NULL;
+    pool->slab_end = NULL;
+    pool->chunks = NULL;
 }
 
-T_token *token_copy(T_token *original)
+void token_pool_destroy(token_pool_s *pool)
 {
-    T_token *result = malloc(sizeof(T_token));
-    ALLOC_CHECK(result);
+    void *previous;
 
-    token_init(result);
+    while (pool->chunks) {
+        previous = *(void **)pool->chunks;
+        FREE(pool->chunks);
+        pool->chunks = previous;
+    }
+    token_pool_init(pool);
+}
 
-    result->line = original->line;
-    result->symbol_type = original->symbol_type;
-    result->type = original->type;
+T_token *token_new(token_pool_s *pool)
+{
+    T_token *token;
 
-    for (unsigned i = 0; i < original->value->size; i++) {
-        ds_add_char(result->value, original->value->content[i]);
+    if (pool->free) {
+        token = pool->free;
+        pool->free = token->handle.next;
+    } else {
+        if (pool->next == pool->end) {
+            token_pool_new_slab(pool);
+        }
+        token = pool->next++;
     }
 
-    // NOTE: Assuming this won't ever be used for function symbols/tokens
-    assert(original->fun_info == NULL);
+    token_init(token);
+    return token;
+}
 
-    return result;
+void token_init(T_token *token)
+{
+    token->type = TOKEN_ID;
+    token->keyword = NO_KEYWORD;
+    token->symbol_type = SYM_TYPE_NONE;
+    token->line = 0;
+    token->handle.name = NULL;
 }
 
-void function_info_init(function_info_s *fun_info)
+T_token *token_copy(const T_token *original)
 {
-    fun_info->defined = false;
+    T_token *result = token_new(token_pool_of(original));
 
-    fun_info->in_params = malloc(sizeof(sll_s));
-    ALLOC_CHECK(fun_info->in_params);
-    sll_init(fun_info->in_params);
+    /* The value is shared, it lives as long as the scanner */
+    *result = *original;
+    return result;
+}
 
-    fun_info->out_params = malloc(sizeof(sll_s));
-    ALLOC_CHECK(fun_info->out_params);
-    sll_init(fun_info->out_params);
+const char *token_value(const T_token *token)
+{
+    switch (token->type) {
+    case TOKEN_INT:
+    case TOKEN_NUMBER:
+    case TOKEN_STRING:
+    case TOKEN_BOOL:
+        return token->handle.literal->text;
+    default:
+        return token->handle.name ? token->handle.name : "";
+    }
 }
 
-static void function_info_destroy(function_info_s *fun_info)
+unsigned token_lexeme(const T_token *token, const char **lexeme)
 {
-    if (!fun_info) {
-        return;
+    switch (token->type) {
+    case TOKEN_INT:
+    case TOKEN_NUMBER:
+    case TOKEN_STRING:
+    case TOKEN_BOOL:
+        *lexeme = token->handle.literal->lexeme;
+        return token->handle.literal->length;
+    default:
+        *lexeme = token_value(token);
+        return strlen(*lexeme);
     }
+}
 
-    tstack_destroy(fun_info->in_params);
-    tstack_destroy(fun_info->out_params);
+bool token_equals(const T_token *token, const char *str)
+{
+    return !strcmp(token_value(token), str);
 }
 
 void token_destroy(T_token *token)
 {
+    token_pool_s *pool;
+
     if (!token) {
         return;
     }
-    ds_destroy(token->value);
-    function_info_destroy(token->fun_info);
 
-    FREE(token->value);
-    FREE(token->fun_info);
-    FREE(token);
+    pool = token_pool_of(token);
+    token->handle.next = pool->free;
+    pool->free = token;
 }
 
 void tstack_init(tstack_s *tstack) { sll_init((sll_s *)tstack); }
 
+void tstack_init_arena(tstack_s *tstack, arena_s *arena) { sll_init_arena((sll_s *)tstack, arena); }
+
 tstack_s *tstack_copy(tstack_s *original)
 {
     tstack_s *result = malloc(sizeof(tstack_s));
@@ -151,12 +236,16 @@ void tstack_destroy(tstack_s *tstack)
     }
 }
 
-static T_token *create_handle(void)
+/**
+ * @brief Create a handle token in the pool of another token.
+ *
+ * @param[in] token Token from the pool to use.
+ *
+ * @return The handle.
+ */
+static T_token *create_handle(const T_token *token)
 {
-    T_token *handle = malloc(sizeof *handle);
-    ALLOC_CHECK(handle);
-
-    token_init(handle);
+    T_token *handle = token_new(token_pool_of(token));
 
     handle->type = TOKEN_HANDLE;
     handle->line = -1;
@@ -171,7 +260,7 @@ void tstack_terminal_push(tstack_s *tstack, T_token *token)
         return;
     }
 
-    handle = create_handle();
+    handle = create_handle(token);
     tmp = tstack_top(tstack);
     tstack_pop(tstack, false);
     if (tmp) {
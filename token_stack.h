@@ -15,6 +15,7 @@
 #include "sll.h"
 #include "string.h"
 #include <assert.h>
+#include <stdint.h>
 
 /**
  * @brief Token stack structure.
@@ -50,9 +51,32 @@ typedef enum {
     TOKEN_COLON,
     TOKEN_EOF,
     TOKEN_HANDLE, /* Special token used for expression analysis */
-    TOKEN_NON_TERMINAL, /* Special token used for expression analysis */
+    TOKEN_NON_TERMINAL, /* Special token used for expression analysis */
+    TOKEN_BOOL, /* Result of a folded comparison, never scanned */
 } token_type;
 
+/**
+ * @brief Enum for all the keywords.
+ */
+typedef enum {
+    DO,
+    ELSE,
+    END,
+    FUNCTION,
+    GLOBAL,
+    IF,
+    INTEGER,
+    LOCAL,
+    NIL,
+    NUMBER,
+    REQUIRE,
+    RETURN,
+    STRING,
+    THEN,
+    WHILE,
+    NO_KEYWORD /* Token is not a keyword */
+} Keyword;
+
 typedef enum {
     SYM_TYPE_NONE,
     SYM_TYPE_STRING,
@@ -63,24 +87,99 @@ typedef enum {
     SYM_TYPE_FUNCTION
 } symbol_type_e;
 
-typedef struct function_info {
-    tstack_s *in_params;
-    tstack_s *out_params;
-    bool defined;
-} function_info_s;
+/**
+ * @brief Binary value of a numeric literal.
+ */
+typedef union literal {
+    int64_t integer; /* Value of TOKEN_INT */
+    double number; /* Value of TOKEN_NUMBER */
+} literal_u;
 
 /**
- * @brief Structure for storing a token
+ * @brief Value of a literal. Created once by the scanner and shared by all copies of the token,
+ * valid until the scanner is destroyed.
  */
-typedef struct Token {
-    token_type type;
-    dynamic_string_s *value;
-    int line;
+typedef struct token_literal {
+    const char *lexeme; /* The literal as written in the source, not null terminated */
+    unsigned length; /* Length of the lexeme */
+    const char *text; /* Null terminated value, string values are encoded for IFJcode21 */
+    literal_u value; /* Binary value of a numeric literal */
+} token_literal_s;
 
-    symbol_type_e symbol_type;
-    function_info_s *fun_info;
+/**
+ * @brief Handle of the value of a token. Which member is used follows from the type of the token.
+ */
+typedef union token_handle {
+    const char *name; /* Interned name of TOKEN_ID, spelling of TOKEN_KEYWORD, NULL otherwise */
+    const token_literal_s *literal; /* Value of TOKEN_INT, TOKEN_NUMBER, TOKEN_STRING, TOKEN_BOOL */
+    struct Token *next; /* Next free token in the pool */
+} token_handle_u;
+
+/**
+ * @brief Structure for storing a token. Kept at 16 bytes, everything that does not fit is behind
+ * the handle.
+ */
+typedef struct Token {
+    uint8_t type; /* token_type */
+    uint8_t keyword; /* Keyword */
+    uint8_t symbol_type; /* symbol_type_e */
+    int32_t line;
+    token_handle_u handle;
 } T_token;
 
+/**
+ * @brief Binary value of a numeric literal token.
+ */
+#define TOKEN_LITERAL(token) ((token)->handle.literal->value)
+
+/**
+ * @brief Size of a slab of tokens, a power of two. Slabs are aligned to their size, so the slab
+ * and the pool of a token are found from its address.
+ */
+#define TOKEN_SLAB_SIZE 4096
+
+/**
+ * @brief Header of a slab of tokens. Takes the place of the first token in the slab.
+ */
+typedef struct token_slab {
+    struct token_pool *pool;
+} token_slab_s;
+
+/**
+ * @brief Pool tokens are allocated from. Destroyed tokens are kept on a free list and reused.
+ */
+typedef struct token_pool {
+    T_token *free; /* Free list linked through the handles */
+    T_token *next; /* Next never used token of the current slab */
+    T_token *end; /* End of the current slab */
+    char *slab_next; /* Next unused slab of the current chunk */
+    char *slab_end; /* End of the current chunk */
+    void *chunks; /* Memory the slabs are cut from, linked through the first pointer */
+} token_pool_s;
+
+/**
+ * @brief Initialize an empty pool. Does not allocate anything.
+ *
+ * @param[out] pool The pool to initialize.
+ */
+void token_pool_init(token_pool_s *pool);
+
+/**
+ * @brief Free the pool and all the tokens allocated from it.
+ *
+ * @param[in,out] pool The pool to destroy.
+ */
+void token_pool_destroy(token_pool_s *pool);
+
+/**
+ * @brief Allocate an initialized token from the pool.
+ *
+ * @param[in,out] pool The pool.
+ *
+ * @return The new token.
+ */
+T_token *token_new(token_pool_s *pool);
+
 /**
  * @brief Initializes a token structure.
  *
@@ -89,23 +188,42 @@ typedef struct Token {
 void token_init(T_token *token);
 
 /**
- * @brief Creates a new token and copies the contents of the provided token into it.
- * WARNING: Assumes original->fun_info is NULL (should never be used).
+ * @brief Creates a new token in the pool of the provided token and copies its contents into it.
  *
  * @param original The original token to copy.
  * @return A copy of the original token.
  */
-T_token *token_copy(T_token *original);
+T_token *token_copy(const T_token *original);
 
 /**
- * @brief Initializes a function info structure.
+ * @brief Get the value of the token as a null terminated string. Identifiers return their interned
+ * name, keywords their spelling, literals their value. Tokens without a name have an empty value.
  *
- * @param fun_info The structure to initialize.
+ * @param token The token to get the value of.
+ * @return The value of the token.
  */
-void function_info_init(function_info_s *fun_info);
+const char *token_value(const T_token *token);
 
 /**
- * @brief A desctructor for the token type. Frees all allocated memory.
+ * @brief Get the token as it was written in the source. Operators and special tokens have none.
+ *
+ * @param token The token.
+ * @param[out] lexeme Where to store the lexeme, not null terminated.
+ * @return Length of the lexeme. 0 if the token has none.
+ */
+unsigned token_lexeme(const T_token *token, const char **lexeme);
+
+/**
+ * @brief Compare the value of the token to a string.
+ *
+ * @param token The token to compare.
+ * @param str Null terminated string to compare with.
+ * @return True if the value of the token equals @p str.
+ */
+bool token_equals(const T_token *token, const char *str);
+
+/**
+ * @brief A desctructor for the token type. Returns the token to the pool it was allocated from.
  *
  * @param token The token to free.
  */
@@ -118,6 +236,14 @@ void token_destroy(T_token *token);
  */
 void tstack_init(tstack_s *tstack);
 
+/**
+ * @brief Initialize the token stack structure with the elements allocated in an arena.
+ *
+ * @param[in] tstack Token Stack to initialize.
+ * @param[in] arena The arena to allocate the elements in.
+ */
+void tstack_init_arena(tstack_s *tstack, arena_s *arena);
+
 /**
  * @brief Copies a stack of tokens.
  *